@@ -0,0 +1,274 @@
+// AabbTreeBroadphase.cpp
+#include "AabbTreeBroadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+// Leaf user data: entity index in the low bits, the image's shift (each axis
+// -1, 0 or +1 world widths) packed into the top four.
+constexpr uint32_t kIndexMask = 0x0fffffffu;
+constexpr uint32_t kPrimaryCode = 4;  // no shift on either axis
+
+inline uint32_t packLeaf(uint32_t index, glm::vec2 shift, float period) {
+  int sx = (int)std::lround(shift.x / period) + 1;
+  int sy = (int)std::lround(shift.y / period) + 1;
+  return index | (uint32_t)(sx * 3 + sy) << 28;
+}
+
+inline glm::vec2 leafShift(uint32_t userData, float period) {
+  int code = (int)(userData >> 28);
+  return glm::vec2((float)(code / 3 - 1) * period, (float)(code % 3 - 1) * period);
+}
+
+// Fat box margin, and how many steps of the last displacement to look ahead.
+constexpr float kMargin = 2.0f * PhysicsSystem::radiusToWorld;
+constexpr float kDisplacementFrames = 1.0f;
+
+inline Aabb tightBox(const ProxyCircle &c) {
+  glm::vec2 r(c.radius, c.radius);
+  return {c.centre - r, c.centre + r};
+}
+
+inline Aabb shifted(const Aabb &box, glm::vec2 shift) {
+  return {box.min + shift, box.max + shift};
+}
+
+}  // namespace
+
+template <typename Fn>
+void AabbTreeBroadphase::forEachImage(const Aabb &box, Fn &&fn) {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  float xs[2] = {0.0f, 0.0f}, ys[2] = {0.0f, 0.0f};
+  int nx = 1, ny = 1;
+  if (box.max.x > bound) {
+    xs[nx++] = -period;
+  } else if (box.min.x < -bound) {
+    xs[nx++] = period;
+  }
+  if (box.max.y > bound) {
+    ys[ny++] = -period;
+  } else if (box.min.y < -bound) {
+    ys[ny++] = period;
+  }
+  for (int i = 0; i < nx; i++) {
+    for (int j = 0; j < ny; j++) fn(glm::vec2(xs[i], ys[j]));
+  }
+}
+
+void AabbTreeBroadphase::reset() {
+  tree.clear();
+  tracked.clear();
+}
+
+void AabbTreeBroadphase::insertEntity(uint32_t index, Tracked &t, const Aabb &fat) {
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  t.proxyCount = 0;
+  forEachImage(fat, [&](glm::vec2 shift) {
+    t.proxies[t.proxyCount++] =
+        tree.createProxy(shifted(fat, shift), packLeaf(index, shift, period));
+  });
+}
+
+uint32_t AabbTreeBroadphase::nextStamp(size_t entityCount) const {
+  if (stamp.size() < entityCount) stamp.resize(entityCount, 0);
+  if (++stampValue == 0) {  // wrapped: forget every old mark
+    std::fill(stamp.begin(), stamp.end(), 0);
+    stampValue = 1;
+  }
+  return stampValue;
+}
+
+void AabbTreeBroadphase::removeEntity(Tracked &t) {
+  for (int i = 0; i < t.proxyCount; i++) tree.destroyProxy(t.proxies[i]);
+  t.proxyCount = 0;
+}
+
+void AabbTreeBroadphase::sync(const std::vector<Entity> &entities) {
+  if (entities.size() < tracked.size()) reset();  // array was compacted
+  tracked.resize(entities.size());
+
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    const Entity &e = entities[i];
+    Tracked &t = tracked[i];
+    if (e.radius < 0) {
+      removeEntity(t);
+      continue;
+    }
+
+    ProxyCircle circle = proxyCircle(e);
+    glm::vec2 step = circle.centre - t.lastCentre;
+    t.lastCentre = circle.centre;
+    Aabb tight = tightBox(circle);
+    if (t.proxyCount > 0 && tree.getFatAabb(t.proxies[0]).contains(tight)) continue;
+
+    // Pad by the margin and stretch along the last step's motion, unless that
+    // step wrapped (a jump across the world says nothing about velocity).
+    Aabb fat = {tight.min - glm::vec2(kMargin, kMargin), tight.max + glm::vec2(kMargin, kMargin)};
+    glm::vec2 d = step * kDisplacementFrames;
+    if (t.proxyCount > 0 && std::fabs(step.x) < period * 0.5f &&
+        std::fabs(step.y) < period * 0.5f) {
+      (d.x < 0 ? fat.min.x : fat.max.x) += d.x;
+      (d.y < 0 ? fat.min.y : fat.max.y) += d.y;
+    }
+
+    if (t.proxyCount == 0) {
+      insertEntity(i, t, fat);
+      continue;
+    }
+
+    // The primary leaf is reinserted in place; edge copies come and go with it.
+    for (int k = 1; k < t.proxyCount; k++) tree.destroyProxy(t.proxies[k]);
+    tree.moveProxy(t.proxies[0], fat);
+    t.proxyCount = 1;
+    forEachImage(fat, [&](glm::vec2 shift) {
+      if (shift.x == 0.0f && shift.y == 0.0f) return;
+      t.proxies[t.proxyCount++] =
+          tree.createProxy(shifted(fat, shift), packLeaf(i, shift, period));
+    });
+  }
+}
+
+void AabbTreeBroadphase::findPairs(const std::vector<Entity> &entities,
+                                   std::vector<BroadphasePair> &pairs) {
+  pairs.clear();
+  seamPairs.clear();
+  sync(entities);
+
+  // Leaves with the same shift (two primaries, or two copies on the same
+  // side) see the entities' direct overlap; only the primaries report it.
+  // Leaves with different shifts see an overlap across an edge, which the
+  // other entity's copy may find too, so those few are deduplicated after.
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  tree.queryPairs([&](int32_t proxyA, int32_t proxyB) {
+    uint32_t dataA = tree.getUserData(proxyA), dataB = tree.getUserData(proxyB);
+    uint32_t i = dataA & kIndexMask, j = dataB & kIndexMask;
+    uint32_t shiftA = dataA >> 28, shiftB = dataB >> 28;
+    if (i == j || (shiftA == shiftB && shiftA != kPrimaryCode)) return;
+    ProxyCircle a = proxyCircle(entities[i]), b = proxyCircle(entities[j]);
+    float reach = a.radius + b.radius;
+    if (wrappedDistance(a.centre.x, b.centre.x, period) > reach ||
+        wrappedDistance(a.centre.y, b.centre.y, period) > reach) {
+      return;
+    }
+    BroadphasePair pair = i < j ? BroadphasePair{i, j} : BroadphasePair{j, i};
+    if (shiftA == shiftB) {
+      pairs.push_back(pair);
+    } else {
+      seamPairs.push_back(pair);
+    }
+  });
+
+  std::sort(seamPairs.begin(), seamPairs.end(),
+            [](const BroadphasePair &x, const BroadphasePair &y) {
+              return x.a != y.a ? x.a < y.a : x.b < y.b;
+            });
+  for (size_t k = 0; k < seamPairs.size(); k++) {
+    if (k == 0 || seamPairs[k].a != seamPairs[k - 1].a || seamPairs[k].b != seamPairs[k - 1].b) {
+      pairs.push_back(seamPairs[k]);
+    }
+  }
+}
+
+void AabbTreeBroadphase::queryBox(glm::vec2 min, glm::vec2 max,
+                                  std::vector<uint32_t> &candidates) const {
+  const Aabb box = {min, max};
+  forEachImage(box, [&](glm::vec2 shift) {
+    tree.query(shifted(box, shift), [&](int32_t proxyId) {
+      candidates.push_back(tree.getUserData(proxyId) & kIndexMask);
+      return true;
+    });
+  });
+}
+
+void AabbTreeBroadphase::queryRadius(const std::vector<Entity> &entities, glm::vec2 centre,
+                                     float radius, std::vector<uint32_t> &results) const {
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  const uint32_t mark = nextStamp(entities.size());
+
+  const Aabb box = {centre - glm::vec2(radius, radius), centre + glm::vec2(radius, radius)};
+  forEachImage(box, [&](glm::vec2 shift) {
+    tree.query(shifted(box, shift), [&](int32_t proxyId) {
+      uint32_t j = tree.getUserData(proxyId) & kIndexMask;
+      if (j >= entities.size() || stamp[j] == mark) return true;
+      const Entity &e = entities[j];
+      if (e.radius < 0) return true;
+      float dx = wrappedDistance(centre.x, e.position.x, period);
+      float dy = wrappedDistance(centre.y, e.position.y, period);
+      float reach = radius + e.radius * PhysicsSystem::radiusToWorld;
+      if (dx * dx + dy * dy <= reach * reach) {
+        stamp[j] = mark;
+        results.push_back(j);
+      }
+      return true;
+    });
+  });
+}
+
+bool AabbTreeBroadphase::raycast(const std::vector<Entity> &entities, glm::vec2 origin,
+                                 glm::vec2 direction, float maxDistance, RaycastHit &hit) const {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  auto wrap = [&](float v) { return v - period * std::floor((v + bound) / period); };
+  glm::vec2 p(wrap(origin.x), wrap(origin.y));
+
+  // March the ray through the world square one crossing at a time; leaves
+  // hanging over the edges have copies inside, so each leg only needs the
+  // part of the ray inside the square.
+  float travelled = 0.0f;
+  while (travelled < maxDistance) {
+    float leg = maxDistance - travelled;
+    int exitAxis = -1;
+    for (int axis = 0; axis < 2; axis++) {
+      if (direction[axis] == 0.0f) continue;
+      float edge = direction[axis] > 0 ? bound : -bound;
+      float t = (edge - p[axis]) / direction[axis];
+      if (t < leg) {
+        leg = std::max(t, 0.0f);
+        exitAxis = axis;
+      }
+    }
+
+    glm::vec2 end = p + direction * leg;
+    bool found = false;
+    tree.raycast(p, end, [&](int32_t proxyId, float maxFraction) {
+      uint32_t userData = tree.getUserData(proxyId);
+      uint32_t j = userData & kIndexMask;
+      if (j >= entities.size() || entities[j].radius < 0) return maxFraction;
+      const Entity &e = entities[j];
+      glm::vec2 c = e.position + leafShift(userData, period);
+      float r = e.radius * PhysicsSystem::radiusToWorld;
+
+      // |p + t*direction - c| = r, nearest non-negative root.
+      glm::vec2 m = p - c;
+      float b = m.x * direction.x + m.y * direction.y;
+      float cc = m.x * m.x + m.y * m.y - r * r;
+      if (cc > 0.0f && b > 0.0f) return maxFraction;
+      float disc = b * b - cc;
+      if (disc < 0.0f) return maxFraction;
+      float t = std::max(-b - std::sqrt(disc), 0.0f);
+      if (t > maxFraction * leg) return maxFraction;
+
+      found = true;
+      hit.entity = j;
+      hit.distance = travelled + t;
+      hit.point = p + direction * t;
+      return leg > 0.0f ? t / leg : 0.0f;
+    });
+    if (found) {
+      hit.point = glm::vec2(wrap(hit.point.x), wrap(hit.point.y));
+      return true;
+    }
+    if (exitAxis < 0) break;
+
+    travelled += leg;
+    p = end;
+    p[exitAxis] = direction[exitAxis] > 0 ? -bound : bound;
+  }
+  return false;
+}
@@ -0,0 +1,59 @@
+// AabbTreeBroadphase.h
+#pragma once
+#include <glm/glm.hpp>
+
+#include "Broadphase.h"
+#include "DynamicAabbTree.h"
+
+// Broadphase over a DynamicAabbTree, one leaf per entity. Unlike the grid it
+// doesn't care how much radii vary. Entities keep their fat box until they
+// leave it (the box is padded by a margin and stretched along recent motion),
+// so slow movers rarely touch the tree.
+//
+// The torus is handled by duplication: an entity whose fat box hangs over a
+// world edge gets extra leaves shifted one world width back inside, and
+// queries that hang over an edge are repeated shifted the same way.
+//
+// queryRadius and raycast read the tree as of the last findPairs, i.e. the
+// last PhysicsSystem::update.
+class AabbTreeBroadphase : public Broadphase {
+ public:
+  void findPairs(const std::vector<Entity> &entities, std::vector<BroadphasePair> &pairs) override;
+  void reset() override;
+  const char *name() const override { return "tree"; }
+  void queryBox(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &candidates) const override;
+
+  // Appends entities whose circle overlaps the given circle (world units).
+  void queryRadius(const std::vector<Entity> &entities, glm::vec2 centre, float radius,
+                   std::vector<uint32_t> &results) const;
+  // Nearest entity circle hit by the ray within maxDistance. The ray wraps at
+  // the world edges. direction must be normalized.
+  bool raycast(const std::vector<Entity> &entities, glm::vec2 origin, glm::vec2 direction,
+               float maxDistance, RaycastHit &hit) const;
+
+  const DynamicAabbTree &getTree() const { return tree; }
+
+ private:
+  // Leaves per entity: the primary box plus up to three shifted copies (x, y
+  // and the corner) when the fat box crosses world edges.
+  struct Tracked {
+    int32_t proxies[4];
+    uint8_t proxyCount = 0;
+    glm::vec2 lastCentre{0.0f, 0.0f};
+  };
+
+  void sync(const std::vector<Entity> &entities);
+  void insertEntity(uint32_t index, Tracked &t, const Aabb &fat);
+  void removeEntity(Tracked &t);
+  uint32_t nextStamp(size_t entityCount) const;
+  // Calls fn(shift) for the box itself and every copy needed to cover the
+  // parts hanging over world edges.
+  template <typename Fn>
+  static void forEachImage(const Aabb &box, Fn &&fn);
+
+  DynamicAabbTree tree;
+  std::vector<Tracked> tracked;
+  std::vector<BroadphasePair> seamPairs;
+  mutable std::vector<uint32_t> stamp;  // dedups entities reached through several leaves
+  mutable uint32_t stampValue = 0;
+};
@@ -0,0 +1,91 @@
+// BakedTexture.cpp
+#include "BakedTexture.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::~MappedFile() {
+  if (bytes) UnmapViewOfFile(bytes);
+  if (mappingHandle) CloseHandle(mappingHandle);
+  if (fileHandle && fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+}
+
+bool MappedFile::open(const std::string &filepath) {
+  fileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) return false;
+  mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mappingHandle) return false;
+  bytes = (const unsigned char *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  length = (size_t)fileSize.QuadPart;
+  return bytes != nullptr;
+}
+#else
+MappedFile::~MappedFile() {
+  if (bytes) munmap((void *)bytes, length);
+}
+
+bool MappedFile::open(const std::string &filepath) {
+  int fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping keeps the file alive
+  if (mapped == MAP_FAILED) return false;
+  bytes = (const unsigned char *)mapped;
+  length = st.st_size;
+  return true;
+}
+#endif
+
+bool BakedTexture::open(const std::string &filepath) {
+  if (!file.open(filepath)) return false;
+
+  // A 2^32 x 2^32 texture has 33 levels; more is corruption, and it keeps
+  // the level table's size from overflowing below.
+  if (file.size() < sizeof(BakedTextureHeader) ||
+      std::memcmp(header().magic, kBakedTextureMagic, 4) != 0 ||
+      header().version != kBakedTextureVersion || header().mipCount == 0 ||
+      header().mipCount > 33 || header().width == 0 || header().height == 0) {
+    std::cerr << "Invalid baked texture: " << filepath << "\n";
+    return false;
+  }
+
+  size_t tableEnd = sizeof(BakedTextureHeader) + sizeof(BakedMipLevel) * header().mipCount;
+  if (file.size() < tableEnd) {
+    std::cerr << "Truncated baked texture: " << filepath << "\n";
+    return false;
+  }
+  // Each level halves the one before (rounding down, never below 1), as
+  // whiskers_texbake writes them, and lies wholly inside the file.
+  uint32_t expectedWidth = width(), expectedHeight = height();
+  for (uint32_t i = 0; i < mipCount(); i++) {
+    const BakedMipLevel &l = level(i);
+    bool dimensionsOk = l.width == expectedWidth && l.height == expectedHeight;
+    bool rangeOk = l.offset <= file.size() && l.size <= file.size() - l.offset;
+    expectedWidth = expectedWidth > 1 ? expectedWidth / 2 : 1;
+    expectedHeight = expectedHeight > 1 ? expectedHeight / 2 : 1;
+    if (!dimensionsOk || !rangeOk || l.size != (uint64_t)l.width * l.height * 4) {
+      std::cerr << "Corrupt mip level " << i << " in baked texture: " << filepath << "\n";
+      return false;
+    }
+  }
+  return true;
+}
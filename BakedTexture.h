@@ -0,0 +1,74 @@
+// BakedTexture.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pre-baked texture container (.wtex), written by whiskers_texbake. Holds every
+// mip level as tightly packed RGBA8 rows, ready to hand to glTexImage2D, so the
+// runtime maps the file and uploads without decoding or generating mipmaps.
+//
+// Layout (little-endian): BakedTextureHeader, mipCount BakedMipLevel entries,
+// then level data, each level starting on a kBakedTextureAlignment boundary.
+constexpr char kBakedTextureMagic[4] = {'W', 'T', 'E', 'X'};
+constexpr uint32_t kBakedTextureVersion = 1;
+constexpr uint32_t kBakedTextureAlignment = 16;
+
+struct BakedTextureHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t mipCount;
+  uint32_t reserved;
+};
+
+struct BakedMipLevel {
+  uint32_t width;
+  uint32_t height;
+  uint64_t offset;  // from start of file
+  uint64_t size;    // width * height * 4
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const std::string &filepath);
+  const unsigned char *data() const { return bytes; }
+  size_t size() const { return length; }
+
+ private:
+  const unsigned char *bytes = nullptr;
+  size_t length = 0;
+#ifdef _WIN32
+  void *fileHandle = nullptr;
+  void *mappingHandle = nullptr;
+#endif
+};
+
+// A mapped .wtex file with its header validated.
+class BakedTexture {
+ public:
+  bool open(const std::string &filepath);
+
+  uint32_t width() const { return header().width; }
+  uint32_t height() const { return header().height; }
+  uint32_t mipCount() const { return header().mipCount; }
+  const BakedMipLevel &level(uint32_t i) const {
+    return reinterpret_cast<const BakedMipLevel *>(file.data() + sizeof(BakedTextureHeader))[i];
+  }
+  const unsigned char *levelData(uint32_t i) const { return file.data() + level(i).offset; }
+
+ private:
+  const BakedTextureHeader &header() const {
+    return *reinterpret_cast<const BakedTextureHeader *>(file.data());
+  }
+
+  MappedFile file;
+};
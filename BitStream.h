@@ -0,0 +1,72 @@
+// BitStream.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs fields of any width up to 32 bits into bytes, lowest bit first.
+// Appends to a caller-owned vector, so reusing one keeps encoding
+// allocation-free once it has grown.
+class BitWriter {
+ public:
+  explicit BitWriter(std::vector<uint8_t> &out) : bytes(out) {}
+  ~BitWriter() { flush(); }
+
+  void write(uint32_t value, unsigned bits) {
+    scratch |= (uint64_t)(value & mask(bits)) << used;
+    used += bits;
+    while (used >= 8) {
+      bytes.push_back((uint8_t)scratch);
+      scratch >>= 8;
+      used -= 8;
+    }
+  }
+  void bit(bool value) { write(value ? 1u : 0u, 1); }
+
+  // Pads the last partial byte with zeros. Writing after this starts a new
+  // byte.
+  void flush() {
+    if (used > 0) bytes.push_back((uint8_t)scratch);
+    scratch = 0;
+    used = 0;
+  }
+
+  static uint32_t mask(unsigned bits) { return bits >= 32 ? ~0u : (1u << bits) - 1; }
+
+ private:
+  std::vector<uint8_t> &bytes;
+  uint64_t scratch = 0;
+  unsigned used = 0;
+};
+
+// Reads BitWriter output back; reads past the end return 0 and clear ok().
+class BitReader {
+ public:
+  BitReader(const uint8_t *data, size_t size) : bytes(data), length(size) {}
+
+  uint32_t read(unsigned bits) {
+    while (available < bits) {
+      if (pos == length) {
+        valid = false;
+        return 0;
+      }
+      scratch |= (uint64_t)bytes[pos++] << available;
+      available += 8;
+    }
+    uint32_t value = (uint32_t)scratch & BitWriter::mask(bits);
+    scratch >>= bits;
+    available -= bits;
+    return value;
+  }
+  bool bit() { return read(1) != 0; }
+
+  bool ok() const { return valid; }
+
+ private:
+  const uint8_t *bytes;
+  size_t length;
+  size_t pos = 0;
+  uint64_t scratch = 0;
+  unsigned available = 0;
+  bool valid = true;
+};
@@ -0,0 +1,31 @@
+// Broadphase.cpp
+#include "Broadphase.h"
+
+#include <cmath>
+
+#include "AabbTreeBroadphase.h"
+#include "PhysicsSystem.h"
+#include "SweepAndPruneBroadphase.h"
+#include "UniformGridBroadphase.h"
+
+std::unique_ptr<Broadphase> createBroadphase(const std::string &name) {
+  if (name == "grid") return std::make_unique<UniformGridBroadphase>();
+  if (name == "sap") return std::make_unique<SweepAndPruneBroadphase>();
+  if (name == "tree") return std::make_unique<AabbTreeBroadphase>();
+  return nullptr;
+}
+
+ProxyCircle Broadphase::proxyCircle(const Entity &e) const {
+  float r = e.radius * PhysicsSystem::radiusToWorld;
+  if (sweepTime <= 0.0f || e.type != EntityType::Bullet) return {e.position, r};
+
+  // Midpoint of this step's path, wrapped back into the world, and a radius
+  // that covers both ends.
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  glm::vec2 half = e.velocity * (0.5f * sweepTime);
+  glm::vec2 c = e.position - half;
+  c.x -= period * std::floor((c.x + bound) / period);
+  c.y -= period * std::floor((c.y + bound) / period);
+  return {c, r + std::sqrt(half.x * half.x + half.y * half.y)};
+}
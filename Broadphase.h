@@ -0,0 +1,68 @@
+// Broadphase.h
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Entity.h"
+
+// Candidate collision pair: indices into EntityManager::getEntities(), a < b.
+struct BroadphasePair {
+  uint32_t a, b;
+};
+
+// Nearest entity along a ray (see SpatialQuery::raycast).
+struct RaycastHit {
+  uint32_t entity = 0;
+  float distance = 0.0f;  // along the ray, in world units
+  glm::vec2 point{0.0f, 0.0f};
+};
+
+// Circle a broadphase tests an entity with, in world units.
+struct ProxyCircle {
+  glm::vec2 centre;
+  float radius;
+};
+
+// Finds every pair of live entities (radius >= 0) whose bounding squares
+// overlap on the torus. Implementations may keep state between calls to
+// exploit frame-to-frame coherence, so entity indices must stay stable; call
+// reset() if the entity array is compacted or reordered.
+class Broadphase {
+ public:
+  virtual ~Broadphase() = default;
+
+  virtual void findPairs(const std::vector<Entity> &entities,
+                         std::vector<BroadphasePair> &pairs) = 0;
+  virtual void reset() {}
+  virtual const char *name() const = 0;
+
+  // Appends entities whose proxy may overlap the box, as of the last
+  // findPairs. The box's centre is inside the world and its half extents are
+  // at most worldBound, so it hangs over at most one edge per axis. Results
+  // may repeat or not actually overlap; SpatialQuery dedups and tests them.
+  virtual void queryBox(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &candidates) const = 0;
+
+  // With a non-zero sweep time, bullets are bounded by the circle around the
+  // path they covered over that many seconds, so pairs include everything a
+  // fast bullet may have passed through during the step (see
+  // ContinuousCollision). PhysicsSystem sets it to the step length.
+  void setSweepTime(float seconds) { sweepTime = seconds; }
+  float getSweepTime() const { return sweepTime; }
+
+ protected:
+  ProxyCircle proxyCircle(const Entity &e) const;
+
+  float sweepTime = 0.0f;
+};
+
+// "grid", "sap" or "tree"; nullptr for unknown names.
+std::unique_ptr<Broadphase> createBroadphase(const std::string &name);
+
+// Minimum-image separation along one axis of the torus.
+inline float wrappedDistance(float a, float b, float period) {
+  float d = std::fabs(a - b);
+  return d > period * 0.5f ? period - d : d;
+}
@@ -0,0 +1,141 @@
+// ContactSolver.cpp
+#include "ContactSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Approach speeds below this (world units per second) don't bounce, so
+// resting contacts settle instead of jittering.
+constexpr float kBounceThreshold = 0.02f;
+// Penetration left alone, and the fraction of the rest removed per step.
+constexpr float kSlop = 0.5f * PhysicsSystem::radiusToWorld;
+constexpr float kCorrection = 0.8f;
+
+inline float wrapCoordinate(float v) {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  return v - period * std::floor((v + bound) / period);
+}
+
+}  // namespace
+
+template <typename Fn>
+void ContactSolver::forEachByColor(JobSystem *jobs, Fn &&fn) {
+  for (size_t c = 0; c + 1 < colorStart.size(); c++) {
+    size_t first = colorStart[c], count = colorStart[c + 1] - first;
+    if (count == 0) continue;
+    // The overflow group's contacts may share bodies.
+    bool overflow = c == maxColors;
+    auto run = [&](size_t begin, size_t end) {
+      for (size_t i = first + begin; i < first + end; i++) fn(constraints[i]);
+    };
+    if (jobs && !overflow) {
+      jobs->parallelFor(count, grain, run);
+    } else {
+      run(0, count);
+    }
+  }
+}
+
+void ContactSolver::solve(std::vector<Entity> &entities, const std::vector<Contact> &contacts,
+                          JobSystem *jobs) {
+  constraints.clear();
+  colorStart.clear();
+  usedColors = 0;
+
+  // Colour asteroid contacts in order: the lowest colour neither body has.
+  accepted.clear();
+  colorOf.clear();
+  bodyColors.assign(entities.size(), 0);
+  size_t counts[maxColors + 1] = {};
+  for (const Contact &c : contacts) {
+    const Entity &a = entities[c.a], &b = entities[c.b];
+    if (a.type != EntityType::Asteroid || b.type != EntityType::Asteroid) continue;
+    if (a.radius < 0 || b.radius < 0) continue;
+    uint64_t free = ~(bodyColors[c.a] | bodyColors[c.b]);
+    int color = maxColors;
+    if (free) {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward64(&index, free);
+      color = (int)index;
+#else
+      color = __builtin_ctzll(free);
+#endif
+      bodyColors[c.a] |= 1ull << color;
+      bodyColors[c.b] |= 1ull << color;
+    }
+    usedColors = std::max(usedColors, (size_t)color + 1);
+    accepted.push_back(&c);
+    colorOf.push_back((uint8_t)color);
+    counts[color]++;
+  }
+  if (accepted.empty()) return;
+
+  // Counting sort by colour. Group maxColors holds the overflow, contacts
+  // that found no free colour.
+  colorStart.assign(maxColors + 2, 0);
+  for (int c = 0; c <= maxColors; c++) colorStart[c + 1] = colorStart[c] + counts[c];
+  colorCursor.assign(colorStart.begin(), colorStart.end() - 1);
+  constraints.resize(accepted.size());
+  for (size_t i = 0; i < accepted.size(); i++) {
+    const Contact &c = *accepted[i];
+    constraints[colorCursor[colorOf[i]]++] = {c.a, c.b, c.normal, c.penetration, 0.0f, 0.0f, 0.0f};
+  }
+
+  invMass.resize(entities.size());
+  for (size_t i = 0; i < entities.size(); i++) {
+    float r = entities[i].radius;
+    invMass[i] = r > 0 ? 1.0f / (r * r) : 0.0f;
+  }
+
+  // Effective mass and bounce target from the approach speed before solving.
+  auto prepare = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      Constraint &k = constraints[i];
+      float inverse = invMass[k.a] + invMass[k.b];
+      k.normalMass = inverse > 0 ? 1.0f / inverse : 0.0f;
+      float approach = glm::dot(entities[k.b].velocity - entities[k.a].velocity, k.normal);
+      k.bounce = approach < -kBounceThreshold ? -restitution * approach : 0.0f;
+    }
+  };
+  if (jobs) {
+    jobs->parallelFor(constraints.size(), grain, prepare);
+  } else {
+    prepare(0, constraints.size());
+  }
+
+  for (int it = 0; it < iterations; it++) {
+    forEachByColor(jobs, [&](Constraint &k) {
+      Entity &a = entities[k.a], &b = entities[k.b];
+      float speed = glm::dot(b.velocity - a.velocity, k.normal);
+      float lambda = (k.bounce - speed) * k.normalMass;
+      float accumulated = std::max(k.impulse + lambda, 0.0f);
+      lambda = accumulated - k.impulse;
+      k.impulse = accumulated;
+      glm::vec2 p = k.normal * lambda;
+      a.velocity -= p * invMass[k.a];
+      b.velocity += p * invMass[k.b];
+    });
+  }
+
+  // Push apart along the contact normal, split by inverse mass.
+  forEachByColor(jobs, [&](Constraint &k) {
+    float depth = k.penetration - kSlop;
+    if (depth <= 0.0f) return;
+    glm::vec2 push = k.normal * (depth * kCorrection * k.normalMass);
+    Entity &a = entities[k.a], &b = entities[k.b];
+    a.position -= push * invMass[k.a];
+    b.position += push * invMass[k.b];
+    a.position = glm::vec2(wrapCoordinate(a.position.x), wrapCoordinate(a.position.y));
+    b.position = glm::vec2(wrapCoordinate(b.position.x), wrapCoordinate(b.position.y));
+  });
+}
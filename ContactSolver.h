@@ -0,0 +1,68 @@
+// ContactSolver.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Narrowphase.h"
+
+// Impulse-based response for asteroid-vs-asteroid contacts. Asteroids are
+// solid discs, so mass goes with radius squared. Each step runs a few
+// sequential-impulse passes over the contacts' normal velocities (bouncing
+// by the restitution), then pushes overlapping pairs apart to remove most of
+// the penetration.
+//
+// To run in parallel, contacts are greedily coloured so that no two of the
+// same colour share a body; a colour's contacts are then independent and
+// spread over the job system, one colour after another. The colouring only
+// depends on the contact order, so results are bit-identical whatever the
+// thread count.
+class ContactSolver {
+ public:
+  static constexpr int maxColors = 64;  // one bit each in the per-body masks
+
+  // Updates velocities and positions of colliding asteroids. jobs may be
+  // null to solve on the calling thread.
+  void solve(std::vector<Entity> &entities, const std::vector<Contact> &contacts, JobSystem *jobs);
+
+  void setIterations(int n) { iterations = n; }
+  int getIterations() const { return iterations; }
+  // 0 absorbs the approach velocity, 1 returns it all.
+  void setRestitution(float e) { restitution = e; }
+  float getRestitution() const { return restitution; }
+
+  // Colours used by the last solve. maxColors + 1 means some contacts ran
+  // out of colours and were solved serially.
+  size_t getColorCount() const { return usedColors; }
+  // Asteroid contacts in the last solve.
+  size_t getConstraintCount() const { return constraints.size(); }
+
+ private:
+  struct Constraint {
+    uint32_t a, b;
+    glm::vec2 normal;  // a to b
+    float penetration;
+    float normalMass;  // 1 / (invMassA + invMassB)
+    float bounce;      // target separating speed
+    float impulse;     // accumulated over the iterations, never negative
+  };
+
+  // Runs fn on every constraint, colour by colour.
+  template <typename Fn>
+  void forEachByColor(JobSystem *jobs, Fn &&fn);
+
+  static constexpr size_t grain = 256;  // constraints per job chunk
+
+  int iterations = 4;
+  float restitution = 0.8f;
+
+  std::vector<Constraint> constraints;  // grouped by colour
+  std::vector<size_t> colorStart;       // per colour and the overflow, plus an end entry
+  std::vector<size_t> colorCursor;
+  size_t usedColors = 0;
+  std::vector<uint8_t> colorOf;         // per accepted contact
+  std::vector<const Contact *> accepted;
+  std::vector<uint64_t> bodyColors;  // per entity, colours already touching it
+  std::vector<float> invMass;        // per entity
+};
@@ -0,0 +1,83 @@
+// ContinuousCollision.cpp
+#include "ContinuousCollision.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+void ContinuousCollision::findImpacts(const std::vector<Entity> &entities,
+                                      const std::vector<BroadphasePair> &pairs, float dt,
+                                      std::vector<Impact> &impacts) {
+  impacts.clear();
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  auto nearest = [&](float d) { return d - period * std::round(d / period); };
+
+  // Gather bullet-vs-target pairs.
+  startX.clear();
+  startY.clear();
+  moveX.clear();
+  moveY.clear();
+  reach.clear();
+  bullets.clear();
+  targets.clear();
+  for (const BroadphasePair &p : pairs) {
+    bool bulletA = entities[p.a].type == EntityType::Bullet;
+    bool bulletB = entities[p.b].type == EntityType::Bullet;
+    if (bulletA == bulletB) continue;
+    uint32_t bi = bulletA ? p.a : p.b, ti = bulletA ? p.b : p.a;
+    const Entity &b = entities[bi], &t = entities[ti];
+    if (b.radius < 0 || t.radius < 0) continue;
+
+    // Positions are end-of-step; step both back. Either may have wrapped
+    // during the step, which the minimum image absorbs.
+    glm::vec2 move = (b.velocity - t.velocity) * dt;
+    glm::vec2 endSep = b.position - t.position;
+    startX.push_back(nearest(endSep.x - move.x));
+    startY.push_back(nearest(endSep.y - move.y));
+    moveX.push_back(move.x);
+    moveY.push_back(move.y);
+    reach.push_back((b.radius + t.radius) * PhysicsSystem::radiusToWorld);
+    bullets.push_back(bi);
+    targets.push_back(ti);
+  }
+
+  // Earliest s in [0, 1] with |start + s * move| = reach; 0 if already
+  // touching, 2 (no hit) if they never touch this step. Branch-free apart
+  // from selects, so the compiler can vectorize it.
+  const size_t count = bullets.size();
+  time.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    float a = moveX[i] * moveX[i] + moveY[i] * moveY[i];
+    float b = startX[i] * moveX[i] + startY[i] * moveY[i];
+    float c = startX[i] * startX[i] + startY[i] * startY[i] - reach[i] * reach[i];
+    float disc = b * b - a * c;
+    float s = (-b - std::sqrt(std::max(disc, 0.0f))) / std::max(a, 1e-30f);
+    bool approaching = b < 0.0f && disc >= 0.0f && s <= 1.0f;
+    time[i] = c <= 0.0f ? 0.0f : (approaching ? s : 2.0f);
+  }
+
+  // Keep each bullet's earliest hit.
+  earliest.assign(entities.size(), -1);
+  for (size_t i = 0; i < count; i++) {
+    if (time[i] > 1.0f) continue;
+    int32_t &best = earliest[bullets[i]];
+    if (best < 0 || time[i] < time[best] || (time[i] == time[best] && targets[i] < targets[best]))
+      best = (int32_t)i;
+  }
+
+  for (uint32_t bi = 0; bi < entities.size(); bi++) {
+    int32_t i = earliest[bi];
+    if (i < 0) continue;
+    const Entity &b = entities[bi];
+    float s = time[i];
+    glm::vec2 sep(startX[i] + s * moveX[i], startY[i] + s * moveY[i]);
+    float len = std::sqrt(sep.x * sep.x + sep.y * sep.y);
+    glm::vec2 normal = len > 0.0f ? sep / len : glm::vec2(1.0f, 0.0f);
+    glm::vec2 point = b.position - b.velocity * (dt * (1.0f - s));
+    point.x -= period * std::floor((point.x + bound) / period);
+    point.y -= period * std::floor((point.y + bound) / period);
+    impacts.push_back({bi, targets[i], s, point, normal});
+  }
+}
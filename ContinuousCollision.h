@@ -0,0 +1,35 @@
+// ContinuousCollision.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Broadphase.h"
+
+// First contact between a bullet and a non-bullet entity during a step.
+struct Impact {
+  uint32_t bullet, target;
+  float time;        // fraction of the step at first touch, 0..1
+  glm::vec2 point;   // bullet centre at first touch, wrapped into the world
+  glm::vec2 normal;  // unit, from the target's centre toward the bullet's
+};
+
+// Swept-circle test for bullets: each bullet-vs-target pair is treated as the
+// bullet's path over the step against the target's, with both moving in a
+// straight line, and the earliest touch is solved for directly. A bullet can't
+// tunnel through a small asteroid however long the step, so physics can tick
+// slower under load. Feed it pairs from a broadphase run with
+// setSweepTime(dt), which bounds bullets by their whole path.
+class ContinuousCollision {
+ public:
+  // Reports at most one impact per bullet (its earliest), in bullet order.
+  void findImpacts(const std::vector<Entity> &entities, const std::vector<BroadphasePair> &pairs,
+                   float dt, std::vector<Impact> &impacts);
+
+ private:
+  // Bullet-vs-target candidates in SoA form: separation at the start of the
+  // step (minimum image), relative displacement over it, combined radius.
+  std::vector<float> startX, startY, moveX, moveY, reach, time;
+  std::vector<uint32_t> bullets, targets;
+  std::vector<int32_t> earliest;  // per entity: index into the batch, or -1
+};
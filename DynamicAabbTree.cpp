@@ -0,0 +1,187 @@
+// DynamicAabbTree.cpp
+#include "DynamicAabbTree.h"
+
+#include <cstdlib>
+
+int32_t DynamicAabbTree::allocateNode() {
+  if (freeList == nullNode) {
+    nodes.emplace_back();
+    return (int32_t)nodes.size() - 1;
+  }
+  int32_t id = freeList;
+  freeList = nodes[id].parent;
+  nodes[id] = Node();
+  return id;
+}
+
+void DynamicAabbTree::freeNode(int32_t node) {
+  nodes[node].parent = freeList;
+  nodes[node].height = -1;
+  freeList = node;
+}
+
+void DynamicAabbTree::clear() {
+  nodes.clear();
+  root = nullNode;
+  freeList = nullNode;
+  proxyCount = 0;
+}
+
+int32_t DynamicAabbTree::createProxy(const Aabb &fatAabb, uint32_t userData) {
+  int32_t leaf = allocateNode();
+  nodes[leaf].aabb = fatAabb;
+  nodes[leaf].userData = userData;
+  insertLeaf(leaf);
+  proxyCount++;
+  return leaf;
+}
+
+void DynamicAabbTree::destroyProxy(int32_t proxyId) {
+  removeLeaf(proxyId);
+  freeNode(proxyId);
+  proxyCount--;
+}
+
+void DynamicAabbTree::moveProxy(int32_t proxyId, const Aabb &fatAabb) {
+  removeLeaf(proxyId);
+  nodes[proxyId].aabb = fatAabb;
+  insertLeaf(proxyId);
+}
+
+void DynamicAabbTree::insertLeaf(int32_t leaf) {
+  if (root == nullNode) {
+    root = leaf;
+    nodes[root].parent = nullNode;
+    return;
+  }
+
+  // Descend toward the cheapest sibling. Pairing with a node costs the
+  // perimeter of the merged box, and every ancestor on the way grows too.
+  const Aabb leafAabb = nodes[leaf].aabb;
+  int32_t index = root;
+  while (!nodes[index].isLeaf()) {
+    const Node &node = nodes[index];
+    float area = node.aabb.perimeter();
+    float combinedArea = combine(node.aabb, leafAabb).perimeter();
+
+    float cost = 2.0f * combinedArea;                      // new parent here
+    float inheritanceCost = 2.0f * (combinedArea - area);  // growth pushed below
+
+    auto descendCost = [&](int32_t child) {
+      const Node &c = nodes[child];
+      float grown = combine(leafAabb, c.aabb).perimeter();
+      return c.isLeaf() ? grown + inheritanceCost : grown - c.aabb.perimeter() + inheritanceCost;
+    };
+    float cost1 = descendCost(node.child1);
+    float cost2 = descendCost(node.child2);
+
+    if (cost < cost1 && cost < cost2) break;
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  int32_t sibling = index;
+  int32_t oldParent = nodes[sibling].parent;
+  int32_t newParent = allocateNode();
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].aabb = combine(leafAabb, nodes[sibling].aabb);
+  nodes[newParent].height = nodes[sibling].height + 1;
+  nodes[newParent].child1 = sibling;
+  nodes[newParent].child2 = leaf;
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  if (oldParent == nullNode) {
+    root = newParent;
+  } else if (nodes[oldParent].child1 == sibling) {
+    nodes[oldParent].child1 = newParent;
+  } else {
+    nodes[oldParent].child2 = newParent;
+  }
+
+  // Refit and rebalance the ancestors.
+  for (index = nodes[leaf].parent; index != nullNode; index = nodes[index].parent) {
+    index = balance(index);
+    const Node &node = nodes[index];
+    nodes[index].height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+    nodes[index].aabb = combine(nodes[node.child1].aabb, nodes[node.child2].aabb);
+  }
+}
+
+void DynamicAabbTree::removeLeaf(int32_t leaf) {
+  if (leaf == root) {
+    root = nullNode;
+    return;
+  }
+
+  // The parent goes away and the sibling takes its place.
+  int32_t parent = nodes[leaf].parent;
+  int32_t grandParent = nodes[parent].parent;
+  int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+  if (grandParent == nullNode) {
+    root = sibling;
+    nodes[sibling].parent = nullNode;
+    freeNode(parent);
+    return;
+  }
+
+  if (nodes[grandParent].child1 == parent) {
+    nodes[grandParent].child1 = sibling;
+  } else {
+    nodes[grandParent].child2 = sibling;
+  }
+  nodes[sibling].parent = grandParent;
+  freeNode(parent);
+
+  for (int32_t index = grandParent; index != nullNode; index = nodes[index].parent) {
+    index = balance(index);
+    const Node &node = nodes[index];
+    nodes[index].height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+    nodes[index].aabb = combine(nodes[node.child1].aabb, nodes[node.child2].aabb);
+  }
+}
+
+// If one subtree of a is two or more levels taller than the other, rotates the
+// taller child up into a's place. Returns the index now at a's position.
+int32_t DynamicAabbTree::balance(int32_t iA) {
+  Node &a = nodes[iA];
+  if (a.isLeaf() || a.height < 2) return iA;
+
+  int32_t iB = a.child1, iC = a.child2;
+  int32_t diff = nodes[iC].height - nodes[iB].height;
+  if (std::abs(diff) < 2) return iA;
+
+  // Rotate the taller child (up) above a; down is the other child of a.
+  int32_t iUp = diff > 0 ? iC : iB;
+  Node &up = nodes[iUp];
+  int32_t iF = up.child1, iG = up.child2;
+
+  up.child1 = iA;
+  up.parent = a.parent;
+  a.parent = iUp;
+  if (up.parent == nullNode) {
+    root = iUp;
+  } else if (nodes[up.parent].child1 == iA) {
+    nodes[up.parent].child1 = iUp;
+  } else {
+    nodes[up.parent].child2 = iUp;
+  }
+
+  // The taller grandchild stays with up; the shorter one replaces up under a.
+  int32_t iKeep = nodes[iF].height > nodes[iG].height ? iF : iG;
+  int32_t iMove = iKeep == iF ? iG : iF;
+  up.child2 = iKeep;
+  if (diff > 0) {
+    a.child2 = iMove;
+  } else {
+    a.child1 = iMove;
+  }
+  nodes[iMove].parent = iA;
+
+  const Node &other = nodes[diff > 0 ? a.child1 : a.child2];
+  a.aabb = combine(other.aabb, nodes[iMove].aabb);
+  a.height = 1 + std::max(other.height, nodes[iMove].height);
+  up.aabb = combine(a.aabb, nodes[iKeep].aabb);
+  up.height = 1 + std::max(a.height, nodes[iKeep].height);
+  return iUp;
+}
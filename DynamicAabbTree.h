@@ -0,0 +1,193 @@
+// DynamicAabbTree.h
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+struct Aabb {
+  glm::vec2 min{0.0f, 0.0f};
+  glm::vec2 max{0.0f, 0.0f};
+
+  bool contains(const Aabb &other) const {
+    return min.x <= other.min.x && min.y <= other.min.y && other.max.x <= max.x &&
+           other.max.y <= max.y;
+  }
+  bool overlaps(const Aabb &other) const {
+    return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y &&
+           other.min.y <= max.y;
+  }
+  float perimeter() const { return 2.0f * ((max.x - min.x) + (max.y - min.y)); }
+};
+
+inline Aabb combine(const Aabb &a, const Aabb &b) {
+  return {glm::vec2(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)),
+          glm::vec2(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y))};
+}
+
+// Bounding volume hierarchy over loose ("fat") boxes, in the style of Box2D's
+// b2DynamicTree. Leaves are proxies that only need reinserting once their
+// object escapes the fat box; insertion walks down choosing the sibling with
+// the lowest perimeter (surface area) cost, and AVL-style rotations on the
+// way back up keep the tree balanced. Nodes live in one pooled array with a
+// free list, so proxy ids are stable and steady-state updates don't allocate.
+class DynamicAabbTree {
+ public:
+  static constexpr int32_t nullNode = -1;
+
+  int32_t createProxy(const Aabb &fatAabb, uint32_t userData);
+  void destroyProxy(int32_t proxyId);
+  // Reinserts the leaf with a new fat box, refitting its old and new ancestors.
+  void moveProxy(int32_t proxyId, const Aabb &fatAabb);
+  void clear();
+
+  const Aabb &getFatAabb(int32_t proxyId) const { return nodes[proxyId].aabb; }
+  uint32_t getUserData(int32_t proxyId) const { return nodes[proxyId].userData; }
+  int getHeight() const { return root == nullNode ? 0 : nodes[root].height; }
+  size_t getProxyCount() const { return proxyCount; }
+
+  // Calls callback(proxyId) for every leaf whose fat box overlaps aabb; the
+  // callback returns false to stop early.
+  template <typename Callback>
+  void query(const Aabb &aabb, Callback &&callback) const;
+
+  // Calls callback(proxyA, proxyB) once for every pair of leaves whose fat
+  // boxes overlap, by traversing the tree against itself. Cheaper than one
+  // query per leaf since subtrees far apart are rejected in a single test and
+  // the walk stays spatially coherent.
+  template <typename Callback>
+  void queryPairs(Callback &&callback) const;
+
+  // Calls callback for leaves whose fat box the segment p1 -> p2 crosses, in
+  // no particular order. callback(proxyId, maxFraction) returns the new
+  // maximum fraction along the segment: the hit fraction to clip the ray,
+  // maxFraction to ignore the proxy, 0 to stop.
+  template <typename Callback>
+  void raycast(glm::vec2 p1, glm::vec2 p2, Callback &&callback) const;
+
+ private:
+  struct Node {
+    Aabb aabb;
+    int32_t parent = nullNode;  // next free node while on the free list
+    int32_t child1 = nullNode;
+    int32_t child2 = nullNode;
+    int32_t height = 0;  // leaf = 0, free = -1
+    uint32_t userData = 0;
+
+    bool isLeaf() const { return child1 == nullNode; }
+  };
+
+  // Deep enough for any balanced tree that fits in memory.
+  static constexpr int stackSize = 256;
+
+  int32_t allocateNode();
+  void freeNode(int32_t node);
+  void insertLeaf(int32_t leaf);
+  void removeLeaf(int32_t leaf);
+  int32_t balance(int32_t node);
+
+  std::vector<Node> nodes;
+  int32_t root = nullNode;
+  int32_t freeList = nullNode;
+  size_t proxyCount = 0;
+};
+
+template <typename Callback>
+void DynamicAabbTree::query(const Aabb &aabb, Callback &&callback) const {
+  if (root == nullNode) return;
+  int32_t stack[stackSize];
+  int count = 0;
+  stack[count++] = root;
+  while (count > 0) {
+    int32_t id = stack[--count];
+    const Node &node = nodes[id];
+    if (!node.aabb.overlaps(aabb)) continue;
+    if (node.isLeaf()) {
+      if (!callback(id)) return;
+    } else {
+      assert(count + 2 <= stackSize);
+      stack[count++] = node.child1;
+      stack[count++] = node.child2;
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicAabbTree::raycast(glm::vec2 p1, glm::vec2 p2, Callback &&callback) const {
+  if (root == nullNode) return;
+  glm::vec2 d = p2 - p1;
+  // Slab test against [0, maxFraction] of the segment; 1/0 gives +/-inf, which
+  // the comparisons below handle for axis-parallel rays.
+  glm::vec2 inv(1.0f / d.x, 1.0f / d.y);
+  float maxFraction = 1.0f;
+
+  int32_t stack[stackSize];
+  int count = 0;
+  stack[count++] = root;
+  while (count > 0) {
+    int32_t id = stack[--count];
+    const Node &node = nodes[id];
+
+    float t0 = 0.0f, t1 = maxFraction;
+    for (int axis = 0; axis < 2; axis++) {
+      float origin = p1[axis];
+      if (d[axis] == 0.0f) {
+        if (origin < node.aabb.min[axis] || origin > node.aabb.max[axis]) t0 = 1.0f, t1 = 0.0f;
+        continue;
+      }
+      float ta = (node.aabb.min[axis] - origin) * inv[axis];
+      float tb = (node.aabb.max[axis] - origin) * inv[axis];
+      t0 = std::max(t0, std::min(ta, tb));
+      t1 = std::min(t1, std::max(ta, tb));
+    }
+    if (t0 > t1) continue;
+
+    if (node.isLeaf()) {
+      maxFraction = callback(id, maxFraction);
+      if (maxFraction <= 0.0f) return;
+    } else {
+      assert(count + 2 <= stackSize);
+      stack[count++] = node.child1;
+      stack[count++] = node.child2;
+    }
+  }
+}
+
+template <typename Callback>
+void DynamicAabbTree::queryPairs(Callback &&callback) const {
+  if (root == nullNode) return;
+  // (a, a) means "pairs within subtree a"; (a, b) means "pairs across a and
+  // b", pushed only once their boxes are known to overlap.
+  std::vector<std::pair<int32_t, int32_t>> stack;
+  stack.reserve(stackSize);
+  stack.emplace_back(root, root);
+  while (!stack.empty()) {
+    auto [ia, ib] = stack.back();
+    stack.pop_back();
+    const Node &a = nodes[ia];
+    if (ia == ib) {
+      if (a.isLeaf()) continue;
+      stack.emplace_back(a.child1, a.child1);
+      stack.emplace_back(a.child2, a.child2);
+      if (nodes[a.child1].aabb.overlaps(nodes[a.child2].aabb)) {
+        stack.emplace_back(a.child1, a.child2);
+      }
+      continue;
+    }
+
+    const Node &b = nodes[ib];
+    if (a.isLeaf() && b.isLeaf()) {
+      callback(ia, ib);
+      continue;
+    }
+    // Split the taller side against the other.
+    bool splitA = b.isLeaf() || (!a.isLeaf() && a.height >= b.height);
+    const Node &split = splitA ? a : b;
+    const Node &other = splitA ? b : a;
+    int32_t iOther = splitA ? ib : ia;
+    if (nodes[split.child1].aabb.overlaps(other.aabb)) stack.emplace_back(split.child1, iOther);
+    if (nodes[split.child2].aabb.overlaps(other.aabb)) stack.emplace_back(split.child2, iOther);
+  }
+}
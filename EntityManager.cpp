@@ -1,9 +1,23 @@
 #include "EntityManager.h"
 
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<Entity>::value,
+              "saveState/restoreState copy entities as raw memory");
+
 size_t EntityManager::createEntity(const Entity& e) {
   entities.push_back(e);
   return entities.size() - 1;
 }
+void EntityManager::reserve(size_t capacity) {
+  entities.reserve(capacity);
+}
 std::vector<Entity>& EntityManager::getEntities() {
   return entities;
 }
+void EntityManager::saveState(std::vector<Entity>& state) const {
+  state.assign(entities.begin(), entities.end());
+}
+void EntityManager::restoreState(const std::vector<Entity>& state) {
+  entities.assign(state.begin(), state.end());
+}
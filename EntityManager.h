@@ -6,8 +6,16 @@
 class EntityManager {
  public:
   size_t createEntity(const Entity& e);
+  // Grows capacity so creating up to `capacity` entities won't reallocate.
+  void reserve(size_t capacity);
   std::vector<Entity>& getEntities();
 
+  // Copy the whole entity array out and back, e.g. for rollback. Entities
+  // are plain data, so each is one memcpy, and a reused `state` keeps its
+  // capacity so saving doesn't allocate.
+  void saveState(std::vector<Entity>& state) const;
+  void restoreState(const std::vector<Entity>& state);
+
  private:
   std::vector<Entity> entities;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+// Fixed.cpp
+#include "Fixed.h"
+
+#include <climits>
+
+namespace {
+
+// sin(90° * i / 256) in Q16.16, i = 0..256.
+constexpr int32_t kSineTable[257] = {
+    0,     402,   804,   1206,  1608,  2010,  2412,  2814,  3216,  3617,  4019,  4420,  4821,
+    5222,  5623,  6023,  6424,  6824,  7224,  7623,  8022,  8421,  8820,  9218,  9616,  10014,
+    10411, 10808, 11204, 11600, 11996, 12391, 12785, 13180, 13573, 13966, 14359, 14751, 15143,
+    15534, 15924, 16314, 16703, 17091, 17479, 17867, 18253, 18639, 19024, 19409, 19792, 20175,
+    20557, 20939, 21320, 21699, 22078, 22457, 22834, 23210, 23586, 23961, 24335, 24708, 25080,
+    25451, 25821, 26190, 26558, 26925, 27291, 27656, 28020, 28383, 28745, 29106, 29466, 29824,
+    30182, 30538, 30893, 31248, 31600, 31952, 32303, 32652, 33000, 33347, 33692, 34037, 34380,
+    34721, 35062, 35401, 35738, 36075, 36410, 36744, 37076, 37407, 37736, 38064, 38391, 38716,
+    39040, 39362, 39683, 40002, 40320, 40636, 40951, 41264, 41576, 41886, 42194, 42501, 42806,
+    43110, 43412, 43713, 44011, 44308, 44604, 44898, 45190, 45480, 45769, 46056, 46341, 46624,
+    46906, 47186, 47464, 47741, 48015, 48288, 48559, 48828, 49095, 49361, 49624, 49886, 50146,
+    50404, 50660, 50914, 51166, 51417, 51665, 51911, 52156, 52398, 52639, 52878, 53114, 53349,
+    53581, 53812, 54040, 54267, 54491, 54714, 54934, 55152, 55368, 55582, 55794, 56004, 56212,
+    56418, 56621, 56823, 57022, 57219, 57414, 57607, 57798, 57986, 58172, 58356, 58538, 58718,
+    58896, 59071, 59244, 59415, 59583, 59750, 59914, 60075, 60235, 60392, 60547, 60700, 60851,
+    60999, 61145, 61288, 61429, 61568, 61705, 61839, 61971, 62101, 62228, 62353, 62476, 62596,
+    62714, 62830, 62943, 63054, 63162, 63268, 63372, 63473, 63572, 63668, 63763, 63854, 63944,
+    64031, 64115, 64197, 64277, 64354, 64429, 64501, 64571, 64639, 64704, 64766, 64827, 64884,
+    64940, 64993, 65043, 65091, 65137, 65180, 65220, 65259, 65294, 65328, 65358, 65387, 65413,
+    65436, 65457, 65476, 65492, 65505, 65516, 65525, 65531, 65535, 65536,
+};
+
+// 2^(2^-k) in Q2.30, k = 1..16.
+constexpr uint64_t kExp2Table[16] = {
+    1518500250, 1276901417, 1170923762, 1121280436, 1097253708, 1085434106,
+    1079572136, 1076653033, 1075196443, 1074468888, 1074105294, 1073923544,
+    1073832680, 1073787251, 1073764537, 1073753181,
+};
+
+constexpr int64_t kQuarterTurn = 90LL * Fixed::one;
+
+}  // namespace
+
+Fixed sinDegrees(Fixed degrees) {
+  int64_t a = degrees.getRaw() % (4 * kQuarterTurn);
+  if (a < 0) a += 4 * kQuarterTurn;
+  int quadrant = (int)(a / kQuarterTurn);
+  int64_t r = a - quadrant * kQuarterTurn;
+  if (quadrant & 1) r = kQuarterTurn - r;  // sin(90° + x) = sin(90° - x)
+
+  int64_t t = r * 256;
+  int64_t i = t / kQuarterTurn, frac = t - i * kQuarterTurn;
+  int64_t v = kSineTable[i];
+  if (i < 256) v += (kSineTable[i + 1] - kSineTable[i]) * frac / kQuarterTurn;
+  return Fixed::fromRaw((int32_t)(quadrant >= 2 ? -v : v));
+}
+
+Fixed cosDegrees(Fixed degrees) {
+  return sinDegrees(degrees + Fixed(90));
+}
+
+Fixed log2(Fixed x) {
+  int32_t r = x.getRaw();
+  if (r <= 0) return Fixed::fromRaw(INT32_MIN);
+  int msb = 30;
+  while (!((r >> msb) & 1)) msb--;
+
+  // Integer part from the top bit; then x normalized to [1, 2) in Q2.30,
+  // squared once per fraction bit: each time it reaches 2, that bit is set.
+  int32_t result = (msb - Fixed::fractionBits) * Fixed::one;
+  uint64_t y = (uint64_t)r << (30 - msb);
+  for (int32_t bit = Fixed::one >> 1; bit > 0; bit >>= 1) {
+    y = (y * y) >> 30;
+    if (y >= (2ull << 30)) {
+      y >>= 1;
+      result += bit;
+    }
+  }
+  return Fixed::fromRaw(result);
+}
+
+Fixed exp2(Fixed x) {
+  int32_t frac = x.getRaw() & (Fixed::one - 1);
+  int32_t whole = (x.getRaw() - frac) / Fixed::one;
+
+  // 2^frac as the product of 2^(2^-k) for each fraction bit set, in Q2.30.
+  uint64_t y = 1ull << 30;
+  for (int k = 0; k < Fixed::fractionBits; k++) {
+    if (frac & (Fixed::one >> (k + 1))) y = (y * kExp2Table[k]) >> 30;
+  }
+  int shift = 30 - Fixed::fractionBits - whole;
+  if (shift >= 63) return Fixed();
+  if (shift < 0) {
+    if (shift < -32 || (y << -shift) > (uint64_t)INT32_MAX) return Fixed::fromRaw(INT32_MAX);
+    return Fixed::fromRaw((int32_t)(y << -shift));
+  }
+  uint64_t v = y >> shift;
+  return Fixed::fromRaw(v > (uint64_t)INT32_MAX ? INT32_MAX : (int32_t)v);
+}
+
+Fixed power(Fixed base, Fixed exponent) {
+  if (base <= Fixed()) return Fixed();
+  return exp2(exponent * log2(base));
+}
+
+FixedEntity FixedEntity::fromEntity(const Entity &e) {
+  FixedEntity f;
+  f.position = {Fixed(e.position.x), Fixed(e.position.y)};
+  f.velocity = {Fixed(e.velocity.x), Fixed(e.velocity.y)};
+  f.angle = Fixed(e.angle);
+  f.angularVelocity = Fixed(e.angularVelocity);
+  f.radius = Fixed(e.radius);
+  f.type = e.type;
+  f.ttl = Fixed(e.ttl);
+  return f;
+}
+
+Entity FixedEntity::toEntity() const {
+  Entity e;
+  e.position = {position.x.toFloat(), position.y.toFloat()};
+  e.velocity = {velocity.x.toFloat(), velocity.y.toFloat()};
+  e.angle = angle.toFloat();
+  e.angularVelocity = angularVelocity.toFloat();
+  e.radius = radius.toFloat();
+  e.type = type;
+  e.ttl = ttl.toFloat();
+  return e;
+}
@@ -0,0 +1,107 @@
+// Fixed.h
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+#include "Entity.h"
+
+// Q16.16 fixed-point number for lockstep simulation. Everything is integer
+// arithmetic, so results are bit-identical on any compiler and CPU, which
+// float math through libm (sin, cos, pow) doesn't promise. Range is about
+// +/-32768 at a resolution of 1/65536; products round down and quotients
+// toward zero.
+//
+// The double constructor is for constants and loading; once a lockstep
+// world is running its state should never pass back through floats.
+class Fixed {
+ public:
+  static constexpr int fractionBits = 16;
+  static constexpr int32_t one = 1 << fractionBits;
+
+  constexpr Fixed() = default;
+  explicit constexpr Fixed(int v) : raw(v * one) {}
+  explicit constexpr Fixed(double v) : raw((int32_t)(v * one + (v < 0 ? -0.5 : 0.5))) {}
+  static constexpr Fixed fromRaw(int32_t r) {
+    Fixed f;
+    f.raw = r;
+    return f;
+  }
+
+  constexpr int32_t getRaw() const { return raw; }
+  constexpr float toFloat() const { return raw * (1.0f / one); }
+
+  constexpr Fixed operator+(Fixed o) const { return fromRaw(raw + o.raw); }
+  constexpr Fixed operator-(Fixed o) const { return fromRaw(raw - o.raw); }
+  constexpr Fixed operator-() const { return fromRaw(-raw); }
+  constexpr Fixed operator*(Fixed o) const {
+    return fromRaw((int32_t)(((int64_t)raw * o.raw) >> fractionBits));
+  }
+  constexpr Fixed operator/(Fixed o) const {
+    return fromRaw((int32_t)((int64_t)raw * one / o.raw));
+  }
+  Fixed &operator+=(Fixed o) { return *this = *this + o; }
+  Fixed &operator-=(Fixed o) { return *this = *this - o; }
+  Fixed &operator*=(Fixed o) { return *this = *this * o; }
+  Fixed &operator/=(Fixed o) { return *this = *this / o; }
+
+  constexpr bool operator==(Fixed o) const { return raw == o.raw; }
+  constexpr bool operator!=(Fixed o) const { return raw != o.raw; }
+  constexpr bool operator<(Fixed o) const { return raw < o.raw; }
+  constexpr bool operator<=(Fixed o) const { return raw <= o.raw; }
+  constexpr bool operator>(Fixed o) const { return raw > o.raw; }
+  constexpr bool operator>=(Fixed o) const { return raw >= o.raw; }
+
+ private:
+  int32_t raw = 0;
+};
+
+// Deterministic replacements for the libm calls the simulation makes, with
+// float overloads that just call libm, so templated code (see
+// ShipControl.h, PhysicsSystem::integrate) runs on either type.
+//
+// Sine and cosine interpolate a quarter-wave table (error within 2/65536);
+// power is exp2(exponent * log2(base)) done bit by bit, good to about
+// three decimal places for the drag factors it's used for.
+Fixed sinDegrees(Fixed degrees);
+Fixed cosDegrees(Fixed degrees);
+Fixed log2(Fixed x);  // x > 0
+Fixed exp2(Fixed x);  // saturates at the top of the range
+Fixed power(Fixed base, Fixed exponent);  // base > 0
+
+inline float sinDegrees(float degrees) {
+  return std::sin(glm::radians(degrees));
+}
+inline float cosDegrees(float degrees) {
+  return std::cos(glm::radians(degrees));
+}
+inline float power(float base, float exponent) {
+  return std::pow(base, exponent);
+}
+
+struct FixedVec2 {
+  Fixed x, y;
+
+  constexpr FixedVec2() = default;
+  constexpr FixedVec2(Fixed x, Fixed y) : x(x), y(y) {}
+
+  constexpr FixedVec2 operator+(FixedVec2 o) const { return {x + o.x, y + o.y}; }
+  constexpr FixedVec2 operator-(FixedVec2 o) const { return {x - o.x, y - o.y}; }
+  constexpr FixedVec2 operator*(Fixed s) const { return {x * s, y * s}; }
+  FixedVec2 &operator+=(FixedVec2 o) { return *this = *this + o; }
+  FixedVec2 &operator-=(FixedVec2 o) { return *this = *this - o; }
+  FixedVec2 &operator*=(Fixed s) { return *this = *this * s; }
+};
+
+// Entity with Fixed fields, for lockstep worlds.
+struct FixedEntity {
+  FixedVec2 position;
+  FixedVec2 velocity;
+  Fixed angle;            // degrees
+  Fixed angularVelocity;  // degrees per second
+  Fixed radius{8};
+  EntityType type{EntityType::Asteroid};
+  Fixed ttl{-1};
+
+  static FixedEntity fromEntity(const Entity &e);
+  Entity toEntity() const;
+};
@@ -0,0 +1,54 @@
+// FixedWorld.cpp
+#include "FixedWorld.h"
+
+#include "PhysicsSystem.h"
+#include "ShipControl.h"
+
+size_t FixedWorld::createEntity(const FixedEntity &e) {
+  entities.push_back(e);
+  return entities.size() - 1;
+}
+
+void FixedWorld::step(const uint8_t *buttons, size_t count) {
+  // Fire from where the ship is, then steer, as main.cpp does.
+  fired.clear();
+  size_t ship = 0;
+  for (FixedEntity &e : entities) {
+    if (e.type != EntityType::Ship || e.radius < Fixed(0)) continue;
+    uint8_t b = ship < count ? buttons[ship] : 0;
+    ship++;
+    if (b & kInputFire) fired.push_back(makeBullet(e));
+    steerShip(e, b, timeStep);
+  }
+
+  size_t reuse = 0;
+  for (const FixedEntity &bullet : fired) {
+    while (reuse < entities.size() &&
+           !(entities[reuse].type == EntityType::Bullet && entities[reuse].radius < Fixed(0))) {
+      reuse++;
+    }
+    if (reuse < entities.size())
+      entities[reuse++] = bullet;
+    else
+      entities.push_back(bullet);
+  }
+
+  PhysicsSystem::integrate(entities.data(), entities.size(), timeStep);
+  tick++;
+}
+
+uint64_t FixedWorld::checksum() const {
+  uint64_t hash = 1469598103934665603ull;
+  auto mix = [&](uint32_t v) {
+    for (int b = 0; b < 4; b++) hash = (hash ^ ((v >> (8 * b)) & 0xff)) * 1099511628211ull;
+  };
+  mix(tick);
+  for (const FixedEntity &e : entities) {
+    for (Fixed f : {e.position.x, e.position.y, e.velocity.x, e.velocity.y, e.angle,
+                    e.angularVelocity, e.radius, e.ttl}) {
+      mix((uint32_t)f.getRaw());
+    }
+    mix((uint32_t)e.type);
+  }
+  return hash;
+}
@@ -0,0 +1,43 @@
+// FixedWorld.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Fixed.h"
+
+// A lockstep world run entirely in Q16.16: ships steered by each tick's
+// buttons (steerShip), bullets fired on kInputFire (makeBullet) and expired,
+// and everything moved and wrapped by PhysicsSystem::integrate. Every step
+// is integer math, so peers on any compiler and CPU that start from the
+// same state and feed the same buttons hold bit-identical worlds; checksum
+// lets them confirm it each tick.
+//
+// There are no collisions: the collision pipeline runs on floats (see
+// PhysicsSystem) and isn't part of the fixed-point path, so a game that
+// needs hits to agree across platforms must resolve them itself on the
+// fixed state.
+class FixedWorld {
+ public:
+  size_t createEntity(const FixedEntity &e);
+  std::vector<FixedEntity> &getEntities() { return entities; }
+  const std::vector<FixedEntity> &getEntities() const { return entities; }
+
+  // Runs one tick. `buttons[k]` steers the k-th ship in slot order (ships
+  // past `count` get none). A fired bullet takes the first dead bullet's
+  // slot, or a new one at the end.
+  void step(const uint8_t *buttons, size_t count);
+  uint32_t getTick() const { return tick; }
+
+  void setTimeStep(Fixed dt) { timeStep = dt; }
+  Fixed getTimeStep() const { return timeStep; }
+
+  // FNV-1a over the tick and every entity's raw fields.
+  uint64_t checksum() const;
+
+ private:
+  std::vector<FixedEntity> entities;
+  std::vector<FixedEntity> fired;  // scratch
+  Fixed timeStep{1.0 / 60.0};
+  uint32_t tick = 0;
+};
@@ -0,0 +1,111 @@
+// FractureSystem.cpp
+#include "FractureSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+inline float wrapCoordinate(float v) {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  return v - period * std::floor((v + bound) / period);
+}
+
+// Break-up angle, scrambled from the asteroid and seed so it's repeatable.
+inline float breakAngle(uint32_t asteroid, uint32_t seed) {
+  uint32_t h = asteroid * 2654435761u ^ seed * 40503u;
+  h ^= h >> 15;
+  h *= 2246822519u;
+  h ^= h >> 13;
+  return h * (2.0f * glm::pi<float>() / 4294967296.0f);
+}
+
+}  // namespace
+
+void FractureSystem::reserve(EntityManager &em, size_t count) {
+  if (pool.size() >= count) return;
+  size_t adding = count - pool.size();
+  em.reserve(em.getEntities().size() + adding);
+  Entity dead;
+  dead.radius = -1;
+  for (size_t i = 0; i < adding; i++) pool.push_back((uint32_t)em.createEntity(dead));
+}
+
+void FractureSystem::queueSplit(uint32_t asteroid, glm::vec2 impulse) {
+  if (pendingIndex.size() <= asteroid) pendingIndex.resize(asteroid + 1, -1);
+  int32_t &index = pendingIndex[asteroid];
+  if (index >= 0) {
+    pending[index].impulse += impulse;
+    return;
+  }
+  index = (int32_t)pending.size();
+  pending.push_back({asteroid, impulse});
+}
+
+void FractureSystem::queueImpacts(std::vector<Entity> &entities,
+                                  const std::vector<Impact> &impacts) {
+  for (const Impact &impact : impacts) {
+    Entity &bullet = entities[impact.bullet];
+    if (entities[impact.target].type != EntityType::Asteroid || bullet.radius < 0) continue;
+    queueSplit(impact.target, bullet.velocity * (bullet.radius * bullet.radius));
+    bullet.radius = -1;
+  }
+}
+
+size_t FractureSystem::apply(EntityManager &em) {
+  seed++;
+  if (pending.empty()) return 0;
+
+  const float pieceScale = 1.0f / std::sqrt((float)pieces);
+  auto splits = [&](const Entity &e) {
+    return e.type == EntityType::Asteroid && e.radius >= 0 && e.radius * pieceScale >= minRadius;
+  };
+
+  // Make sure the pool covers the whole batch up front.
+  size_t needed = 0;
+  for (const Split &s : pending) {
+    if (splits(em.getEntities()[s.asteroid])) needed += pieces - 1;
+  }
+  if (needed > pool.size()) reserve(em, std::max(needed, 2 * pool.size()));
+
+  std::vector<Entity> &entities = em.getEntities();
+  const float step = 2.0f * glm::pi<float>() / pieces;
+  size_t spawned = 0;
+  for (const Split &s : pending) {
+    pendingIndex[s.asteroid] = -1;
+    const Entity parent = entities[s.asteroid];
+    if (parent.type != EntityType::Asteroid || parent.radius < 0) continue;
+    if (!splits(parent)) {
+      entities[s.asteroid].radius = -1;
+      pool.push_back(s.asteroid);
+      continue;
+    }
+
+    // Equal pieces around the parent's centre, just touching their
+    // neighbours, each moving out from the centre at the same speed.
+    float mass = parent.radius * parent.radius;
+    glm::vec2 velocity = parent.velocity + s.impulse / mass;
+    Entity piece = parent;
+    piece.radius = parent.radius * pieceScale;
+    float offset = piece.radius * PhysicsSystem::radiusToWorld / std::sin(0.5f * step);
+    float angle = breakAngle(s.asteroid, seed);
+    for (int j = 0; j < pieces; j++) {
+      glm::vec2 dir(std::cos(angle + j * step), std::sin(angle + j * step));
+      glm::vec2 p = parent.position + dir * offset;
+      piece.position = glm::vec2(wrapCoordinate(p.x), wrapCoordinate(p.y));
+      piece.velocity = velocity + dir * spreadSpeed;
+      uint32_t slot = s.asteroid;  // the parent's slot holds the first piece
+      if (j > 0) {
+        slot = pool.back();
+        pool.pop_back();
+        spawned++;
+      }
+      entities[slot] = piece;
+    }
+  }
+  pending.clear();
+  return spawned;
+}
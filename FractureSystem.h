@@ -0,0 +1,87 @@
+// FractureSystem.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "ContinuousCollision.h"
+#include "EntityManager.h"
+
+// Splits hit asteroids into equal smaller pieces. Splits are only queued
+// while collisions are handled and all applied afterwards in one pass, so
+// the entity array never changes shape mid-frame.
+//
+// Fragments come from a pool of dead entity slots kept at the end of the
+// array (see reserve), reused in place, so a burst of splits neither
+// allocates nor moves the array. Pieces too small to split again are
+// removed and their slots go back to the pool. The pool only grows, by
+// doubling, if a burst outruns it.
+//
+// Mass is radius squared, as in ContactSolver. Each piece gets an equal
+// share of the area, and pieces fly apart symmetrically about the parent's
+// velocity (plus whatever momentum the hit delivered), so total mass and
+// momentum are conserved. The pieces' orientation is scrambled from the
+// asteroid's slot and a seed, which apply advances by one; the seed is
+// plain state (getSeed/setSeed), so a replay or rollback that restores it
+// splits the same way.
+class FractureSystem {
+ public:
+  // Adds dead slots to the pool until it holds at least `count`. Call once at
+  // load with the largest burst expected.
+  void reserve(EntityManager &em, size_t count);
+
+  // Queues a split; `impulse` is the momentum the hit delivers (mass radius
+  // squared times velocity). Several hits on one asteroid in a frame merge.
+  void queueSplit(uint32_t asteroid, glm::vec2 impulse);
+  // Queues a split for every bullet impact on an asteroid and removes those
+  // bullets.
+  void queueImpacts(std::vector<Entity> &entities, const std::vector<Impact> &impacts);
+
+  // Performs the queued splits; returns the number of fragments spawned.
+  size_t apply(EntityManager &em);
+
+  void setPieces(int n) { pieces = n < 2 ? 2 : n; }
+  int getPieces() const { return pieces; }
+  // Pieces smaller than this (pixels) aren't spawned; the asteroid is destroyed.
+  void setMinRadius(float r) { minRadius = r; }
+  float getMinRadius() const { return minRadius; }
+  // How fast pieces separate, world units per second.
+  void setSpreadSpeed(float s) { spreadSpeed = s; }
+  float getSpreadSpeed() const { return spreadSpeed; }
+
+  // Varies the break-up angle from update to update; apply adds one.
+  void setSeed(uint32_t s) { seed = s; }
+  uint32_t getSeed() const { return seed; }
+
+  size_t getPoolSize() const { return pool.size(); }
+  // Everything kept from one update to the next: the free slots and the
+  // seed. Rollback saves it alongside the entities.
+  struct State {
+    std::vector<uint32_t> pool;
+    uint32_t seed = 0;
+  };
+  void saveState(State &state) const {
+    state.pool = pool;
+    state.seed = seed;
+  }
+  void restoreState(const State &state) {
+    pool = state.pool;
+    seed = state.seed;
+  }
+  size_t getPendingCount() const { return pending.size(); }
+
+ private:
+  struct Split {
+    uint32_t asteroid;
+    glm::vec2 impulse;
+  };
+
+  int pieces = 3;
+  float minRadius = 6.0f;
+  float spreadSpeed = 0.15f;
+  uint32_t seed = 0;
+
+  std::vector<Split> pending;
+  std::vector<int32_t> pendingIndex;  // per entity: index into pending, or -1
+  std::vector<uint32_t> pool;         // free (dead) slots, taken from the back
+};
@@ -0,0 +1,54 @@
+// GLExtensions.cpp
+#include "GLExtensions.h"
+
+#include <cstring>
+
+#ifndef GL_VERSION_4_1
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = nullptr;
+#endif
+#ifndef GL_VERSION_4_3
+PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = nullptr;
+#endif
+
+GLExtensions glExtensions;
+
+static bool hasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, i);
+    if (ext && !std::strcmp(ext, name)) return true;
+  }
+  return false;
+}
+
+static bool hasVersion(int major, int minor) {
+  GLint actualMajor = 0, actualMinor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &actualMajor);
+  glGetIntegerv(GL_MINOR_VERSION, &actualMinor);
+  return actualMajor > major || (actualMajor == major && actualMinor >= minor);
+}
+
+void loadGLExtensions(GLADloadproc load) {
+  glExtensions = GLExtensions();
+
+  if (hasVersion(4, 1) || hasExtension("GL_ARB_get_program_binary")) {
+    glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+    glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+    glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glExtensions.programBinary =
+        glGetProgramBinary && glProgramBinary && glProgramParameteri && formats > 0;
+  }
+
+  // Compute shaders are written as GLSL 430, so require a real 4.3 context.
+  if (hasVersion(4, 3)) {
+    glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+    glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+    glExtensions.computeShaders = glDispatchCompute && glMemoryBarrier;
+  }
+}
@@ -0,0 +1,51 @@
+// GLExtensions.h
+#pragma once
+#include "glad/glad.h"
+
+// Entry points beyond the GL 3.3 set our generated GLAD covers. They are
+// loaded after GLAD with the same proc-address function and may be null;
+// check the matching flag before use.
+
+#ifndef GL_VERSION_4_1
+// GL 4.1 / ARB_get_program_binary
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length,
+                                                  GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat,
+                                               const void *binary, GLsizei length);
+typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+extern PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glad_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri;
+#define glGetProgramBinary glad_glGetProgramBinary
+#define glProgramBinary glad_glProgramBinary
+#define glProgramParameteri glad_glProgramParameteri
+#endif
+
+#ifndef GL_VERSION_4_3
+// GL 4.3 / ARB_compute_shader + ARB_shader_storage_buffer_object
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+typedef void(APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint numGroupsX, GLuint numGroupsY,
+                                                GLuint numGroupsZ);
+typedef void(APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+extern PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute;
+extern PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier;
+#define glDispatchCompute glad_glDispatchCompute
+#define glMemoryBarrier glad_glMemoryBarrier
+#endif
+
+struct GLExtensions {
+  bool programBinary = false;   // ARB_get_program_binary with at least one binary format
+  bool computeShaders = false;  // compute shaders + shader storage buffers (GL 4.3)
+};
+
+extern GLExtensions glExtensions;
+
+// Call once after gladLoadGLLoader with the same loader.
+void loadGLExtensions(GLADloadproc load);
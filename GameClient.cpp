@@ -0,0 +1,284 @@
+// GameClient.cpp
+#include "GameClient.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+constexpr double kConnectRetry = 0.25;  // seconds between Connect attempts
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+
+inline float nearestOffset(float d) {
+  return d - kPeriod * std::round(d / kPeriod);
+}
+
+inline float wrapCoordinate(float v) {
+  return v - kPeriod * std::floor((v + kBound) / kPeriod);
+}
+
+// Blends along the short way round the torus, and the short way round for
+// angles.
+Entity blend(const Entity &a, const Entity &b, float t) {
+  Entity e = b;
+  glm::vec2 d(nearestOffset(b.position.x - a.position.x),
+              nearestOffset(b.position.y - a.position.y));
+  glm::vec2 p = a.position + d * t;
+  e.position = glm::vec2(wrapCoordinate(p.x), wrapCoordinate(p.y));
+  e.velocity = a.velocity + (b.velocity - a.velocity) * t;
+  float turn = std::fmod(b.angle - a.angle + 540.0f, 360.0f) - 180.0f;
+  e.angle = std::fmod(a.angle + turn * t + 360.0f, 360.0f);
+  return e;
+}
+
+}  // namespace
+
+bool GameClient::connect(const NetAddress &address, double now) {
+  if (!socket.open(0)) return false;
+  server = address;
+  connected = false;
+  haveSnapshot = false;
+  haveClockOffset = false;
+  sequence = 0;
+  lastAcked = 0;
+  ackedSnapshot = 0;
+  for (InputCommand &c : recent) c = InputCommand();
+  for (Snapshot &s : snapshots) s = Snapshot();
+
+  PacketWriter w(PacketType::Connect);
+  socket.send(server, w.data(), w.size());
+  lastConnectAttempt = now;
+  return true;
+}
+
+void GameClient::disconnect() {
+  if (connected) {
+    PacketWriter w(PacketType::Disconnect);
+    w.u16(clientId);
+    socket.send(server, w.data(), w.size());
+  }
+  connected = false;
+  socket.close();
+}
+
+void GameClient::update(double now) {
+  if (!socket.isOpen()) return;
+  if (!connected && now - lastConnectAttempt >= kConnectRetry) {
+    PacketWriter w(PacketType::Connect);
+    socket.send(server, w.data(), w.size());
+    lastConnectAttempt = now;
+  }
+
+  uint8_t buffer[kMaxPacketSize];
+  NetAddress from;
+  for (;;) {
+    int size = socket.receive(from, buffer, sizeof(buffer));
+    if (size <= 0) break;
+    if (from != server) continue;
+    PacketReader reader(buffer, (size_t)size);
+    PacketType type;
+    if (!reader.header(type)) continue;
+    switch (type) {
+      case PacketType::Accept:
+        handleAccept(reader);
+        break;
+      case PacketType::Snapshot:
+        if (connected) handleSnapshot(reader, now);
+        break;
+      case PacketType::Disconnect:
+        connected = false;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void GameClient::handleAccept(PacketReader &reader) {
+  uint16_t id = reader.u16();
+  uint32_t shipIndex = reader.u32();
+  float interval = reader.f32();
+  if (!reader.ok() || !(interval > 0.0f)) return;
+  clientId = id;
+  ship = shipIndex;
+  tickInterval = interval;
+  connected = true;
+}
+
+GameClient::Snapshot *GameClient::snapshotFor(uint32_t tick) {
+  // The slot already collecting this tick, else an unused one, else the
+  // oldest incomplete one, else the oldest complete one. The newest
+  // complete snapshot is never evicted: it's what interpolate holds on to
+  // and the baseline the server encodes against, so losing it would stall
+  // decoding until the server gives up on the baseline. Ticks too old to
+  // be worth a slot are dropped.
+  Snapshot *newest = nullptr;
+  for (Snapshot &s : snapshots) {
+    if (s.fragmentCount > 0 && s.tick == tick) return &s;
+    if (s.complete && (!newest || s.tick > newest->tick)) newest = &s;
+  }
+  Snapshot *victim = nullptr;
+  auto rank = [](const Snapshot &s) { return s.fragmentCount == 0 ? 0 : s.complete ? 2 : 1; };
+  for (Snapshot &s : snapshots) {
+    if (&s == newest) continue;
+    if (!victim || rank(s) < rank(*victim) ||
+        (rank(s) == rank(*victim) && s.tick < victim->tick)) {
+      victim = &s;
+    }
+  }
+  if (victim->fragmentCount > 0) {
+    // Against an incomplete slot, only the newest complete tick counts:
+    // otherwise a few bogus far-future ticks would lock out real ones.
+    uint32_t oldest = victim->complete ? victim->tick : newest ? newest->tick : 0;
+    if (tick < oldest) return nullptr;
+    if (victim->fragmentsReceived < victim->fragmentCount) stats.incomplete++;
+  }
+  victim->tick = tick;
+  victim->fragmentCount = 0;
+  victim->fragmentsReceived = 0;
+  victim->payloadSize = 0;
+  victim->complete = false;
+  return victim;
+}
+
+void GameClient::handleSnapshot(PacketReader &reader, double now) {
+  uint32_t tick = reader.u32();
+  uint32_t acked = reader.u32();
+  uint32_t baselineTick = reader.u32();
+  uint8_t flags = reader.u8();
+  uint16_t fragment = reader.u16();
+  uint16_t fragmentCount = reader.u16();
+  uint16_t bytes = reader.u16();
+  const uint8_t *chunk = reader.raw(bytes);
+  if (!reader.ok() || fragment >= fragmentCount || fragmentCount > kMaxSnapshotFragments ||
+      bytes > kSnapshotChunkBytes) {
+    return;
+  }
+
+  if (acked > lastAcked && acked <= sequence && sequence - acked < sendTimeSlots) {
+    double ms = (now - sendTimes[acked % sendTimeSlots]) * 1000.0;
+    stats.latencySamples++;
+    stats.latencySumMs += ms;
+    stats.latencyMaxMs = std::max(stats.latencyMaxMs, ms);
+  }
+  lastAcked = std::max(lastAcked, acked);
+
+  Snapshot *slot = snapshotFor(tick);
+  if (!slot) return;
+  Snapshot &s = *slot;
+  if (s.fragmentCount == 0) {
+    s.fragmentCount = fragmentCount;
+    s.baselineTick = baselineTick;
+    s.flags = flags;
+    s.haveFragment.assign(fragmentCount, 0);
+    s.payload.resize(fragmentCount * kSnapshotChunkBytes);
+  }
+  // Only the last fragment may be short.
+  bool last = fragment + 1 == fragmentCount;
+  if (fragmentCount != s.fragmentCount || baselineTick != s.baselineTick || flags != s.flags ||
+      s.haveFragment[fragment] || (!last && bytes != kSnapshotChunkBytes)) {
+    return;
+  }
+  std::memcpy(s.payload.data() + fragment * kSnapshotChunkBytes, chunk, bytes);
+  if (last) s.payloadSize = fragment * kSnapshotChunkBytes + bytes;
+  s.haveFragment[fragment] = 1;
+  if (++s.fragmentsReceived < s.fragmentCount) return;
+
+  // The baseline is a snapshot we acknowledged, so normally still here.
+  const std::vector<QuantizedEntity> *baseline = nullptr;
+  if (baselineTick != 0) {
+    for (const Snapshot &b : snapshots) {
+      if (b.complete && b.tick == baselineTick) baseline = &b.state;
+    }
+  }
+  float elapsed = (tick - baselineTick) * tickInterval;
+  bool decoded = false;
+  if (baselineTick == 0 || baseline) {
+    const uint8_t *data = s.payload.data();
+    decoded = (flags & kSnapshotView)
+                  ? SnapshotCodec::decodeView(data, s.payloadSize, baseline, elapsed, s.state)
+                  : SnapshotCodec::decode(data, s.payloadSize, baseline, elapsed, s.state);
+  }
+  if (!decoded) {
+    stats.undecodable++;
+    return;
+  }
+  SnapshotCodec::dequantize(s.state, s.entities);
+
+  s.complete = true;
+  stats.snapshots++;
+  haveSnapshot = true;
+  ackedSnapshot = std::max(ackedSnapshot, tick);
+
+  // The offset only moves slowly, so one late datagram doesn't jerk the
+  // whole view.
+  double offset = now - tick * (double)tickInterval;
+  if (!haveClockOffset || offset < clockOffset) {
+    clockOffset = offset;  // an earlier arrival is a better estimate
+    haveClockOffset = true;
+  } else {
+    clockOffset += (offset - clockOffset) * 0.05;
+  }
+}
+
+void GameClient::sendInput(uint8_t buttons, double now) {
+  if (!connected) return;
+  sequence++;
+  std::copy_backward(recent, recent + resentCommands - 1, recent + resentCommands);
+  recent[0] = {sequence, buttons};
+  sendTimes[sequence % sendTimeSlots] = now;
+
+  uint8_t count = (uint8_t)std::min<uint32_t>(sequence, resentCommands);
+  PacketWriter w(PacketType::Input);
+  w.u16(clientId);
+  w.u32(ackedSnapshot);
+  w.u8(count);
+  for (uint8_t i = 0; i < count; i++) {
+    w.u32(recent[i].sequence);
+    w.u8(recent[i].buttons);
+  }
+  socket.send(server, w.data(), w.size());
+}
+
+bool GameClient::interpolate(double now, std::vector<Entity> &out) {
+  if (!haveSnapshot) return false;
+
+  // Newest complete snapshot at or before the render time, and the oldest
+  // one after it.
+  double renderTick = (now - clockOffset - interpolationDelay) / (double)tickInterval;
+  const Snapshot *before = nullptr, *after = nullptr;
+  for (const Snapshot &s : snapshots) {
+    if (!s.complete) continue;
+    if (s.tick <= renderTick) {
+      if (!before || s.tick > before->tick) before = &s;
+    } else if (!after || s.tick < after->tick) {
+      after = &s;
+    }
+  }
+
+  if (!before && !after) return false;  // none complete any more
+  if (!before || !after) {
+    // Past the newest (hold it) or before the oldest (show the oldest).
+    const Snapshot *only = before ? before : after;
+    if (before) stats.stalls++;
+    out = only->entities;
+    return true;
+  }
+
+  float t = (float)((renderTick - before->tick) / (double)(after->tick - before->tick));
+  const std::vector<Entity> &a = before->entities, &b = after->entities;
+  out.resize(b.size());
+  for (size_t i = 0; i < b.size(); i++) {
+    // Entities in only one of the two spawned or died in between; show
+    // them (or a slot reused for another) as the later snapshot has them.
+    bool inBoth =
+        i < a.size() && a[i].radius >= 0 && b[i].radius >= 0 && a[i].type == b[i].type;
+    out[i] = inBoth ? blend(a[i], b[i], t) : b[i];
+  }
+  return true;
+}
@@ -0,0 +1,101 @@
+// GameClient.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Entity.h"
+#include "NetProtocol.h"
+#include "SnapshotCodec.h"
+#include "UdpSocket.h"
+
+// Client side of GameServer. Sends the player's buttons every frame and
+// shows the world a little in the past: snapshots are buffered, and
+// interpolate blends the two either side of (estimated server time -
+// interpolation delay), so entities move smoothly even though snapshots
+// arrive only every few ticks and at uneven intervals.
+//
+// Times passed in are seconds on any steady clock the caller likes.
+class GameClient {
+ public:
+  struct Stats {
+    uint64_t snapshots = 0;    // complete ones
+    uint64_t incomplete = 0;   // superseded before all fragments arrived
+    uint64_t undecodable = 0;  // baseline gone, or corrupt
+    // From sending a command to a snapshot acknowledging it.
+    uint64_t latencySamples = 0;
+    double latencySumMs = 0.0;
+    double latencyMaxMs = 0.0;
+    // interpolate calls that ran past the newest snapshot and had to hold it.
+    uint64_t stalls = 0;
+  };
+
+  // Opens a socket and starts asking `server` to let us in.
+  bool connect(const NetAddress &server, double now);
+  void disconnect();
+  bool isConnected() const { return connected; }
+
+  // Reads everything waiting on the socket; call every frame.
+  void update(double now);
+  // Sends this frame's buttons (InputButtons), along with the last few
+  // frames' in case of loss.
+  void sendInput(uint8_t buttons, double now);
+
+  // Entities as the server had them getInterpolationDelay() seconds ago,
+  // indexed like the server's array with dead slots at radius -1. False
+  // until the first snapshot has arrived.
+  bool interpolate(double now, std::vector<Entity> &out);
+
+  uint32_t getShipIndex() const { return ship; }
+  // A little over two snapshot intervals rides out one lost or late one.
+  void setInterpolationDelay(double seconds) { interpolationDelay = seconds; }
+  double getInterpolationDelay() const { return interpolationDelay; }
+
+  const Stats &getStats() const { return stats; }
+  const UdpSocket &getSocket() const { return socket; }
+
+ private:
+  struct Snapshot {
+    uint32_t tick = 0;
+    uint32_t baselineTick = 0;
+    uint8_t flags = 0;
+    uint16_t fragmentCount = 0;
+    uint16_t fragmentsReceived = 0;
+    std::vector<uint8_t> haveFragment;
+    std::vector<uint8_t> payload;  // fragments reassembled
+    size_t payloadSize = 0;
+    std::vector<QuantizedEntity> state;  // decoded; the baseline for later ones
+    std::vector<Entity> entities;        // by slot; dead at radius -1
+    bool complete = false;
+  };
+
+  static constexpr size_t bufferedSnapshots = 8;
+  static constexpr size_t resentCommands = 4;
+  static constexpr size_t sendTimeSlots = 256;  // by sequence, for latency
+
+  void handleAccept(PacketReader &reader);
+  void handleSnapshot(PacketReader &reader, double now);
+  Snapshot *snapshotFor(uint32_t tick);  // null if too old to keep
+
+  UdpSocket socket;
+  NetAddress server;
+  bool connected = false;
+  double lastConnectAttempt = 0.0;
+  uint16_t clientId = 0;
+  uint32_t ship = 0;
+  float tickInterval = 1.0f / 60.0f;
+  double interpolationDelay = 0.1;
+
+  uint32_t sequence = 0;
+  InputCommand recent[resentCommands];  // newest first
+  double sendTimes[sendTimeSlots] = {};
+  uint32_t lastAcked = 0;
+  uint32_t ackedSnapshot = 0;  // newest snapshot decoded, told to the server
+
+  Snapshot snapshots[bufferedSnapshots];
+  bool haveSnapshot = false;
+  // Client time minus server time, smoothed over arrivals.
+  double clockOffset = 0.0;
+  bool haveClockOffset = false;
+
+  Stats stats;
+};
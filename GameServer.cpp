@@ -0,0 +1,258 @@
+// GameServer.cpp
+#include "GameServer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Broadphase.h"
+
+GameServer::GameServer(float tickRate)
+    : tickInterval(1.0f / tickRate), timeoutTicks((uint32_t)(5.0f * tickRate)) {
+  physics.setBroadphase(createBroadphase("grid"));
+}
+
+void GameServer::setInterestManagement(bool enabled) {
+  if (enabled == interestEnabled) return;
+  interestEnabled = enabled;
+  // What a client decoded under one scheme is no baseline under the other.
+  for (SentSnapshot &s : history) s.tick = 0;
+  for (Client &c : clients) {
+    c.viewer = InterestManager::Viewer();
+    c.views.clear();
+    c.viewsNext = 0;
+  }
+}
+
+bool GameServer::start(uint16_t port) {
+  return socket.open(port);
+}
+
+void GameServer::stop() {
+  for (const Client &c : clients) {
+    PacketWriter w(PacketType::Disconnect);
+    w.u16(c.id);
+    socket.send(c.address, w.data(), w.size());
+  }
+  clients.clear();
+  socket.close();
+}
+
+void GameServer::tick() {
+  auto start = std::chrono::steady_clock::now();
+
+  receive();
+  for (size_t i = clients.size(); i-- > 0;) {
+    if (currentTick - clients[i].lastHeard > timeoutTicks) dropClient(i);
+  }
+  steerShips();
+  physics.update(entities, tickInterval);
+  currentTick++;
+  if (currentTick % snapshotInterval == 0) sendSnapshots();
+
+  lastTickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                   .count();
+}
+
+void GameServer::receive() {
+  uint8_t buffer[kMaxPacketSize];
+  NetAddress from;
+  for (;;) {
+    int size = socket.receive(from, buffer, sizeof(buffer));
+    if (size <= 0) break;
+    PacketReader reader(buffer, (size_t)size);
+    PacketType type;
+    if (!reader.header(type)) continue;
+    switch (type) {
+      case PacketType::Connect:
+        handleConnect(from);
+        break;
+      case PacketType::Input:
+        handleInput(reader, from);
+        break;
+      case PacketType::Disconnect:
+        handleDisconnect(reader, from);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+GameServer::Client *GameServer::findClient(const NetAddress &from, uint16_t id) {
+  for (Client &c : clients) {
+    if (c.address == from && (id == 0 || c.id == id)) return &c;
+  }
+  return nullptr;
+}
+
+void GameServer::handleConnect(const NetAddress &from) {
+  // Connect is resent until accepted, so a known address just gets its
+  // Accept again.
+  Client *client = findClient(from, 0);
+  if (!client) {
+    Entity ship;
+    ship.type = EntityType::Ship;
+    ship.radius = kShipRadius;
+    Client c;
+    c.address = from;
+    c.id = nextClientId++;
+    if (nextClientId == 0) nextClientId = 1;
+    c.ship = spawn(ship);
+    clients.push_back(c);
+    client = &clients.back();
+  }
+  client->lastHeard = currentTick;
+
+  PacketWriter w(PacketType::Accept);
+  w.u16(client->id);
+  w.u32(client->ship);
+  w.f32(tickInterval);
+  socket.send(from, w.data(), w.size());
+}
+
+void GameServer::handleInput(PacketReader &reader, const NetAddress &from) {
+  uint16_t id = reader.u16();
+  uint32_t ackedSnapshot = reader.u32();
+  uint8_t count = reader.u8();
+  InputCommand commands[255];
+  for (uint8_t i = 0; i < count; i++) {
+    commands[i].sequence = reader.u32();
+    commands[i].buttons = reader.u8();
+  }
+  Client *client = findClient(from, id);
+  if (!reader.ok() || !client) return;
+  client->lastHeard = currentTick;
+  client->ackedSnapshot = std::max(client->ackedSnapshot, ackedSnapshot);
+
+  // Newest first; take the ones not seen yet, oldest to newest, so held
+  // keys come from the newest and no fire press is lost.
+  for (int i = count - 1; i >= 0; i--) {
+    if (commands[i].sequence <= client->lastSequence) continue;
+    client->lastSequence = commands[i].sequence;
+    client->buttons = commands[i].buttons;
+    if (commands[i].buttons & kInputFire) client->fire = true;
+  }
+}
+
+void GameServer::handleDisconnect(PacketReader &reader, const NetAddress &from) {
+  uint16_t id = reader.u16();
+  for (size_t i = 0; i < clients.size(); i++) {
+    if (clients[i].address == from && clients[i].id == id) {
+      dropClient(i);
+      return;
+    }
+  }
+}
+
+void GameServer::dropClient(size_t index) {
+  entities.getEntities()[clients[index].ship].radius = -1;  // mark as dead
+  clients.erase(clients.begin() + index);
+}
+
+uint32_t GameServer::spawn(const Entity &e) {
+  // Dead slots of the same type are free to reuse; other types' may belong
+  // to a pool (FractureSystem keeps dead asteroid slots for fragments).
+  std::vector<Entity> &es = entities.getEntities();
+  for (uint32_t i = 0; i < es.size(); i++) {
+    if (es[i].radius < 0 && es[i].type == e.type) {
+      es[i] = e;
+      return i;
+    }
+  }
+  return (uint32_t)entities.createEntity(e);
+}
+
+void GameServer::steerShips() {
+  for (Client &c : clients) {
+    Entity &ship = entities.getEntities()[c.ship];
+    steerShip(ship, c.buttons, tickInterval);
+    if (c.fire) {
+      c.fire = false;
+      spawn(makeBullet(ship));  // may reallocate; `ship` isn't used after
+    }
+  }
+}
+
+const std::vector<QuantizedEntity> *GameServer::findSent(uint32_t tick) const {
+  if (tick == 0) return nullptr;
+  for (const SentSnapshot &s : history) {
+    if (s.tick == tick) return &s.state;
+  }
+  return nullptr;
+}
+
+void GameServer::sendSnapshots() {
+  SentSnapshot &sent = history[historyNext];
+  historyNext = (historyNext + 1) % snapshotHistory;
+  sent.tick = currentTick;
+  SnapshotCodec::quantize(entities.getEntities(), sent.state);
+  if (interestEnabled) {
+    sent.tick = 0;  // not a baseline for anyone
+    sendViews(sent.state);
+    return;
+  }
+
+  // Clients that acknowledged the same snapshot share one encoding.
+  size_t encodings = 0;
+  for (const Client &c : clients) {
+    const std::vector<QuantizedEntity> *baseline = findSent(c.ackedSnapshot);
+    uint32_t baselineTick = baseline ? c.ackedSnapshot : 0;
+
+    size_t e = 0;
+    while (e < encodings && encodedBaselines[e] != baselineTick) e++;
+    if (e == encodings) {
+      if (encoded.size() == encodings) encoded.emplace_back();
+      if (encodedBaselines.size() == encodings) encodedBaselines.push_back(0);
+      encodedBaselines[e] = baselineTick;
+      encoded[e].clear();
+      float elapsed = (currentTick - baselineTick) * tickInterval;
+      SnapshotCodec::encode(sent.state, baseline, elapsed, encoded[e]);
+      encodings++;
+    }
+
+    sendPayload(c, baselineTick, 0, encoded[e]);
+  }
+}
+
+void GameServer::sendViews(const std::vector<QuantizedEntity> &state) {
+  const std::vector<Entity> &es = entities.getEntities();
+  interest.prepare(es);
+  for (Client &c : clients) {
+    if (c.views.size() < snapshotHistory) c.views.resize(snapshotHistory);
+    SentView &sent = c.views[c.viewsNext];
+    c.viewsNext = (c.viewsNext + 1) % snapshotHistory;
+    sent.tick = currentTick;
+    interest.update(c.viewer, es[c.ship].position, c.ship, es, state, currentTick, tickInterval,
+                    sent.view);
+
+    const SnapshotView *baseline = nullptr;
+    for (const SentView &v : c.views) {
+      if (c.ackedSnapshot != 0 && v.tick == c.ackedSnapshot) baseline = &v.view;
+    }
+    uint32_t baselineTick = baseline ? c.ackedSnapshot : 0;
+    viewPayload.clear();
+    float elapsed = (currentTick - baselineTick) * tickInterval;
+    SnapshotCodec::encodeView(sent.view, baseline, elapsed, viewPayload);
+    sendPayload(c, baselineTick, kSnapshotView, viewPayload);
+  }
+}
+
+void GameServer::sendPayload(const Client &c, uint32_t baselineTick, uint8_t flags,
+                             const std::vector<uint8_t> &payload) {
+  const size_t fragments = (payload.size() + kSnapshotChunkBytes - 1) / kSnapshotChunkBytes;
+  if (fragments > kMaxSnapshotFragments) return;  // clients would drop it
+  for (size_t f = 0; f < fragments; f++) {
+    size_t begin = f * kSnapshotChunkBytes;
+    size_t bytes = std::min(payload.size() - begin, kSnapshotChunkBytes);
+    PacketWriter w(PacketType::Snapshot);
+    w.u32(currentTick);
+    w.u32(c.lastSequence);
+    w.u32(baselineTick);
+    w.u8(flags);
+    w.u16((uint16_t)f);
+    w.u16((uint16_t)fragments);
+    w.u16((uint16_t)bytes);
+    w.raw(payload.data() + begin, bytes);
+    socket.send(c.address, w.data(), w.size());
+  }
+}
@@ -0,0 +1,117 @@
+// GameServer.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "EntityManager.h"
+#include "InterestManager.h"
+#include "NetProtocol.h"
+#include "PhysicsSystem.h"
+#include "SnapshotCodec.h"
+#include "UdpSocket.h"
+
+// Authoritative game server: owns the EntityManager and PhysicsSystem, gives
+// every client that connects a ship, steers the ships with the clients'
+// input commands (steerShip, as main.cpp does from the keyboard), and sends
+// every client a snapshot of all live entities every few ticks.
+//
+// Snapshots are SnapshotCodec deltas against the newest snapshot the client
+// has acknowledged, if the server still has it (the last snapshotHistory
+// are kept), else against an empty world; see NetProtocol.h for framing.
+// With interest management on, each client instead gets its own view of
+// the entities around its ship (InterestManager), so a snapshot's size no
+// longer grows with the world or the number of players.
+class GameServer {
+ public:
+  explicit GameServer(float tickRate = 60.0f);
+
+  // Listens on `port` (0 picks a free one; see getPort).
+  bool start(uint16_t port);
+  void stop();
+  uint16_t getPort() const { return socket.getPort(); }
+
+  // One fixed step: reads everything waiting on the socket, applies the new
+  // commands, updates physics, and sends snapshots if one is due. Call at
+  // the tick rate.
+  void tick();
+
+  EntityManager &getEntities() { return entities; }
+  PhysicsSystem &getPhysics() { return physics; }
+  uint32_t getTick() const { return currentTick; }
+  float getTickInterval() const { return tickInterval; }
+  // Ticks between snapshots (default 3, i.e. 20 Hz at 60 Hz).
+  void setSnapshotInterval(uint32_t ticks) { snapshotInterval = ticks < 1 ? 1 : ticks; }
+  uint32_t getSnapshotInterval() const { return snapshotInterval; }
+  // Clients not heard from for this long are dropped and their ships removed.
+  void setTimeout(float seconds) { timeoutTicks = (uint32_t)(seconds / tickInterval); }
+  // Off by default: every client is sent every entity. Switching drops all
+  // baselines, so the next snapshots go out in full.
+  void setInterestManagement(bool enabled);
+  bool getInterestManagement() const { return interestEnabled; }
+  InterestManager &getInterestManager() { return interest; }
+
+  size_t getClientCount() const { return clients.size(); }
+  const UdpSocket &getSocket() const { return socket; }
+  // Wall time the last tick took, network included.
+  double getLastTickMs() const { return lastTickMs; }
+
+ private:
+  struct SentSnapshot {
+    uint32_t tick = 0;
+    std::vector<QuantizedEntity> state;
+  };
+  struct SentView {
+    uint32_t tick = 0;
+    SnapshotView view;
+  };
+  static constexpr size_t snapshotHistory = 32;
+
+  struct Client {
+    NetAddress address;
+    uint16_t id = 0;
+    uint32_t ship = 0;
+    uint32_t lastSequence = 0;   // newest command applied
+    uint8_t buttons = 0;         // held keys from that command
+    bool fire = false;           // a fire press arrived since the last tick
+    uint32_t lastHeard = 0;      // tick
+    uint32_t ackedSnapshot = 0;  // tick of the newest snapshot it decoded
+    // With interest management: its interest set and the views it was sent.
+    InterestManager::Viewer viewer;
+    std::vector<SentView> views;  // ring of snapshotHistory, oldest overwritten
+    size_t viewsNext = 0;
+  };
+
+  void receive();
+  void handleConnect(const NetAddress &from);
+  void handleInput(PacketReader &reader, const NetAddress &from);
+  void handleDisconnect(PacketReader &reader, const NetAddress &from);
+  Client *findClient(const NetAddress &from, uint16_t id);
+  void dropClient(size_t index);
+  uint32_t spawn(const Entity &e);  // reuses a dead slot if it can
+  void steerShips();
+  void sendSnapshots();
+  void sendViews(const std::vector<QuantizedEntity> &state);
+  void sendPayload(const Client &c, uint32_t baselineTick, uint8_t flags,
+                   const std::vector<uint8_t> &payload);
+  const std::vector<QuantizedEntity> *findSent(uint32_t tick) const;
+
+  float tickInterval;
+  uint32_t currentTick = 0;
+  uint32_t snapshotInterval = 3;
+  uint32_t timeoutTicks;
+  uint16_t nextClientId = 1;
+  double lastTickMs = 0.0;
+  bool interestEnabled = false;
+
+  UdpSocket socket;
+  EntityManager entities;
+  PhysicsSystem physics;
+  std::vector<Client> clients;
+  SentSnapshot history[snapshotHistory];  // ring, oldest overwritten
+  size_t historyNext = 0;
+  // Snapshot scratch: one encoding per distinct baseline.
+  std::vector<uint32_t> encodedBaselines;
+  std::vector<std::vector<uint8_t>> encoded;
+  InterestManager interest;
+  std::vector<uint8_t> viewPayload;
+};
@@ -0,0 +1,312 @@
+// GpuPhysics.cpp
+#include "GpuPhysics.h"
+
+#include <iostream>
+
+#include "PhysicsSystem.h"
+
+static_assert(sizeof(GpuPhysics::GpuEntity) == 48, "GpuEntity must match the std430 layout");
+static_assert((int)EntityType::Bullet == 2, "BULLET in the compute shader is out of date");
+
+// Mirrors PhysicsSystem::update operation for operation; `precise` stops the
+// compiler fusing multiply-adds so results track the CPU path closely.
+static const char *integrateComputeSource = R"(
+#version 430 core
+layout (local_size_x = 256) in;
+
+struct GpuEntity {
+    vec2 position;
+    vec2 velocity;
+    float angle;
+    float angularVelocity;
+    float radius;
+    float ttl;
+    uint type;
+    uint padding0, padding1, padding2;
+};
+
+layout (std430, binding = 0) buffer Entities {
+    GpuEntity entities[];
+};
+
+uniform float dt;
+uniform float bound;
+uniform uint count;
+
+const uint BULLET = 2u;
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count) return;
+
+    precise vec2 position = entities[i].position + entities[i].velocity * dt;
+    precise float angle = entities[i].angle + entities[i].angularVelocity * dt;
+
+    if (angle >= 360.0) angle -= 360.0;
+    if (angle < 0.0) angle += 360.0;
+
+    if (position.x > bound) position.x = -bound;
+    if (position.x < -bound) position.x = bound;
+    if (position.y > bound) position.y = -bound;
+    if (position.y < -bound) position.y = bound;
+
+    entities[i].position = position;
+    entities[i].angle = angle;
+
+    // bullet lifetime
+    if (entities[i].type == BULLET) {
+        precise float ttl = entities[i].ttl - dt;
+        entities[i].ttl = ttl;
+        if (ttl <= 0.0) entities[i].radius = -1.0;  // mark as dead
+    }
+}
+)";
+
+// Transform-feedback variant for GL 3.3: one vertex per entity, outputs are
+// captured interleaved in GpuEntity layout (padding written explicitly since
+// gl_SkipComponents needs GL 4.0). GLSL 330 has no `precise`, so drivers may
+// fuse multiply-adds and results can differ from the CPU in the last bits.
+static const char *integrateFeedbackSource = R"(
+#version 330 core
+layout (location = 0) in vec2 inPosition;
+layout (location = 1) in vec2 inVelocity;
+layout (location = 2) in vec4 inState;  // angle, angularVelocity, radius, ttl
+layout (location = 3) in uint inType;
+
+uniform float dt;
+uniform float bound;
+
+out vec2 outPosition;
+out vec2 outVelocity;
+out vec4 outState;
+flat out uint outType;
+flat out uvec3 outPadding;
+
+const uint BULLET = 2u;
+
+void main()
+{
+    vec2 position = inPosition + inVelocity * dt;
+    float angle = inState.x + inState.y * dt;
+    float radius = inState.z;
+    float ttl = inState.w;
+
+    if (angle >= 360.0) angle -= 360.0;
+    if (angle < 0.0) angle += 360.0;
+
+    if (position.x > bound) position.x = -bound;
+    if (position.x < -bound) position.x = bound;
+    if (position.y > bound) position.y = -bound;
+    if (position.y < -bound) position.y = bound;
+
+    // bullet lifetime
+    if (inType == BULLET) {
+        ttl -= dt;
+        if (ttl <= 0.0) radius = -1.0;  // mark as dead
+    }
+
+    outPosition = position;
+    outVelocity = inVelocity;
+    outState = vec4(angle, inState.y, radius, ttl);
+    outType = inType;
+    outPadding = uvec3(0u);
+}
+)";
+
+static GpuPhysics::GpuEntity pack(const Entity &e) {
+  GpuPhysics::GpuEntity g{};
+  g.position[0] = e.position.x;
+  g.position[1] = e.position.y;
+  g.velocity[0] = e.velocity.x;
+  g.velocity[1] = e.velocity.y;
+  g.angle = e.angle;
+  g.angularVelocity = e.angularVelocity;
+  g.radius = e.radius;
+  g.ttl = e.ttl;
+  g.type = (uint32_t)e.type;
+  return g;
+}
+
+GpuPhysics::~GpuPhysics() {
+  glDeleteVertexArrays(2, feedbackVAOs);
+  glDeleteBuffers(2, buffers);
+  glDeleteProgram(program);
+}
+
+bool GpuPhysics::init() {
+  return init(glExtensions.computeShaders ? Backend::ComputeShader : Backend::TransformFeedback);
+}
+
+bool GpuPhysics::init(Backend requested) {
+  backend = requested;
+  if (backend == Backend::ComputeShader && !initCompute()) return false;
+  if (backend == Backend::TransformFeedback && !initTransformFeedback()) return false;
+
+  dtLoc = glGetUniformLocation(program, "dt");
+  boundLoc = glGetUniformLocation(program, "bound");
+  countLoc = glGetUniformLocation(program, "count");
+  return true;
+}
+
+bool GpuPhysics::initCompute() {
+  if (!glExtensions.computeShaders) {
+    std::cerr << "Compute shader physics needs an OpenGL 4.3 context\n";
+    return false;
+  }
+
+  GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+  glShaderSource(shader, 1, &integrateComputeSource, nullptr);
+  glCompileShader(shader);
+  GLint success;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    char infoLog[512];
+    glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+    std::cerr << "Compute shader compilation failed: " << infoLog << "\n";
+    glDeleteShader(shader);
+    return false;
+  }
+
+  program = glCreateProgram();
+  glAttachShader(program, shader);
+  glLinkProgram(program);
+  glDeleteShader(shader);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    char infoLog[512];
+    glGetProgramInfoLog(program, 512, nullptr, infoLog);
+    std::cerr << "Compute program linking failed: " << infoLog << "\n";
+    return false;
+  }
+
+  glGenBuffers(1, &buffers[0]);
+  return true;
+}
+
+bool GpuPhysics::initTransformFeedback() {
+  GLuint shader = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(shader, 1, &integrateFeedbackSource, nullptr);
+  glCompileShader(shader);
+  GLint success;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    char infoLog[512];
+    glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+    std::cerr << "Feedback shader compilation failed: " << infoLog << "\n";
+    glDeleteShader(shader);
+    return false;
+  }
+
+  program = glCreateProgram();
+  glAttachShader(program, shader);
+  const char *varyings[] = {"outPosition", "outVelocity", "outState", "outType", "outPadding"};
+  glTransformFeedbackVaryings(program, 5, varyings, GL_INTERLEAVED_ATTRIBS);
+  glLinkProgram(program);
+  glDeleteShader(shader);
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    char infoLog[512];
+    glGetProgramInfoLog(program, 512, nullptr, infoLog);
+    std::cerr << "Feedback program linking failed: " << infoLog << "\n";
+    return false;
+  }
+
+  glGenBuffers(2, buffers);
+  glGenVertexArrays(2, feedbackVAOs);
+  for (int i = 0; i < 2; i++) {
+    glBindVertexArray(feedbackVAOs[i]);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GpuEntity), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GpuEntity), (void *)8);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GpuEntity), (void *)16);
+    glEnableVertexAttribArray(2);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GpuEntity), (void *)32);
+    glEnableVertexAttribArray(3);
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return true;
+}
+
+void GpuPhysics::upload(const std::vector<Entity> &entities) {
+  staging.resize(entities.size());
+  for (size_t i = 0; i < entities.size(); i++) staging[i] = pack(entities[i]);
+
+  if (entities.size() > capacity) {
+    // Grow every buffer in use; only the current one needs the data.
+    capacity = entities.size();
+    int bufferCount = backend == Backend::TransformFeedback ? 2 : 1;
+    for (int i = 0; i < bufferCount; i++) {
+      glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+      glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(GpuEntity),
+                   i == current ? staging.data() : nullptr, GL_DYNAMIC_COPY);
+    }
+  } else if (!entities.empty()) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, entities.size() * sizeof(GpuEntity), staging.data());
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  entityCount = entities.size();
+}
+
+void GpuPhysics::writeEntity(size_t index, const Entity &e) {
+  GpuEntity g = pack(e);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+  glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(GpuEntity), sizeof(GpuEntity), &g);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GpuPhysics::update(float dt) {
+  if (entityCount == 0) return;
+
+  glUseProgram(program);
+  glUniform1f(dtLoc, dt);
+  glUniform1f(boundLoc, PhysicsSystem::worldBound);
+
+  if (backend == Backend::ComputeShader) {
+    glUniform1ui(countLoc, (GLuint)entityCount);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffers[0]);
+    glDispatchCompute((GLuint)((entityCount + 255) / 256), 1, 1);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+
+    // Results feed the next dispatch, instanced vertex fetch and readbacks.
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+    return;
+  }
+
+  // Ping-pong: read buffers[current], capture into the other one.
+  int next = 1 - current;
+  glEnable(GL_RASTERIZER_DISCARD);
+  glBindVertexArray(feedbackVAOs[current]);
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers[next]);
+  glBeginTransformFeedback(GL_POINTS);
+  glDrawArrays(GL_POINTS, 0, (GLsizei)entityCount);
+  glEndTransformFeedback();
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+  glBindVertexArray(0);
+  glDisable(GL_RASTERIZER_DISCARD);
+  current = next;
+}
+
+void GpuPhysics::download(std::vector<Entity> &entities) {
+  staging.resize(entityCount);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[current]);
+  glGetBufferSubData(GL_ARRAY_BUFFER, 0, entityCount * sizeof(GpuEntity), staging.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  entities.resize(entityCount);
+  for (size_t i = 0; i < entityCount; i++) {
+    const GpuEntity &g = staging[i];
+    Entity &e = entities[i];
+    e.position = {g.position[0], g.position[1]};
+    e.velocity = {g.velocity[0], g.velocity[1]};
+    e.angle = g.angle;
+    e.angularVelocity = g.angularVelocity;
+    e.radius = g.radius;
+    e.ttl = g.ttl;
+    e.type = (EntityType)g.type;
+  }
+}
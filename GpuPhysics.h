@@ -0,0 +1,68 @@
+// GpuPhysics.h
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Entity.h"
+#include "GLExtensions.h"
+
+// GPU path for PhysicsSystem's integration step (position/angle update,
+// toroidal wrap, bullet TTL expiry). Entities live in a GPU buffer;
+// Renderer::renderEntityBuffer draws straight from it, so steady-state frames
+// need no CPU->GPU entity upload.
+//
+// Two backends share the buffer layout:
+//  - ComputeShader (GL 4.3): updates one shader storage buffer in place.
+//  - TransformFeedback (GL 3.3): a vertex shader reads one buffer and streams
+//    results into the other with rasterization off; the buffers swap each step.
+//
+// The buffer is a snapshot: call upload() after structural changes
+// (createEntity, removal) and writeEntity() for individual CPU-driven edits
+// such as ship control.
+class GpuPhysics {
+ public:
+  enum class Backend { ComputeShader, TransformFeedback };
+
+  // std430-compatible layout of one entity in the buffer (48 bytes).
+  struct GpuEntity {
+    float position[2];
+    float velocity[2];
+    float angle;
+    float angularVelocity;
+    float radius;
+    float ttl;
+    uint32_t type;
+    uint32_t padding[3];
+  };
+
+  GpuPhysics() = default;
+  ~GpuPhysics();
+
+  // Picks ComputeShader on GL 4.3 contexts and TransformFeedback otherwise.
+  bool init();
+  bool init(Backend backend);
+  Backend activeBackend() const { return backend; }
+
+  void upload(const std::vector<Entity> &entities);
+  void writeEntity(size_t index, const Entity &e);
+  void update(float dt);
+  void download(std::vector<Entity> &entities);
+
+  // Buffer holding the latest state; changes after update() with TransformFeedback.
+  GLuint buffer() const { return buffers[current]; }
+  size_t count() const { return entityCount; }
+
+ private:
+  bool initCompute();
+  bool initTransformFeedback();
+
+  Backend backend = Backend::ComputeShader;
+  GLuint program = 0;
+  GLuint buffers[2] = {0, 0};
+  GLuint feedbackVAOs[2] = {0, 0};  // feedbackVAOs[i] reads buffers[i]
+  int current = 0;
+  size_t entityCount = 0;
+  size_t capacity = 0;
+  GLint dtLoc = -1, boundLoc = -1, countLoc = -1;
+  std::vector<GpuEntity> staging;
+};
@@ -0,0 +1,265 @@
+// GravityField.cpp
+#include "GravityField.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+
+// Nearest image of a separation, for positions inside the world square.
+inline glm::vec2 nearestImage(glm::vec2 d) {
+  d.x -= d.x > kBound ? kPeriod : 0.0f;
+  d.x += d.x < -kBound ? kPeriod : 0.0f;
+  d.y -= d.y > kBound ? kPeriod : 0.0f;
+  d.y += d.y < -kBound ? kPeriod : 0.0f;
+  return d;
+}
+
+// Spreads the low 16 bits of v to the even bits of the result.
+inline uint32_t spreadBits(uint32_t v) {
+  v = (v | (v << 8)) & 0x00ff00ffu;
+  v = (v | (v << 4)) & 0x0f0f0f0fu;
+  v = (v | (v << 2)) & 0x33333333u;
+  v = (v | (v << 1)) & 0x55555555u;
+  return v;
+}
+
+inline uint32_t quantize(float v) {
+  float t = (v + kBound) / kPeriod * 65536.0f;
+  return (uint32_t)std::clamp(t, 0.0f, 65535.0f);
+}
+
+// x in the even bits, y in the odd.
+inline uint32_t mortonKey(glm::vec2 p) {
+  return spreadBits(quantize(p.x)) | spreadBits(quantize(p.y)) << 1;
+}
+
+inline bool attracts(const Entity &e) { return e.type == EntityType::Asteroid && e.radius >= 0; }
+
+}  // namespace
+
+glm::vec2 GravityField::pull(glm::vec2 d, float mass) const {
+  float r2 = d.x * d.x + d.y * d.y + softening * softening;
+  float inv = 1.0f / std::sqrt(r2);
+  return d * (gravitationalConstant * mass * inv * inv * inv);
+}
+
+glm::vec2 GravityField::wellAcceleration(glm::vec2 p) const {
+  glm::vec2 a(0.0f, 0.0f);
+  for (const Well &w : wells) a += pull(nearestImage(w.position - p), w.mass);
+  return a;
+}
+
+void GravityField::gatherBodies(const std::vector<Entity> &entities) {
+  order.clear();
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    if (attracts(entities[i])) order.push_back((uint64_t)mortonKey(entities[i].position) << 32 | i);
+  }
+  std::sort(order.begin(), order.end());
+
+  bodyPosition.resize(order.size());
+  bodyMass.resize(order.size());
+  bodyEntity.resize(order.size());
+  for (size_t b = 0; b < order.size(); b++) {
+    const Entity &e = entities[(uint32_t)order[b]];
+    bodyEntity[b] = (uint32_t)order[b];
+    bodyPosition[b] = e.position;
+    bodyMass[b] = e.radius * e.radius;
+  }
+}
+
+void GravityField::buildNode(uint32_t index, int depth) {
+  const uint32_t begin = nodes[index].begin, end = nodes[index].end;
+  if (end - begin <= leafSize || depth == maxDepth) {
+    float mass = 0.0f;
+    glm::vec2 weighted(0.0f, 0.0f);
+    for (uint32_t b = begin; b < end; b++) {
+      mass += bodyMass[b];
+      weighted += bodyPosition[b] * bodyMass[b];
+    }
+    nodes[index].mass = mass;
+    nodes[index].massCentre = mass > 0.0f ? weighted / mass : nodes[index].centre;
+    return;
+  }
+
+  // Bodies are sorted by key, so each quadrant is a contiguous run.
+  const int shift = 32 + 2 * (maxDepth - 1 - depth);
+  const glm::vec2 centre = nodes[index].centre;
+  const float half = nodes[index].halfSize * 0.5f;
+  const uint32_t firstChild = (uint32_t)nodes.size();
+  uint32_t start = begin;
+  for (uint32_t q = 0; q < 4 && start < end; q++) {
+    uint32_t stop = (uint32_t)(std::partition_point(order.begin() + start, order.begin() + end,
+                                                    [&](uint64_t key) {
+                                                      return ((key >> shift) & 3) <= q;
+                                                    }) -
+                               order.begin());
+    if (stop == start) continue;
+    Node child{};
+    child.centre = centre + glm::vec2(q & 1 ? half : -half, q & 2 ? half : -half);
+    child.halfSize = half;
+    child.begin = start;
+    child.end = stop;
+    nodes.push_back(child);
+    start = stop;
+  }
+  const uint32_t childCount = (uint32_t)nodes.size() - firstChild;
+  nodes[index].firstChild = firstChild;
+  nodes[index].childCount = childCount;
+
+  float mass = 0.0f;
+  glm::vec2 weighted(0.0f, 0.0f);
+  for (uint32_t c = firstChild; c < firstChild + childCount; c++) {
+    buildNode(c, depth + 1);
+    mass += nodes[c].mass;
+    weighted += nodes[c].massCentre * nodes[c].mass;
+  }
+  nodes[index].mass = mass;
+  nodes[index].massCentre = mass > 0.0f ? weighted / mass : centre;
+}
+
+void GravityField::applyLeaf(uint32_t leaf, Interactions &list,
+                             std::vector<glm::vec2> &accelerations) const {
+  const Node &group = nodes[leaf];
+  glm::vec2 lo = bodyPosition[group.begin], hi = lo;
+  for (uint32_t b = group.begin + 1; b < group.end; b++) {
+    lo = glm::min(lo, bodyPosition[b]);
+    hi = glm::max(hi, bodyPosition[b]);
+  }
+  const glm::vec2 centre = (lo + hi) * 0.5f, extent = (hi - lo) * 0.5f;
+
+  // One walk for the whole leaf collects point masses: nodes far enough from
+  // every body in the leaf, and lying within half a world of all of them so
+  // each body sees the node's bodies through one image, and otherwise single
+  // bodies from opened leaves.
+  const float theta2 = theta * theta;
+  list.x.clear();
+  list.y.clear();
+  list.mass.clear();
+  auto add = [&](glm::vec2 p, float mass) {
+    list.x.push_back(p.x);
+    list.y.push_back(p.y);
+    list.mass.push_back(mass);
+  };
+  uint32_t stack[4 * maxDepth + 4];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node &node = nodes[stack[--top]];
+    glm::vec2 box = nearestImage(node.centre - centre);
+    glm::vec2 reach = extent + glm::vec2(node.halfSize, node.halfSize);
+    bool overlap = std::fabs(box.x) <= reach.x && std::fabs(box.y) <= reach.y;
+    bool oneImage = std::fabs(box.x) + reach.x < kBound && std::fabs(box.y) + reach.y < kBound;
+    if (!overlap && oneImage) {
+      glm::vec2 d = nearestImage(node.massCentre - centre);
+      glm::vec2 gap(std::max(std::fabs(d.x) - extent.x, 0.0f),
+                    std::max(std::fabs(d.y) - extent.y, 0.0f));
+      float width = 2.0f * node.halfSize;
+      if (width * width < theta2 * (gap.x * gap.x + gap.y * gap.y)) {
+        add(node.massCentre, node.mass);
+        continue;
+      }
+    }
+    if (node.childCount == 0) {
+      for (uint32_t b = node.begin; b < node.end; b++) add(bodyPosition[b], bodyMass[b]);
+    } else {
+      for (uint32_t c = 0; c < node.childCount; c++) stack[top++] = node.firstChild + c;
+    }
+  }
+
+  // A body's own entry pulls with zero separation, which softening makes
+  // exactly zero, so it needn't be skipped. Padding to whole blocks with
+  // massless entries and summing each block lane by lane lets the compiler
+  // vectorize the loop without reassociating the float sums itself.
+  constexpr size_t lanes = 8;
+  while (list.mass.size() % lanes) add(glm::vec2(0.0f, 0.0f), 0.0f);
+  const size_t count = list.mass.size();
+  const float *xs = list.x.data(), *ys = list.y.data(), *ms = list.mass.data();
+  const float eps2 = softening * softening;
+  for (uint32_t self = group.begin; self < group.end; self++) {
+    const glm::vec2 p = bodyPosition[self];
+    float sumX[lanes] = {}, sumY[lanes] = {};
+    for (size_t i = 0; i < count; i += lanes) {
+      for (size_t l = 0; l < lanes; l++) {
+        float dx = xs[i + l] - p.x, dy = ys[i + l] - p.y;
+        dx -= dx > kBound ? kPeriod : 0.0f;
+        dx += dx < -kBound ? kPeriod : 0.0f;
+        dy -= dy > kBound ? kPeriod : 0.0f;
+        dy += dy < -kBound ? kPeriod : 0.0f;
+        float inv = 1.0f / std::sqrt(dx * dx + dy * dy + eps2);
+        float s = ms[i + l] * inv * inv * inv;
+        sumX[l] += dx * s;
+        sumY[l] += dy * s;
+      }
+    }
+    float ax = 0.0f, ay = 0.0f;
+    for (size_t l = 0; l < lanes; l++) {
+      ax += sumX[l];
+      ay += sumY[l];
+    }
+    accelerations[bodyEntity[self]] =
+        glm::vec2(ax, ay) * gravitationalConstant + wellAcceleration(p);
+  }
+}
+
+void GravityField::computeAccelerations(const std::vector<Entity> &entities, JobSystem *jobs,
+                                        std::vector<glm::vec2> &accelerations) {
+  accelerations.assign(entities.size(), glm::vec2(0.0f, 0.0f));
+  gatherBodies(entities);
+  nodes.clear();
+  leaves.clear();
+  if (order.empty()) return;
+
+  Node root{};
+  root.centre = glm::vec2(0.0f, 0.0f);
+  root.halfSize = kBound;
+  root.begin = 0;
+  root.end = (uint32_t)order.size();
+  nodes.push_back(root);
+  buildNode(0, 0);
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    if (nodes[i].childCount == 0) leaves.push_back(i);
+  }
+
+  auto walk = [&](size_t begin, size_t end) {
+    Interactions list;
+    for (size_t k = begin; k < end; k++) applyLeaf(leaves[k], list, accelerations);
+  };
+  if (jobs) {
+    jobs->parallelFor(leaves.size(), 16, walk);
+  } else {
+    walk(0, leaves.size());
+  }
+}
+
+void GravityField::computeExact(const std::vector<Entity> &entities, JobSystem *jobs,
+                                std::vector<glm::vec2> &accelerations) const {
+  accelerations.assign(entities.size(), glm::vec2(0.0f, 0.0f));
+  std::vector<uint32_t> bodies;
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    if (attracts(entities[i])) bodies.push_back(i);
+  }
+
+  auto sum = [&](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      glm::vec2 p = entities[bodies[k]].position;
+      glm::vec2 a = wellAcceleration(p);
+      for (uint32_t j : bodies) {
+        if (j == bodies[k]) continue;
+        const Entity &e = entities[j];
+        a += pull(nearestImage(e.position - p), e.radius * e.radius);
+      }
+      accelerations[bodies[k]] = a;
+    }
+  };
+  if (jobs) {
+    jobs->parallelFor(bodies.size(), 16, sum);
+  } else {
+    sum(0, bodies.size());
+  }
+}
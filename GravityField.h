@@ -0,0 +1,89 @@
+// GravityField.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Entity.h"
+#include "JobSystem.h"
+
+// Mutual gravity between asteroids, plus fixed gravity wells, approximated
+// with Barnes-Hut. Each call builds a quadtree over the world square (bodies
+// sorted along a Morton curve, so every node owns a contiguous run of them)
+// with each node's total mass and centre of mass. The bodies of each leaf then
+// walk the tree together, taking a distant node as a single point mass when
+// width / distance < theta and opening it otherwise; small theta is more
+// accurate and slower. Leaves are spread over the job system.
+//
+// Distances follow the minimum-image convention on the torus: a body feels
+// the nearest copy of every other body. A node is only taken whole if all of
+// its bodies are nearest through the same copy, otherwise it is opened.
+//
+// Asteroid mass is radius squared (pixels), as in ContactSolver.
+class GravityField {
+ public:
+  struct Well {
+    glm::vec2 position;
+    float mass;
+  };
+
+  // accelerations[i] for every entity, zero for anything but live asteroids.
+  // The tree walk runs on jobs when given.
+  void computeAccelerations(const std::vector<Entity> &entities, JobSystem *jobs,
+                            std::vector<glm::vec2> &accelerations);
+  // The same field summed pair by pair, O(n^2); for measuring the error.
+  void computeExact(const std::vector<Entity> &entities, JobSystem *jobs,
+                    std::vector<glm::vec2> &accelerations) const;
+
+  void setTheta(float t) { theta = t; }
+  float getTheta() const { return theta; }
+  void setGravitationalConstant(float g) { gravitationalConstant = g; }
+  float getGravitationalConstant() const { return gravitationalConstant; }
+  // Plummer softening length, world units; keeps close passes finite.
+  void setSoftening(float s) { softening = s; }
+  float getSoftening() const { return softening; }
+
+  void addWell(glm::vec2 position, float mass) { wells.push_back({position, mass}); }
+  void clearWells() { wells.clear(); }
+  const std::vector<Well> &getWells() const { return wells; }
+
+  size_t getNodeCount() const { return nodes.size(); }
+
+ private:
+  struct Node {
+    glm::vec2 centre;  // of the node's square
+    float halfSize;
+    glm::vec2 massCentre;
+    float mass;
+    uint32_t begin, end;  // bodies, in sorted order
+    uint32_t firstChild;  // children are contiguous
+    uint32_t childCount;  // 0 for a leaf
+  };
+
+  static constexpr uint32_t leafSize = 8;
+  static constexpr int maxDepth = 16;  // Morton key bits per axis
+
+  void gatherBodies(const std::vector<Entity> &entities);
+  void buildNode(uint32_t index, int depth);
+  // Point masses a leaf's bodies are pulled by, as SoA.
+  struct Interactions {
+    std::vector<float> x, y, mass;
+  };
+
+  // Accelerations of every body in a leaf, from one shared tree walk.
+  void applyLeaf(uint32_t leaf, Interactions &list, std::vector<glm::vec2> &accelerations) const;
+  glm::vec2 wellAcceleration(glm::vec2 p) const;
+  glm::vec2 pull(glm::vec2 d, float mass) const;
+
+  float theta = 0.5f;
+  float gravitationalConstant = 1e-5f;
+  float softening = 4.0f / 400.0f;
+  std::vector<Well> wells;
+
+  std::vector<Node> nodes;
+  std::vector<uint32_t> leaves;
+  std::vector<uint64_t> order;  // Morton key << 32 | entity
+  std::vector<glm::vec2> bodyPosition;
+  std::vector<float> bodyMass;
+  std::vector<uint32_t> bodyEntity;
+};
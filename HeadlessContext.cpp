@@ -0,0 +1,80 @@
+// HeadlessContext.cpp
+#include "HeadlessContext.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "GLExtensions.h"
+
+HeadlessContext::~HeadlessContext() {
+  if (display) {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(display, context);
+    eglTerminate(display);
+  }
+}
+
+bool HeadlessContext::init(int majorVersion, int minorVersion) {
+  auto getPlatformDisplay =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  EGLDisplay dpy = EGL_NO_DISPLAY;
+  if (getPlatformDisplay) {
+    dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  }
+  if (dpy == EGL_NO_DISPLAY) dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (dpy == EGL_NO_DISPLAY) {
+    std::cerr << "EGL: no display available\n";
+    return false;
+  }
+
+  EGLint major, minor;
+  if (!eglInitialize(dpy, &major, &minor)) {
+    std::cerr << "eglInitialize error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+    return false;
+  }
+  display = dpy;
+
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    std::cerr << "EGL: desktop OpenGL not supported\n";
+    return false;
+  }
+
+  const EGLint configAttribs[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                  EGL_OPENGL_BIT, EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint numConfigs = 0;
+  eglChooseConfig(dpy, configAttribs, &config, 1, &numConfigs);
+  if (numConfigs == 0) config = nullptr;  // EGL_KHR_no_config_context
+
+  const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                   majorVersion,
+                                   EGL_CONTEXT_MINOR_VERSION,
+                                   minorVersion,
+                                   EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                   EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                   EGL_NONE};
+  context = eglCreateContext(dpy, config, EGL_NO_CONTEXT, contextAttribs);
+  if (!context) {
+    std::cerr << "eglCreateContext error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+    return false;
+  }
+
+  // Surfaceless: all rendering goes to FBOs (EGL_KHR_surfaceless_context).
+  if (!eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    std::cerr << "eglMakeCurrent error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+    return false;
+  }
+
+  if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+    std::cerr << "Failed to initialize GLAD\n";
+    return false;
+  }
+  loadGLExtensions((GLADloadproc)eglGetProcAddress);
+
+  std::cout << "Headless GL: " << glGetString(GL_RENDERER) << " / " << glGetString(GL_VERSION)
+            << std::endl;
+  return true;
+}
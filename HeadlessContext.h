@@ -0,0 +1,22 @@
+// HeadlessContext.h
+#pragma once
+
+// Creates an OpenGL context without a window using EGL's surfaceless platform
+// (Mesa llvmpipe works fine), so the renderer can run on GPU-less CI machines.
+// Rendering must go to an FBO; see Renderer::initOffscreen.
+class HeadlessContext {
+ public:
+  HeadlessContext() = default;
+  ~HeadlessContext();
+
+  HeadlessContext(const HeadlessContext &) = delete;
+  HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+  // Requests a core profile context of the given version, makes it current and
+  // loads GL entry points through GLAD.
+  bool init(int majorVersion = 3, int minorVersion = 3);
+
+ private:
+  void *display = nullptr;  // EGLDisplay
+  void *context = nullptr;  // EGLContext
+};
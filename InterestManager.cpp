@@ -0,0 +1,189 @@
+// InterestManager.cpp
+#include "InterestManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Broadphase.h"  // wrappedDistance
+#include "PhysicsSystem.h"
+
+namespace {
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+constexpr int kMaxCells = 64;  // per axis
+
+inline float distanceTo(glm::vec2 centre, const Entity &e) {
+  float dx = wrappedDistance(centre.x, e.position.x, kPeriod);
+  float dy = wrappedDistance(centre.y, e.position.y, kPeriod);
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+}  // namespace
+
+void InterestManager::setRadius(float enter, float exit) {
+  enterRadius = enter;
+  exitRadius = std::max(enter, exit);
+}
+
+void InterestManager::prepare(const std::vector<Entity> &entities) {
+  cells = std::clamp((int)(kPeriod / (0.5f * exitRadius)), 1, kMaxCells);
+  cellSize = kPeriod / cells;
+  auto cellIndex = [&](float v) {
+    return std::clamp((int)std::floor((v + kBound) / cellSize), 0, cells - 1);
+  };
+
+  // Counting sort by cell, which keeps each cell's slots ascending.
+  cellStart.assign((size_t)cells * cells + 1, 0);
+  cellOf.resize(entities.size());
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    const Entity &e = entities[i];
+    if (e.radius < 0) {
+      cellOf[i] = UINT32_MAX;
+      continue;
+    }
+    cellOf[i] = (uint32_t)(cellIndex(e.position.y) * cells + cellIndex(e.position.x));
+    cellStart[cellOf[i] + 1]++;
+  }
+  for (size_t c = 1; c < cellStart.size(); c++) cellStart[c] += cellStart[c - 1];
+  cellSlots.resize(cellStart.back());
+  cellPoints.resize(cellStart.back());
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    if (cellOf[i] == UINT32_MAX) continue;
+    const Entity &e = entities[i];
+    uint32_t k = cellStart[cellOf[i]]++;
+    cellSlots[k] = i;
+    cellPoints[k] = {e.position.x, e.position.y, e.radius * PhysicsSystem::radiusToWorld};
+  }
+  for (size_t c = cellStart.size() - 1; c > 0; c--) cellStart[c] = cellStart[c - 1];
+  cellStart[0] = 0;
+
+  if (inRange.size() < entities.size()) {
+    inRange.resize(entities.size(), 0);
+    member.resize(entities.size(), 0);
+  }
+}
+
+void InterestManager::update(Viewer &viewer, glm::vec2 centre, uint32_t focus,
+                             const std::vector<Entity> &entities,
+                             const std::vector<QuantizedEntity> &quantized, uint32_t tick,
+                             float tickInterval, SnapshotView &view) {
+  const size_t slots = std::min({entities.size(), quantized.size(), inRange.size()});
+  if (++stamp == 0) {
+    std::fill(inRange.begin(), inRange.end(), 0);
+    std::fill(member.begin(), member.end(), 0);
+    stamp = 1;
+  }
+  std::vector<Tracked> &tracked = viewer.tracked;
+  for (const Tracked &t : tracked) {
+    if (t.slot < slots) member[t.slot] = stamp;
+  }
+
+  // Mark everything within the exit radius; what's within the enter radius
+  // and not yet a member is new.
+  newcomers.clear();
+  const int span = (int)std::floor(exitRadius / cellSize) + 1;
+  const int cx = (int)std::floor((centre.x + kBound) / cellSize);
+  const int cy = (int)std::floor((centre.y + kBound) / cellSize);
+  const int columns = std::min(2 * span + 1, cells);
+  for (int dy = 0; dy < columns; dy++) {
+    int y = ((cy - span + dy) % cells + cells) % cells;
+    for (int dx = 0; dx < columns; dx++) {
+      int x = ((cx - span + dx) % cells + cells) % cells;
+      size_t cell = (size_t)y * cells + x;
+      for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+        const Point &p = cellPoints[k];
+        float ex = wrappedDistance(centre.x, p.x, kPeriod);
+        float ey = wrappedDistance(centre.y, p.y, kPeriod);
+        float distanceSquared = ex * ex + ey * ey;
+        float exit = exitRadius + p.size, enter = enterRadius + p.size;
+        if (distanceSquared > exit * exit) continue;
+        uint32_t slot = cellSlots[k];
+        if (slot >= slots) continue;
+        inRange[slot] = stamp;
+        if (member[slot] != stamp && distanceSquared <= enter * enter) newcomers.push_back(slot);
+      }
+    }
+  }
+  if (focus < slots && quantized[focus].alive && inRange[focus] != stamp) {
+    inRange[focus] = stamp;
+    if (member[focus] != stamp) newcomers.push_back(focus);
+  }
+  std::sort(newcomers.begin(), newcomers.end());
+
+  // Members still in range, merged with the newcomers.
+  merged.clear();
+  size_t n = 0;
+  for (const Tracked &t : tracked) {
+    if (t.slot >= slots || inRange[t.slot] != stamp || !quantized[t.slot].alive) continue;
+    while (n < newcomers.size() && newcomers[n] < t.slot) {
+      merged.emplace_back();
+      merged.back().slot = newcomers[n++];
+    }
+    merged.push_back(t);
+    // A reused slot is a new entity to the client.
+    if (t.sent.type != quantized[t.slot].type) merged.back().known = false;
+  }
+  for (; n < newcomers.size(); n++) {
+    merged.emplace_back();
+    merged.back().slot = newcomers[n];
+  }
+  tracked.swap(merged);
+
+  // Accumulate; whatever still matches its prediction is up to date already.
+  order.clear();
+  predicted.resize(tracked.size());
+  for (uint32_t i = 0; i < tracked.size(); i++) {
+    Tracked &t = tracked[i];
+    const QuantizedEntity &q = quantized[t.slot];
+    if (t.known) {
+      predicted[i] = SnapshotCodec::extrapolate(t.sent, (tick - t.sentTick) * tickInterval);
+      if (predicted[i] == q && t.slot != focus) {
+        t.sent = q;
+        t.sentTick = tick;
+        t.priority = 0.0f;
+        continue;
+      }
+    }
+    const Entity &e = entities[t.slot];
+    float speed = std::sqrt(e.velocity.x * e.velocity.x + e.velocity.y * e.velocity.y);
+    t.priority += (1.0f + speed * speedWeight) / (1.0f + distanceTo(centre, e) / falloff);
+    order.push_back(i);
+  }
+
+  // The focus, then newcomers, then the highest accumulated.
+  auto rank = [&](uint32_t i) {
+    const Tracked &t = tracked[i];
+    return t.slot == focus ? 2 : t.known ? 0 : 1;
+  };
+  auto before = [&](uint32_t a, uint32_t b) {
+    int ra = rank(a), rb = rank(b);
+    return ra != rb ? ra > rb : tracked[a].priority > tracked[b].priority;
+  };
+  size_t limit = order.size();
+  if (budget > 0) {
+    bool hasFocus = focus < slots && quantized[focus].alive;
+    limit = std::min(limit, budget + (hasFocus ? 1 : 0));
+  }
+  if (limit < order.size()) {
+    std::nth_element(order.begin(), order.begin() + limit, order.end(), before);
+  }
+  for (size_t k = 0; k < limit; k++) {
+    Tracked &t = tracked[order[k]];
+    t.sent = quantized[t.slot];
+    t.sentTick = tick;
+    t.known = true;
+    t.priority = 0.0f;
+  }
+  viewer.refreshed = limit;
+
+  view.slotCount = (uint32_t)quantized.size();
+  view.slots.clear();
+  view.states.clear();
+  for (size_t i = 0; i < tracked.size(); i++) {
+    const Tracked &t = tracked[i];
+    if (!t.known) continue;
+    view.slots.push_back(t.slot);
+    view.states.push_back(t.sentTick == tick ? t.sent : predicted[i]);
+  }
+}
@@ -0,0 +1,94 @@
+// InterestManager.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Entity.h"
+#include "SnapshotCodec.h"
+
+// Decides what each client is told about, so a snapshot costs per entity
+// near the client rather than per entity in the world.
+//
+// Membership has hysteresis: an entity joins a client's interest set once
+// it's within enterRadius of the client's focus (its ship) and leaves only
+// once it's beyond exitRadius, so nothing flickers in and out at the edge.
+// Candidates come from a uniform grid with cells half the exit radius
+// across, binned once per snapshot and shared by every client. (The
+// physics broadphase's cells are sized for collisions, so a query the size
+// of an interest radius visits hundreds of them.)
+//
+// Within the set, each entity has a priority accumulator that grows every
+// snapshot by its weight: more for nearer and faster entities. The budget
+// highest are refreshed and reset to zero; the rest are sent as the client
+// predicts them (SnapshotCodec::extrapolate from what it was last sent), so
+// they coast smoothly and cost almost nothing until their turn comes. The
+// focus is refreshed every time, entities new to the set go first, and
+// ones that haven't strayed from their prediction are refreshed for free.
+class InterestManager {
+ public:
+  struct Tracked {
+    uint32_t slot = 0;
+    float priority = 0.0f;
+    bool known = false;     // sent at least once
+    uint32_t sentTick = 0;  // when `sent` was taken
+    QuantizedEntity sent;
+  };
+
+  // One per client, kept by the caller.
+  struct Viewer {
+    std::vector<Tracked> tracked;  // the interest set, slots ascending
+    size_t refreshed = 0;          // by the last update, the focus included
+  };
+
+  // Bins the world's live entities; call once per snapshot, before update.
+  void prepare(const std::vector<Entity> &entities);
+  // Updates `viewer`'s set around `centre` and builds the view to send at
+  // `tick`. `entities` must be what prepare was given, and `quantized` the
+  // same as SnapshotCodec::quantize has it. `focus` is always in the view
+  // while it's alive.
+  void update(Viewer &viewer, glm::vec2 centre, uint32_t focus,
+              const std::vector<Entity> &entities, const std::vector<QuantizedEntity> &quantized,
+              uint32_t tick, float tickInterval, SnapshotView &view);
+
+  // World units; exit is kept at least as large as enter.
+  void setRadius(float enter, float exit);
+  float getEnterRadius() const { return enterRadius; }
+  float getExitRadius() const { return exitRadius; }
+  // Entities refreshed per snapshot, beyond the focus; 0 for no limit.
+  void setBudget(size_t entities) { budget = entities; }
+  size_t getBudget() const { return budget; }
+  // Weight = (1 + speed * speedWeight) / (1 + distance / falloff), speed in
+  // world units per second and distance in world units.
+  void setWeights(float falloffDistance, float speedFactor) {
+    falloff = falloffDistance;
+    speedWeight = speedFactor;
+  }
+
+ private:
+  float enterRadius = 0.6f;
+  float exitRadius = 0.75f;
+  size_t budget = 96;
+  float falloff = 0.25f;
+  float speedWeight = 2.0f;
+
+  // The grid: cells x cells over the wrap period, cell c's slots at
+  // cellSlots[cellStart[c]] .. cellSlots[cellStart[c + 1]], ascending, and
+  // their positions and sizes alongside so a scan reads memory in order.
+  struct Point {
+    float x, y, size;
+  };
+  int cells = 1;
+  float cellSize = 1.0f;
+  std::vector<uint32_t> cellStart, cellSlots, cellOf;
+  std::vector<Point> cellPoints;
+
+  // Scratch, reused across viewers. inRange and member hold the stamp of
+  // the update that last marked a slot, so they never need clearing.
+  uint32_t stamp = 0;
+  std::vector<uint32_t> inRange, member;
+  std::vector<uint32_t> newcomers;
+  std::vector<Tracked> merged;
+  std::vector<uint32_t> order;
+  std::vector<QuantizedEntity> predicted;  // by tracked index
+};
@@ -0,0 +1,107 @@
+// JobSystem.cpp
+#include "JobSystem.h"
+
+#include <algorithm>
+
+unsigned JobSystem::defaultWorkerCount() {
+  unsigned hardware = std::thread::hardware_concurrency();
+  return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+  workers.reserve(workerCount);
+  for (unsigned i = 0; i < workerCount; i++) {
+    workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &t : workers) t.join();
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain,
+                            const std::function<void(size_t, size_t)> &fn) {
+  grain = std::max<size_t>(grain, 1);
+  if (count == 0) return;
+  if (workers.empty() || count <= grain) {
+    fn(0, count);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &fn;
+    jobCount = count;
+    jobGrain = grain;
+    nextBegin.store(0, std::memory_order_relaxed);
+  }
+  dispatch();
+}
+
+void JobSystem::forEachThread(const std::function<void(unsigned)> &fn) {
+  if (workers.empty()) {
+    fn(0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    threadJob = &fn;
+  }
+  dispatch();
+}
+
+// Wakes the workers on the loop just set up, takes part, and waits for them.
+void JobSystem::dispatch() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    busy = (unsigned)workers.size();
+    generation++;
+  }
+  wake.notify_all();
+  if (threadJob) {
+    (*threadJob)(0);
+  } else {
+    runChunks();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&] { return busy == 0; });
+  job = nullptr;
+  threadJob = nullptr;
+}
+
+void JobSystem::runChunks() {
+  for (;;) {
+    size_t begin = nextBegin.fetch_add(jobGrain, std::memory_order_relaxed);
+    if (begin >= jobCount) return;
+    (*job)(begin, std::min(begin + jobGrain, jobCount));
+  }
+}
+
+void JobSystem::workerLoop(unsigned index) {
+  uint64_t seen = 0;
+  for (;;) {
+    const std::function<void(unsigned)> *perThread;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping) return;
+      seen = generation;
+      perThread = threadJob;
+    }
+    if (perThread) {
+      (*perThread)(index);
+    } else {
+      runChunks();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--busy == 0) finished.notify_one();
+    }
+  }
+}
@@ -0,0 +1,56 @@
+// JobSystem.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads for data-parallel loops. parallelFor splits a
+// range into chunks that the workers and the calling thread pull from a shared
+// counter, and returns once every chunk has run. One loop runs at a time and
+// loops don't nest; start them from the thread that owns the pool.
+class JobSystem {
+ public:
+  // With no workers every loop runs inline on the calling thread.
+  explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+  ~JobSystem();
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  // Threads taking part in each loop, the caller included.
+  unsigned getThreadCount() const { return (unsigned)workers.size() + 1; }
+  // One worker per hardware thread besides the caller's.
+  static unsigned defaultWorkerCount();
+
+  // Calls fn(begin, end) for chunks of `grain` items covering [0, count).
+  // Chunks run concurrently in no particular order.
+  void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+  // Calls fn(thread) once on every thread: 0 on the caller, 1.. on the
+  // workers, always the same worker for the same index. For work that should
+  // stay on one core from call to call.
+  void forEachThread(const std::function<void(unsigned)> &fn);
+
+ private:
+  void dispatch();
+  void workerLoop(unsigned index);
+  void runChunks();
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+  uint64_t generation = 0;  // guarded by mutex; bumped for every loop
+  unsigned busy = 0;        // guarded by mutex; workers yet to finish the loop
+  bool stopping = false;    // guarded by mutex
+
+  // The loop in progress; written under the mutex before workers are woken.
+  const std::function<void(size_t, size_t)> *job = nullptr;
+  const std::function<void(unsigned)> *threadJob = nullptr;
+  size_t jobCount = 0;
+  size_t jobGrain = 1;
+  std::atomic<size_t> nextBegin{0};
+};
@@ -0,0 +1,231 @@
+// Narrowphase.cpp
+#include "Narrowphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define WHISKERS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define WHISKERS_TARGET_AVX2
+#else
+// Only the AVX2 kernel is built for AVX2; the rest of the file stays baseline
+// x86-64 and the kernel is picked at runtime.
+#define WHISKERS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// Kernels test `count` lanes (a multiple of 8) of the batch and write a
+// contact per hit lane to `out`, returning how many hit. All paths compute,
+// per lane:
+//   d = b - a, wrapped to the minimum image by at most one period
+//   hit = |d|^2 < reach^2
+//   dist = sqrt(|d|^2); n = dist > 0 ? d / dist : (1, 0); depth = reach - dist
+struct BatchIn {
+  const float *ax, *ay, *bx, *by, *reach;
+  const BroadphasePair *pairs;
+};
+
+size_t kernelScalar(const BatchIn &in, size_t count, Contact *out) {
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  const float half = PhysicsSystem::worldBound;
+  size_t hits = 0;
+  for (size_t i = 0; i < count; i++) {
+    float dx = in.bx[i] - in.ax[i];
+    float dy = in.by[i] - in.ay[i];
+    dx -= dx > half ? period : 0.0f;
+    dx += dx < -half ? period : 0.0f;
+    dy -= dy > half ? period : 0.0f;
+    dy += dy < -half ? period : 0.0f;
+    float d2 = dx * dx + dy * dy;
+    float r = in.reach[i];
+    if (!(d2 < r * r)) continue;
+
+    float dist = std::sqrt(d2);
+    glm::vec2 normal(dist > 0.0f ? dx / dist : 1.0f, dist > 0.0f ? dy / dist : 0.0f);
+    out[hits++] = {in.pairs[i].a, in.pairs[i].b, normal, r - dist};
+  }
+  return hits;
+}
+
+#ifdef WHISKERS_X86
+
+inline int lowestBit(unsigned mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (int)index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+size_t kernelSSE2(const BatchIn &in, size_t count, Contact *out) {
+  const __m128 period = _mm_set1_ps(2.0f * PhysicsSystem::worldBound);
+  const __m128 half = _mm_set1_ps(PhysicsSystem::worldBound);
+  const __m128 negHalf = _mm_set1_ps(-PhysicsSystem::worldBound);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  size_t hits = 0;
+  for (size_t i = 0; i < count; i += 4) {
+    __m128 dx = _mm_sub_ps(_mm_load_ps(in.bx + i), _mm_load_ps(in.ax + i));
+    __m128 dy = _mm_sub_ps(_mm_load_ps(in.by + i), _mm_load_ps(in.ay + i));
+    dx = _mm_sub_ps(dx, _mm_and_ps(_mm_cmpgt_ps(dx, half), period));
+    dx = _mm_add_ps(dx, _mm_and_ps(_mm_cmplt_ps(dx, negHalf), period));
+    dy = _mm_sub_ps(dy, _mm_and_ps(_mm_cmpgt_ps(dy, half), period));
+    dy = _mm_add_ps(dy, _mm_and_ps(_mm_cmplt_ps(dy, negHalf), period));
+    __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    __m128 r = _mm_load_ps(in.reach + i);
+    int mask = _mm_movemask_ps(_mm_cmplt_ps(d2, _mm_mul_ps(r, r)));
+    if (!mask) continue;
+
+    __m128 dist = _mm_sqrt_ps(d2);
+    __m128 positive = _mm_cmpgt_ps(dist, zero);
+    // Lanes with dist == 0 divide by zero here and are replaced below.
+    __m128 nx = _mm_div_ps(dx, dist);
+    __m128 ny = _mm_div_ps(dy, dist);
+    nx = _mm_or_ps(_mm_and_ps(positive, nx), _mm_andnot_ps(positive, one));
+    ny = _mm_and_ps(positive, ny);
+    __m128 depth = _mm_sub_ps(r, dist);
+
+    alignas(16) float lx[4], ly[4], ld[4];
+    _mm_store_ps(lx, nx);
+    _mm_store_ps(ly, ny);
+    _mm_store_ps(ld, depth);
+    while (mask) {
+      int lane = lowestBit((unsigned)mask);
+      mask &= mask - 1;
+      const BroadphasePair &p = in.pairs[i + lane];
+      out[hits++] = {p.a, p.b, glm::vec2(lx[lane], ly[lane]), ld[lane]};
+    }
+  }
+  return hits;
+}
+
+WHISKERS_TARGET_AVX2
+size_t kernelAVX2(const BatchIn &in, size_t count, Contact *out) {
+  const __m256 period = _mm256_set1_ps(2.0f * PhysicsSystem::worldBound);
+  const __m256 half = _mm256_set1_ps(PhysicsSystem::worldBound);
+  const __m256 negHalf = _mm256_set1_ps(-PhysicsSystem::worldBound);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  size_t hits = 0;
+  for (size_t i = 0; i < count; i += 8) {
+    __m256 dx = _mm256_sub_ps(_mm256_load_ps(in.bx + i), _mm256_load_ps(in.ax + i));
+    __m256 dy = _mm256_sub_ps(_mm256_load_ps(in.by + i), _mm256_load_ps(in.ay + i));
+    dx = _mm256_sub_ps(dx, _mm256_and_ps(_mm256_cmp_ps(dx, half, _CMP_GT_OQ), period));
+    dx = _mm256_add_ps(dx, _mm256_and_ps(_mm256_cmp_ps(dx, negHalf, _CMP_LT_OQ), period));
+    dy = _mm256_sub_ps(dy, _mm256_and_ps(_mm256_cmp_ps(dy, half, _CMP_GT_OQ), period));
+    dy = _mm256_add_ps(dy, _mm256_and_ps(_mm256_cmp_ps(dy, negHalf, _CMP_LT_OQ), period));
+    // Separate multiply and add (no FMA) to round exactly like the other paths.
+    __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    __m256 r = _mm256_load_ps(in.reach + i);
+    int mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(r, r), _CMP_LT_OQ));
+    if (!mask) continue;
+
+    __m256 dist = _mm256_sqrt_ps(d2);
+    __m256 positive = _mm256_cmp_ps(dist, zero, _CMP_GT_OQ);
+    __m256 nx = _mm256_blendv_ps(one, _mm256_div_ps(dx, dist), positive);
+    __m256 ny = _mm256_and_ps(positive, _mm256_div_ps(dy, dist));
+    __m256 depth = _mm256_sub_ps(r, dist);
+
+    alignas(32) float lx[8], ly[8], ld[8];
+    _mm256_store_ps(lx, nx);
+    _mm256_store_ps(ly, ny);
+    _mm256_store_ps(ld, depth);
+    while (mask) {
+      int lane = lowestBit((unsigned)mask);
+      mask &= mask - 1;
+      const BroadphasePair &p = in.pairs[i + lane];
+      out[hits++] = {p.a, p.b, glm::vec2(lx[lane], ly[lane]), ld[lane]};
+    }
+  }
+  return hits;
+}
+
+bool cpuHasAVX2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!osxsave || (_xgetbv(0) & 6) != 6) return false;  // OS saves YMM state
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // WHISKERS_X86
+
+}  // namespace
+
+Narrowphase::Narrowphase() : simd(bestSimd()) {}
+
+Narrowphase::Simd Narrowphase::bestSimd() {
+#ifdef WHISKERS_X86
+  return cpuHasAVX2() ? Simd::AVX2 : Simd::SSE2;
+#else
+  return Simd::Scalar;
+#endif
+}
+
+void Narrowphase::setSimd(Simd level) { simd = std::min(level, bestSimd()); }
+
+const char *Narrowphase::simdName(Simd level) {
+  switch (level) {
+    case Simd::AVX2:
+      return "avx2";
+    case Simd::SSE2:
+      return "sse2";
+    default:
+      return "scalar";
+  }
+}
+
+void Narrowphase::findContacts(const std::vector<Entity> &entities,
+                               const std::vector<BroadphasePair> &pairs,
+                               std::vector<Contact> &contacts) {
+  contacts.resize(pairs.size());  // upper bound; trimmed below
+  size_t found = 0;
+  for (size_t first = 0; first < pairs.size(); first += batchSize) {
+    size_t count = std::min(batchSize, pairs.size() - first);
+
+    // Gather the pairs' positions and combined radii into SoA lanes.
+    for (size_t i = 0; i < count; i++) {
+      const Entity &a = entities[pairs[first + i].a];
+      const Entity &b = entities[pairs[first + i].b];
+      ax[i] = a.position.x;
+      ay[i] = a.position.y;
+      bx[i] = b.position.x;
+      by[i] = b.position.y;
+      reach[i] = (a.radius + b.radius) * PhysicsSystem::radiusToWorld;
+    }
+    // Pad to whole vectors with coincident zero-reach lanes, which never hit.
+    size_t padded = (count + 7) & ~size_t(7);
+    for (size_t i = count; i < padded; i++) ax[i] = ay[i] = bx[i] = by[i] = reach[i] = 0.0f;
+
+    BatchIn in{ax, ay, bx, by, reach, pairs.data() + first};
+    Contact *out = contacts.data() + found;
+    switch (simd) {
+#ifdef WHISKERS_X86
+      case Simd::AVX2:
+        found += kernelAVX2(in, padded, out);
+        break;
+      case Simd::SSE2:
+        found += kernelSSE2(in, padded, out);
+        break;
+#endif
+      default:
+        found += kernelScalar(in, padded, out);
+        break;
+    }
+  }
+  contacts.resize(found);
+}
@@ -0,0 +1,46 @@
+// Narrowphase.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Broadphase.h"
+
+// Overlapping circle pair. normal points from a to b along the minimum-image
+// separation; penetration is how far the circles overlap, in world units.
+struct Contact {
+  uint32_t a, b;
+  glm::vec2 normal;
+  float penetration;
+};
+
+// Exact circle-vs-circle test over broadphase pairs. Pairs are gathered from
+// the entity array into structure-of-arrays batches, and each batch is tested
+// 8 lanes at a time with AVX2, 4 with SSE2, or one by one elsewhere. The
+// paths perform the same float operations in the same order (no FMA), so on
+// x86 they produce identical contacts.
+class Narrowphase {
+ public:
+  enum class Simd { Scalar, SSE2, AVX2 };
+
+  Narrowphase();
+
+  void findContacts(const std::vector<Entity> &entities, const std::vector<BroadphasePair> &pairs,
+                    std::vector<Contact> &contacts);
+
+  // Best level the CPU supports is picked at construction; lower it to
+  // compare paths. Requests above what the CPU supports are clamped.
+  void setSimd(Simd level);
+  Simd getSimd() const { return simd; }
+  static Simd bestSimd();
+  static const char *simdName(Simd level);
+
+ private:
+  static constexpr size_t batchSize = 1024;  // pairs; a multiple of every lane width
+
+  Simd simd = Simd::Scalar;
+
+  // Batch lanes, 32-byte aligned for AVX loads.
+  alignas(32) float ax[batchSize], ay[batchSize], bx[batchSize], by[batchSize];
+  alignas(32) float reach[batchSize];
+};
@@ -0,0 +1,149 @@
+// NetProtocol.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "ShipControl.h"  // InputButtons
+
+// Wire format shared by GameServer and GameClient. Every datagram starts
+// with kNetMagic, kNetVersion and a PacketType; fields are little-endian and
+// floats are IEEE 754 bit patterns.
+//
+//   Connect     client -> server, repeated until accepted
+//   Accept      server -> client: u16 clientId, u32 shipIndex, f32 tickInterval
+//   Input       client -> server: u16 clientId, u32 ackedSnapshot (tick of
+//               the newest snapshot it has decoded, 0 for none), u8 count,
+//               then count commands (u32 sequence, u8 buttons), newest first;
+//               the last few are resent every time so a lost datagram costs
+//               nothing
+//   Snapshot    server -> client: u32 tick, u32 ackedSequence, u32
+//               baselineTick (0 for none), u8 flags, u16 fragment, u16
+//               fragmentCount, u16 bytes, then that many bytes of
+//               SnapshotCodec output encoded against the snapshot at
+//               baselineTick: a view (encodeView) if flags has
+//               kSnapshotView, else the whole world (encode). Output longer
+//               than kSnapshotChunkBytes is split into fragments; fragment f
+//               holds the bytes from f * kSnapshotChunkBytes on
+//   Disconnect  either way: u16 clientId
+constexpr uint16_t kNetMagic = 0x4b57;  // "WK"
+constexpr uint8_t kNetVersion = 3;
+// Stays under common path MTUs so datagrams are never IP-fragmented.
+constexpr size_t kMaxPacketSize = 1200;
+// Packet header, then the Snapshot fields before the payload.
+constexpr size_t kSnapshotHeaderBytes = 4 + 4 + 4 + 4 + 1 + 2 + 2 + 2;
+constexpr size_t kSnapshotChunkBytes = kMaxPacketSize - kSnapshotHeaderBytes;
+// About 1.2 MB; clients drop snapshots claiming more, so one datagram can't
+// make them allocate 77 MB.
+constexpr uint16_t kMaxSnapshotFragments = 1024;
+
+enum class PacketType : uint8_t { Connect, Accept, Input, Snapshot, Disconnect };
+
+// Snapshot flags.
+constexpr uint8_t kSnapshotView = 1;  // interest-managed (InterestManager)
+
+struct InputCommand {
+  uint32_t sequence = 0;
+  uint8_t buttons = 0;
+};
+
+// Appends fields to a fixed datagram buffer; overflowed() once anything
+// didn't fit.
+class PacketWriter {
+ public:
+  explicit PacketWriter(PacketType type) {
+    u16(kNetMagic);
+    u8(kNetVersion);
+    u8((uint8_t)type);
+  }
+
+  void u8(uint8_t v) { put(&v, 1); }
+  void u16(uint16_t v) {
+    uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+    put(b, 2);
+  }
+  void u32(uint32_t v) {
+    uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+    put(b, 4);
+  }
+  void f32(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, 4);
+    u32(bits);
+  }
+  void raw(const void *data, size_t n) { put((const uint8_t *)data, n); }
+
+  const uint8_t *data() const { return buffer; }
+  size_t size() const { return length; }
+  size_t remaining() const { return kMaxPacketSize - length; }
+  bool overflowed() const { return overflow; }
+
+ private:
+  void put(const uint8_t *bytes, size_t n) {
+    if (length + n > kMaxPacketSize) {
+      overflow = true;
+      return;
+    }
+    std::memcpy(buffer + length, bytes, n);
+    length += n;
+  }
+
+  uint8_t buffer[kMaxPacketSize];
+  size_t length = 0;
+  bool overflow = false;
+};
+
+// Reads fields back; reads past the end return 0 and clear ok().
+class PacketReader {
+ public:
+  PacketReader(const void *data, size_t size) : bytes((const uint8_t *)data), length(size) {}
+
+  // Checks the header; false for anything that isn't ours.
+  bool header(PacketType &type) {
+    if (u16() != kNetMagic || u8() != kNetVersion) return false;
+    type = (PacketType)u8();
+    return valid;
+  }
+
+  uint8_t u8() { return need(1) ? bytes[pos++] : 0; }
+  uint16_t u16() {
+    if (!need(2)) return 0;
+    uint16_t v = (uint16_t)(bytes[pos] | bytes[pos + 1] << 8);
+    pos += 2;
+    return v;
+  }
+  uint32_t u32() {
+    if (!need(4)) return 0;
+    uint32_t v = (uint32_t)bytes[pos] | (uint32_t)bytes[pos + 1] << 8 |
+                 (uint32_t)bytes[pos + 2] << 16 | (uint32_t)bytes[pos + 3] << 24;
+    pos += 4;
+    return v;
+  }
+  float f32() {
+    uint32_t bits = u32();
+    float v;
+    std::memcpy(&v, &bits, 4);
+    return v;
+  }
+  // The next n bytes in place, or null if there aren't that many.
+  const uint8_t *raw(size_t n) {
+    if (!need(n)) return nullptr;
+    const uint8_t *p = bytes + pos;
+    pos += n;
+    return p;
+  }
+
+  bool ok() const { return valid; }
+  size_t remaining() const { return length - pos; }
+
+ private:
+  bool need(size_t n) {
+    if (pos + n > length) valid = false;
+    return valid;
+  }
+
+  const uint8_t *bytes;
+  size_t length;
+  size_t pos = 0;
+  bool valid = true;
+};
@@ -1,29 +1,43 @@
 #include "PhysicsSystem.h"
 
+#include <algorithm>
+
 #include "EntityManager.h"
 
 void PhysicsSystem::update(EntityManager& em, float dt) {
   auto& entities = em.getEntities();
-  const float bound = 1.05f;
 
-  for (Entity& e : entities) {
-    e.position += e.velocity * dt;
-    e.angle += e.angularVelocity * dt;
+  if (gravityEnabled) {
+    gravity.computeAccelerations(entities, jobs, accelerations);
+    for (size_t i = 0; i < entities.size(); i++) entities[i].velocity += accelerations[i] * dt;
+  }
 
-    if (e.angle >= 360.0f) e.angle -= 360.0f;
-    if (e.angle < 0.0f) e.angle += 360.0f;
+  integrate(entities.data(), entities.size(), dt);
 
-    if (e.position.x > bound) e.position.x = -bound;
-    if (e.position.x < -bound) e.position.x = bound;
-    if (e.position.y > bound) e.position.y = -bound;
-    if (e.position.y < -bound) e.position.y = bound;
+  if (broadphase) {
+    broadphase->setSweepTime(ccdEnabled ? dt : 0.0f);
+    broadphase->findPairs(entities, pairs);
+    // Pair order becomes contact order and so the solver's colouring.
+    // Sorted, it depends only on the entities, not on the broadphase's
+    // history (the tree's shape, sweep-and-prune ties), so re-run ticks
+    // match for rollback and lockstep whichever broadphase is in use.
+    std::sort(pairs.begin(), pairs.end(), [](const BroadphasePair& x, const BroadphasePair& y) {
+      return x.a != y.a ? x.a < y.a : x.b < y.b;
+    });
+  } else {
+    pairs.clear();
+  }
+  narrowphase.findContacts(entities, pairs, contacts);
+  if (ccdEnabled) {
+    ccd.findImpacts(entities, pairs, dt, impacts);
+  } else {
+    impacts.clear();
+  }
+  solver.solve(entities, contacts, jobs);
 
-    // bullet lifetime
-    if (e.type == EntityType::Bullet) {
-      e.ttl -= dt;
-      if (e.ttl <= 0) {
-        e.radius = -1;  // mark as dead
-      }
-    }
+  if (fractureEnabled) {
+    fracture.queueImpacts(entities, impacts);
+    fracture.apply(em);
   }
-}
\ No newline at end of file
+  query.bind(broadphase.get(), &entities);
+}
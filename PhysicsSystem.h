@@ -1,17 +1,75 @@
 // PhysicsSystem.h
 #pragma once
-#include <SDL2/SDL.h>
-
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>  // for glm::pi
+#include <memory>
+#include <vector>
 
+#include "Broadphase.h"
+#include "ContactSolver.h"
+#include "ContinuousCollision.h"
 #include "EntityManager.h"
+#include "FractureSystem.h"
+#include "GravityField.h"
+#include "JobSystem.h"
+#include "Narrowphase.h"
+#include "SpatialQuery.h"
 
 class PhysicsSystem {
  public:
   void update(EntityManager &em, float deltaTime);
+  // The first stage of update: moves, spins and wraps entities and ages
+  // bullets, nothing else. Runs on Entity or, for lockstep, FixedEntity.
+  template <typename E>
+  static void integrate(E *entities, size_t count, decltype(E::radius) deltaTime);
   bool getThrusting() const { return isThrusting; }
 
+  // Collision broadphase run after integration each update; none by default.
+  // Swappable at runtime (see createBroadphase).
+  void setBroadphase(std::unique_ptr<Broadphase> bp) {
+    broadphase = std::move(bp);
+    query.bind(nullptr, nullptr);  // finds nothing until the next update
+  }
+  Broadphase *getBroadphase() const { return broadphase.get(); }
+  // Candidate pairs found by the last update.
+  const std::vector<BroadphasePair> &getPairs() const { return pairs; }
+  // Overlapping circles among those pairs.
+  const std::vector<Contact> &getContacts() const { return contacts; }
+  Narrowphase &getNarrowphase() { return narrowphase; }
+  // Earliest bullet hit during the last update, found by sweeping bullets
+  // over the whole step, so fast bullets can't pass through small targets.
+  // On by default; needs a broadphase.
+  const std::vector<Impact> &getImpacts() const { return impacts; }
+  void setContinuousCollision(bool enabled) { ccdEnabled = enabled; }
+  bool getContinuousCollision() const { return ccdEnabled; }
+  // Bounces colliding asteroids off each other after collision detection.
+  ContactSolver &getContactSolver() { return solver; }
+  // Asteroid gravity, applied to velocities before integration. Off by
+  // default.
+  void setGravityEnabled(bool enabled) { gravityEnabled = enabled; }
+  bool getGravityEnabled() const { return gravityEnabled; }
+  GravityField &getGravityField() { return gravity; }
+  // Splits asteroids hit by bullets (see getImpacts) at the end of update.
+  // Off by default.
+  void setFractureEnabled(bool enabled) { fractureEnabled = enabled; }
+  bool getFractureEnabled() const { return fractureEnabled; }
+  FractureSystem &getFractureSystem() { return fracture; }
+  // Radius, box, nearest-neighbour and ray queries over the broadphase and
+  // entities of the last update (without a broadphase, a linear scan).
+  const SpatialQuery &getSpatialQuery() const { return query; }
+
+  // Pool for the parallel parts of update; null (the default) runs them on
+  // the calling thread. Not owned.
+  void setJobSystem(JobSystem *js) { jobs = js; }
+  JobSystem *getJobSystem() const { return jobs; }
+
+  // Positions wrap toroidally at +/- worldBound (slightly past the visible
+  // -1..1 so entities leave the screen before reappearing).
+  static constexpr float worldBound = 1.05f;
+  // Entity::radius is in pixels of the 800 px wide window, which spans two
+  // world units.
+  static constexpr float radiusToWorld = 1.0f / 400.0f;
+
  private:
   const float rotationSpeed = 180.0f;  // degrees per second
   const float thrustPower = 3.0f;      // acceleration units per second²
@@ -19,4 +77,48 @@ class PhysicsSystem {
   const float scale = 0.5f;            // ship size scale
 
   bool isThrusting = false;
+
+  std::unique_ptr<Broadphase> broadphase;
+  std::vector<BroadphasePair> pairs;
+  Narrowphase narrowphase;
+  std::vector<Contact> contacts;
+  bool ccdEnabled = true;
+  ContinuousCollision ccd;
+  std::vector<Impact> impacts;
+  ContactSolver solver;
+  bool gravityEnabled = false;
+  GravityField gravity;
+  std::vector<glm::vec2> accelerations;
+  bool fractureEnabled = false;
+  FractureSystem fracture;
+  SpatialQuery query;
+  JobSystem *jobs = nullptr;
 };
+
+template <typename E>
+void PhysicsSystem::integrate(E *entities, size_t count, decltype(E::radius) dt) {
+  using Real = decltype(E::radius);
+  const Real bound(worldBound);
+  const Real fullTurn(360), zero(0);
+  for (size_t i = 0; i < count; i++) {
+    E &e = entities[i];
+    e.position += e.velocity * dt;
+    e.angle += e.angularVelocity * dt;
+
+    if (e.angle >= fullTurn) e.angle -= fullTurn;
+    if (e.angle < zero) e.angle += fullTurn;
+
+    if (e.position.x > bound) e.position.x = -bound;
+    if (e.position.x < -bound) e.position.x = bound;
+    if (e.position.y > bound) e.position.y = -bound;
+    if (e.position.y < -bound) e.position.y = bound;
+
+    // bullet lifetime
+    if (e.type == EntityType::Bullet) {
+      e.ttl -= dt;
+      if (e.ttl <= zero) {
+        e.radius = Real(-1);  // mark as dead
+      }
+    }
+  }
+}
@@ -0,0 +1,95 @@
+// PngWriter.cpp
+#include "PngWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+uint32_t crc32(const unsigned char *data, size_t len, uint32_t crc = 0xFFFFFFFFu) {
+  static uint32_t table[256];
+  static bool tableReady = false;
+  if (!tableReady) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+    tableReady = true;
+  }
+  for (size_t i = 0; i < len; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return crc;
+}
+
+void putU32(std::vector<unsigned char> &out, uint32_t v) {
+  out.push_back((v >> 24) & 0xFF);
+  out.push_back((v >> 16) & 0xFF);
+  out.push_back((v >> 8) & 0xFF);
+  out.push_back(v & 0xFF);
+}
+
+void putChunk(std::vector<unsigned char> &out, const char *type,
+              const std::vector<unsigned char> &data) {
+  putU32(out, (uint32_t)data.size());
+  size_t typeStart = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  uint32_t crc = crc32(out.data() + typeStart, out.size() - typeStart) ^ 0xFFFFFFFFu;
+  putU32(out, crc);
+}
+
+}  // namespace
+
+bool writePNG(const std::string &filepath, int width, int height, const unsigned char *rgba) {
+  const size_t stride = (size_t)width * 4;
+
+  // Scanlines with filter byte 0 (none).
+  std::vector<unsigned char> raw;
+  raw.reserve((stride + 1) * height);
+  for (int y = 0; y < height; y++) {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgba + y * stride, rgba + (y + 1) * stride);
+  }
+
+  // zlib stream made of stored (uncompressed) deflate blocks.
+  std::vector<unsigned char> idat = {0x78, 0x01};
+  uint32_t a = 1, b = 0;
+  for (unsigned char c : raw) {
+    a = (a + c) % 65521;
+    b = (b + a) % 65521;
+  }
+  size_t pos = 0;
+  do {
+    size_t len = std::min<size_t>(raw.size() - pos, 65535);
+    bool last = pos + len == raw.size();
+    idat.push_back(last ? 1 : 0);
+    idat.push_back(len & 0xFF);
+    idat.push_back((len >> 8) & 0xFF);
+    idat.push_back(~len & 0xFF);
+    idat.push_back((~len >> 8) & 0xFF);
+    idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+    pos += len;
+  } while (pos < raw.size());
+  putU32(idat, (b << 16) | a);
+
+  std::vector<unsigned char> ihdr;
+  putU32(ihdr, width);
+  putU32(ihdr, height);
+  ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});  // 8-bit RGBA, no interlace
+
+  std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  putChunk(png, "IHDR", ihdr);
+  putChunk(png, "IDAT", idat);
+  putChunk(png, "IEND", {});
+
+  std::ofstream file(filepath, std::ios::binary);
+  if (!file) {
+    std::cerr << "Failed to write PNG: " << filepath << "\n";
+    return false;
+  }
+  file.write((const char *)png.data(), png.size());
+  return (bool)file;
+}
@@ -0,0 +1,7 @@
+// PngWriter.h
+#pragma once
+#include <string>
+
+// Writes 8-bit RGBA pixels (top row first) as an uncompressed PNG. Used for
+// golden-image dumps; stb_image only covers the decode side.
+bool writePNG(const std::string &filepath, int width, int height, const unsigned char *rgba);
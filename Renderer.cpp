@@ -4,13 +4,12 @@
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
 
+#include <algorithm>
 #include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <string>
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 
 const char *vertexShaderSource = R"(
 #version 330 core
@@ -53,6 +52,39 @@ void main()
 }
 )";
 
+// Instanced bullets read per-instance data from GpuPhysics::GpuEntity
+// (position at byte 0, angle/angularVelocity/radius/ttl at 16, type at 32).
+const char *instancedVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 iPosition;
+layout (location = 2) in vec4 iState;  // angle, angularVelocity, radius, ttl
+layout (location = 3) in uint iType;
+
+uniform mat4 projection;
+
+const uint BULLET = 2u;
+
+void main()
+{
+    if (iType != BULLET || iState.z < 0.0) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);  // outside the clip volume
+        return;
+    }
+    gl_Position = projection * vec4(aPos.xy * 0.02 + iPosition, aPos.z, 1.0);
+}
+)";
+
+const char *instancedFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0, 1.0, 0.0, 1.0);  // yellow bullets
+}
+)";
+
 Renderer::Renderer(int width, int height) : windowWidth(width), windowHeight(height) {
 }
 
@@ -64,27 +96,11 @@ Renderer::~Renderer() {
     glDeleteVertexArrays(1, &flameLayers[i].VAO);
   }
   glDeleteProgram(shaderProgram);
-}
-
-GLuint Renderer::loadTexture(const std::string &filepath) {
-  GLuint texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-
-  int width, height, channels;
-  unsigned char *data = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
-
-  if (data) {
-    GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    std::cout << "Loaded texture: " << filepath << std::endl;
-  } else {
-    std::cout << "Failed to load texture: " << filepath << std::endl;
-  }
-
-  stbi_image_free(data);
-  return texture;
+  glDeleteVertexArrays(1, &instancedVAO);
+  glDeleteProgram(instancedProgram);
+  glDeleteFramebuffers(1, &offscreenFBO);
+  glDeleteRenderbuffers(1, &offscreenColor);
+  glDeleteRenderbuffers(1, &offscreenDepth);
 }
 
 GLuint Renderer::compileShader(GLenum type, const char *source) {
@@ -102,13 +118,17 @@ GLuint Renderer::compileShader(GLenum type, const char *source) {
   return shader;
 }
 
-GLuint Renderer::createShaderProgram() {
-  GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-  GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-  GLuint program = glCreateProgram();
+GLuint Renderer::createShaderProgram(const char *vertexSource, const char *fragmentSource) {
+  GLuint program = shaderCache.load(vertexSource, fragmentSource);
+  if (program) return program;
+
+  GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+  GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+  program = glCreateProgram();
 
   glAttachShader(program, vertexShader);
   glAttachShader(program, fragmentShader);
+  shaderCache.prepare(program);
   glLinkProgram(program);
 
   GLint success;
@@ -123,6 +143,7 @@ GLuint Renderer::createShaderProgram() {
   glDeleteShader(vertexShader);
   glDeleteShader(fragmentShader);
 
+  shaderCache.store(program, vertexSource, fragmentSource);
   return program;
 }
 
@@ -187,7 +208,7 @@ void Renderer::setupFlames() {
 }
 
 bool Renderer::init() {
-  shaderProgram = createShaderProgram();
+  shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
   if (!shaderProgram) return false;
 
   setupShip();
@@ -204,12 +225,91 @@ bool Renderer::init() {
   projLoc = glGetUniformLocation(shaderProgram, "projection");
   overrideColorLoc = glGetUniformLocation(shaderProgram, "overrideColor");
 
-  spaceshipTexture = loadTexture("stellar_whiskers_spaceship.png");
+  // Decoded on a worker thread and uploaded over the next frames; the ship
+  // draws with a placeholder until then.
+  textureLoader.init();
+  spaceshipTexture = textureLoader.request("stellar_whiskers_spaceship.png");
+
+  return true;
+}
 
+bool Renderer::loadAtlas(const std::string &manifestPath) {
+  if (!atlas.load(manifestPath)) return false;
+
+  GLuint spriteProgram = createShaderProgram(spriteVertexShaderSource, spriteFragmentShaderSource);
+  if (!spriteProgram) return false;
+  spriteBatch.init(spriteProgram, (int)atlas.pageFiles().size());
+
+  for (const std::string &page : atlas.pageFiles()) {
+    atlasPages.push_back(textureLoader.request(page));
+  }
   return true;
 }
 
+void Renderer::drawSprite(int sprite, glm::vec2 position, glm::vec2 size, float angle,
+                          glm::vec4 tint) {
+  spriteBatch.add(atlas.region(sprite), position, size, angle, tint);
+}
+
+void Renderer::flushSprites() {
+  // Resolve page textures per flush: they show the placeholder while loading.
+  atlasPageTextures.resize(atlasPages.size());
+  for (size_t i = 0; i < atlasPages.size(); i++) {
+    atlasPageTextures[i] = textureLoader.get(atlasPages[i]);
+  }
+
+  glm::mat4 projection = glm::ortho(-1.f, 1.f, -1.f, 1.f, -1.f, 1.f);
+  spriteBatch.flush(projection, atlasPageTextures);
+}
+
+bool Renderer::initOffscreen(int width, int height) {
+  windowWidth = width;
+  windowHeight = height;
+
+  glGenRenderbuffers(1, &offscreenColor);
+  glBindRenderbuffer(GL_RENDERBUFFER, offscreenColor);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenRenderbuffers(1, &offscreenDepth);
+  glBindRenderbuffer(GL_RENDERBUFFER, offscreenDepth);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glGenFramebuffers(1, &offscreenFBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreenColor);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                            offscreenDepth);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Offscreen framebuffer incomplete\n";
+    return false;
+  }
+
+  glViewport(0, 0, width, height);
+  return true;
+}
+
+void Renderer::readPixels(std::vector<unsigned char> &rgba) {
+  const size_t stride = (size_t)windowWidth * 4;
+  rgba.resize(stride * windowHeight);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, windowWidth, windowHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+  // GL origin is bottom-left; flip so row 0 is the top of the image.
+  std::vector<unsigned char> row(stride);
+  for (int y = 0; y < windowHeight / 2; y++) {
+    unsigned char *top = rgba.data() + y * stride;
+    unsigned char *bottom = rgba.data() + (windowHeight - 1 - y) * stride;
+    std::copy(top, top + stride, row.begin());
+    std::copy(bottom, bottom + stride, top);
+    std::copy(row.begin(), row.end(), bottom);
+  }
+}
+
 void Renderer::clear() {
+  textureLoader.pump();  // start of frame: continue any pending texture uploads
+
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);  // Pure black background
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
@@ -239,7 +339,7 @@ void Renderer::renderShip(const Entity &ship, bool thrusting) {
 
   glBindVertexArray(shipVAO);
   glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, spaceshipTexture);
+  glBindTexture(GL_TEXTURE_2D, textureLoader.get(spaceshipTexture));
   glUniform1i(glGetUniformLocation(shaderProgram, "spaceshipTexture"), 0);
 
   glBindVertexArray(shipVAO);
@@ -304,3 +404,41 @@ void Renderer::renderBullet(const Entity &bullet) {
   glBindVertexArray(shipVAO);
   glDrawArrays(GL_TRIANGLES, 0, 3);
 }
+
+void Renderer::renderEntityBuffer(GLuint buffer, size_t count) {
+  if (!instancedProgram) {
+    instancedProgram =
+        createShaderProgram(instancedVertexShaderSource, instancedFragmentShaderSource);
+    instancedProjLoc = glGetUniformLocation(instancedProgram, "projection");
+    glGenVertexArrays(1, &instancedVAO);
+    glBindVertexArray(instancedVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, shipVBO);  // same triangle as renderBullet
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+  }
+
+  glBindVertexArray(instancedVAO);
+  if (buffer != instancedBuffer) {
+    // Point the per-instance attributes at the storage buffer; the VAO keeps
+    // them across frames (and across GpuPhysics growing the buffer's storage).
+    const GLsizei stride = 48;  // sizeof(GpuPhysics::GpuEntity)
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void *)16);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, stride, (void *)32);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(3);
+    instancedBuffer = buffer;
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glm::mat4 projection = glm::ortho(-1.f, 1.f, -1.f, 1.f, -1.f, 1.f);
+  glUseProgram(instancedProgram);
+  glUniformMatrix4fv(instancedProjLoc, 1, GL_FALSE, glm::value_ptr(projection));
+  glDrawArraysInstanced(GL_TRIANGLES, 0, 3, (GLsizei)count);
+  glBindVertexArray(0);
+}
@@ -2,8 +2,13 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
 #include "Entity.h"
+#include "ShaderCache.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "TextureLoader.h"
 
 #ifndef RENDERER_H
 #define RENDERER_H
@@ -24,19 +29,53 @@ class Renderer {
   void renderAsteroid(const Entity &asteroid);
   void renderBullet(const Entity &bullet);
 
+  // Draws bullets straight from a GpuPhysics storage buffer with one instanced
+  // draw, matching renderBullet. Ships/asteroids in the buffer are skipped.
+  void renderEntityBuffer(GLuint buffer, size_t count);
+
+  // Headless mode: render into an FBO instead of the default framebuffer.
+  bool initOffscreen(int width, int height);
+  // Reads back the current frame as RGBA, top row first.
+  void readPixels(std::vector<unsigned char> &rgba);
+
+  // True once all textures requested in init() have finished uploading.
+  bool texturesReady() { return textureLoader.idle(); }
+
+  // Sprite batching: load a .atlas manifest (see whiskers_atlaspack), queue
+  // sprites by index, then flush once per frame for one draw per atlas page.
+  bool loadAtlas(const std::string &manifestPath);
+  int findSprite(const std::string &name) const { return atlas.find(name); }
+  int spriteCount() const { return atlas.size(); }
+  void drawSprite(int sprite, glm::vec2 position, glm::vec2 size, float angle,
+                  glm::vec4 tint = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+  void flushSprites();
+  int spriteDrawCalls() const { return spriteBatch.lastDrawCalls(); }
+
  private:
-  GLuint spaceshipTexture = 0;
-  GLuint loadTexture(const std::string &filepath);
+  TextureLoader textureLoader;
+  size_t spaceshipTexture = 0;
+
+  TextureAtlas atlas;
+  std::vector<size_t> atlasPages;  // TextureLoader ids, one per atlas page
+  std::vector<GLuint> atlasPageTextures;
+  SpriteBatch spriteBatch;
   void setupShip();
   void setupFlames();
 
   GLuint compileShader(GLenum type, const char *source);
-  GLuint createShaderProgram();
+  GLuint createShaderProgram(const char *vertexSource, const char *fragmentSource);
+  ShaderCache shaderCache;
 
   GLuint shaderProgram = 0;
 
   GLuint shipVAO = 0, shipVBO = 0;
 
+  GLuint instancedProgram = 0;
+  GLuint instancedVAO = 0, instancedBuffer = 0;
+  GLint instancedProjLoc = -1;
+
+  GLuint offscreenFBO = 0, offscreenColor = 0, offscreenDepth = 0;
+
   struct FlameLayer {
     GLuint VAO = 0, VBO = 0;
     float scaleBase;
@@ -0,0 +1,50 @@
+// RollbackSystem.cpp
+#include "RollbackSystem.h"
+
+RollbackSystem::RollbackSystem(EntityManager &em, PhysicsSystem &physics, size_t maxRollback)
+    : entities(em), physics(physics), frames(maxRollback < 1 ? 1 : maxRollback) {}
+
+uint32_t RollbackSystem::getOldestTick() const {
+  // Saves are made in tick order, so the oldest still held is the earliest
+  // one in the window that hasn't been overwritten or dropped.
+  uint32_t size = (uint32_t)frames.size();
+  uint32_t tick = currentTick > size ? currentTick - size : 0;
+  while (tick < currentTick) {
+    const Frame &f = frames[tick % size];
+    if (f.saved && f.tick == tick) break;
+    tick++;
+  }
+  return tick;
+}
+
+void RollbackSystem::advance() {
+  Frame &f = frames[currentTick % frames.size()];
+  f.tick = currentTick;
+  f.saved = true;
+  entities.saveState(f.entities);
+  physics.getFractureSystem().saveState(f.fracture);
+
+  if (tickFn) tickFn(currentTick, entities, timeStep);
+  physics.update(entities, timeStep);
+  currentTick++;
+}
+
+bool RollbackSystem::restore(uint32_t tick) {
+  if (tick == currentTick) return true;
+  if (tick > currentTick || tick < getOldestTick()) return false;
+  const Frame &f = frames[tick % frames.size()];
+  entities.restoreState(f.entities);
+  physics.getFractureSystem().restoreState(f.fracture);
+  // Saves after `tick` describe a future that's being replaced.
+  for (uint32_t t = tick; t < currentTick; t++) frames[t % frames.size()].saved = false;
+  currentTick = tick;
+  return true;
+}
+
+bool RollbackSystem::rollback(uint32_t tick) {
+  uint32_t target = currentTick;
+  if (!restore(tick)) return false;
+  lastResimulated = target - tick;
+  while (currentTick < target) advance();
+  return true;
+}
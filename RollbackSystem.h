@@ -0,0 +1,71 @@
+// RollbackSystem.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+
+// Fixed-step driver for rollback netcode. Before each tick it saves the
+// world (entities and the fracture pool and seed) into a ring of the last few ticks;
+// when an input for a past tick turns out to have been mispredicted, the
+// game corrects its input history and calls rollback, which restores that
+// tick's state and runs the ticks since again.
+//
+// Saved states are whole copies of the entity array rather than diffs:
+// entities are plain data, so a save is one memcpy into a buffer that
+// stopped growing long ago, and a restore is another.
+//
+// Re-running a tick gives bit-for-bit the same result only if everything it
+// depends on is saved or rebuilt. The tick function must depend only on its
+// arguments and the game's input history. PhysicsSystem sorts the
+// broadphase's pairs, so any broadphase will do.
+class RollbackSystem {
+ public:
+  // Game logic for one tick, including applying every player's input for
+  // it; run before each physics update, again for ticks being re-run.
+  using TickFn = std::function<void(uint32_t tick, EntityManager &em, float dt)>;
+
+  // Keeps the states of the last `maxRollback` ticks. Neither is owned.
+  RollbackSystem(EntityManager &em, PhysicsSystem &physics, size_t maxRollback = 8);
+
+  void setTickFunction(TickFn fn) { tickFn = std::move(fn); }
+  void setTimeStep(float dt) { timeStep = dt; }
+  float getTimeStep() const { return timeStep; }
+
+  // Saves the state as getTick(), then runs that tick.
+  void advance();
+  // Restores the state from the start of `tick` and re-runs every tick from
+  // there back up to the current one. False (and nothing changes) if `tick`
+  // is older than getOldestTick() or hasn't happened yet.
+  bool rollback(uint32_t tick);
+  // Just the restore: the world goes back to the start of `tick`, which
+  // becomes the current tick and drops every later save.
+  bool restore(uint32_t tick);
+
+  // The next tick advance will run.
+  uint32_t getTick() const { return currentTick; }
+  // The oldest tick rollback can still go back to.
+  uint32_t getOldestTick() const;
+  size_t getMaxRollback() const { return frames.size(); }
+  // Ticks re-run by the last rollback.
+  uint32_t getLastResimulated() const { return lastResimulated; }
+
+ private:
+  struct Frame {
+    uint32_t tick = 0;
+    bool saved = false;
+    std::vector<Entity> entities;
+    FractureSystem::State fracture;
+  };
+
+  EntityManager &entities;
+  PhysicsSystem &physics;
+  TickFn tickFn;
+  float timeStep = 1.0f / 60.0f;
+  uint32_t currentTick = 0;
+  uint32_t lastResimulated = 0;
+  std::vector<Frame> frames;  // tick t is saved in frames[t % size]
+};
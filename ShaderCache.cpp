@@ -0,0 +1,131 @@
+// ShaderCache.cpp
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[4] = {'W', 'S', 'P', 'B'};
+
+struct EntryHeader {
+  char magic[4];
+  uint32_t binaryFormat;
+  uint64_t driverHash;
+  uint64_t sourceHash;
+  uint32_t length;
+  uint32_t reserved;
+};
+
+// FNV-1a; collisions only cost a recompile since driver and source hashes are
+// both checked on load.
+uint64_t fnv1a(const char *data, size_t len, uint64_t hash = 1469598103934665603ull) {
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (unsigned char)data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint64_t hashSources(const char *vertexSource, const char *fragmentSource) {
+  uint64_t hash = fnv1a(vertexSource, std::strlen(vertexSource));
+  hash = fnv1a("\0", 1, hash);
+  return fnv1a(fragmentSource, std::strlen(fragmentSource), hash);
+}
+
+}  // namespace
+
+uint64_t ShaderCache::driverHash() {
+  if (!cachedDriverHash) {
+    uint64_t hash = 1469598103934665603ull;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+      const char *value = (const char *)glGetString(name);
+      if (value) hash = fnv1a(value, std::strlen(value), hash);
+      hash = fnv1a("\0", 1, hash);
+    }
+    cachedDriverHash = hash;
+  }
+  return cachedDriverHash;
+}
+
+std::string ShaderCache::entryPath(const char *vertexSource, const char *fragmentSource) {
+  char name[64];
+  std::snprintf(name, sizeof(name), "%016llx-%016llx.bin",
+                (unsigned long long)hashSources(vertexSource, fragmentSource),
+                (unsigned long long)driverHash());
+  return directory + "/" + name;
+}
+
+GLuint ShaderCache::load(const char *vertexSource, const char *fragmentSource) {
+  if (!glExtensions.programBinary) return 0;
+
+  std::ifstream file(entryPath(vertexSource, fragmentSource), std::ios::binary);
+  if (!file) return 0;
+
+  EntryHeader header;
+  if (!file.read((char *)&header, sizeof(header)) || std::memcmp(header.magic, kMagic, 4) != 0 ||
+      header.driverHash != driverHash() ||
+      header.sourceHash != hashSources(vertexSource, fragmentSource)) {
+    return 0;
+  }
+  std::vector<char> binary(header.length);
+  if (!file.read(binary.data(), binary.size())) return 0;
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size());
+  GLint success = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success) {
+    // Driver refused the binary (e.g. changed internals under the same version
+    // string); the caller recompiles and overwrites the entry.
+    glDeleteProgram(program);
+    return 0;
+  }
+  return program;
+}
+
+void ShaderCache::prepare(GLuint program) {
+  if (glExtensions.programBinary) {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+}
+
+void ShaderCache::store(GLuint program, const char *vertexSource, const char *fragmentSource) {
+  if (!glExtensions.programBinary) return;
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+  EntryHeader header{};
+  std::memcpy(header.magic, kMagic, 4);
+  header.binaryFormat = format;
+  header.driverHash = driverHash();
+  header.sourceHash = hashSources(vertexSource, fragmentSource);
+  header.length = (uint32_t)length;
+
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+
+  // Write then rename so a crash never leaves a truncated entry behind.
+  std::string path = entryPath(vertexSource, fragmentSource);
+  std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary);
+    file.write((const char *)&header, sizeof(header));
+    file.write(binary.data(), binary.size());
+    if (!file) {
+      std::cerr << "Failed to write shader cache entry: " << tmpPath << "\n";
+      return;
+    }
+  }
+  std::filesystem::rename(tmpPath, path, ec);
+}
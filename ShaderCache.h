@@ -0,0 +1,32 @@
+// ShaderCache.h
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "GLExtensions.h"
+
+// On-disk cache of linked program binaries (glGetProgramBinary). Entries are
+// keyed by a hash of the shader sources plus the GL vendor/renderer/version
+// strings, so a driver update or a shader edit simply misses and the caller
+// falls back to compiling from source.
+class ShaderCache {
+ public:
+  explicit ShaderCache(std::string directory = "shader_cache") : directory(std::move(directory)) {}
+
+  // Returns a linked program from the cache, or 0 on a miss or when the driver
+  // rejects the stored binary.
+  GLuint load(const char *vertexSource, const char *fragmentSource);
+
+  // Call before glLinkProgram so the driver keeps a retrievable binary.
+  void prepare(GLuint program);
+
+  // Saves a successfully linked program.
+  void store(GLuint program, const char *vertexSource, const char *fragmentSource);
+
+ private:
+  std::string entryPath(const char *vertexSource, const char *fragmentSource);
+  uint64_t driverHash();
+
+  std::string directory;
+  uint64_t cachedDriverHash = 0;
+};
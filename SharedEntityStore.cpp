@@ -0,0 +1,191 @@
+// SharedEntityStore.cpp
+#include "SharedEntityStore.h"
+
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the seqlock is shared between processes, so it must not hide a lock");
+static_assert(std::is_trivially_copyable<Entity>::value, "entities are shared as raw memory");
+
+namespace {
+
+// The entities start a cache line in, clear of the header the writer
+// bumps every publish.
+constexpr size_t kHeaderBytes = 64;
+static_assert(sizeof(SharedEntityHeader) <= kHeaderBytes, "header outgrew its cache line");
+
+std::string segmentName(const std::string &name) {
+  return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+}  // namespace
+
+SharedEntityStore::~SharedEntityStore() {
+  close();
+}
+
+bool SharedEntityStore::create(const std::string &segment, size_t capacity) {
+  close();
+#ifdef _WIN32
+  (void)segment;
+  (void)capacity;
+  std::cerr << "Shared entity store needs POSIX shared memory\n";
+  return false;
+#else
+  name = segmentName(segment);
+  if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+  const size_t bytes = kHeaderBytes + capacity * sizeof(Entity);
+
+  // Replace any segment left behind by a run that didn't close it.
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    std::cerr << "Failed to create shared memory " << name << ": " << std::strerror(errno)
+              << "\n";
+    return false;
+  }
+  if (ftruncate(fd, (off_t)bytes) != 0) {
+    std::cerr << "Failed to size shared memory " << name << ": " << std::strerror(errno) << "\n";
+    ::close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+  void *map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    std::cerr << "Failed to map shared memory " << name << ": " << std::strerror(errno) << "\n";
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  // ftruncate zero-fills, so the counters start at 0 and sequence 0 means
+  // nothing published yet.
+  header = new (map) SharedEntityHeader;
+  header->magic = SharedEntityHeader::kMagic;
+  header->version = SharedEntityHeader::kVersion;
+  header->entitySize = (uint32_t)sizeof(Entity);
+  header->capacity = (uint32_t)capacity;
+  entities = (Entity *)((char *)map + kHeaderBytes);
+  mappedBytes = bytes;
+  owner = true;
+  return true;
+#endif
+}
+
+bool SharedEntityStore::open(const std::string &segment) {
+  close();
+#ifdef _WIN32
+  (void)segment;
+  std::cerr << "Shared entity store needs POSIX shared memory\n";
+  return false;
+#else
+  name = segmentName(segment);
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    std::cerr << "Failed to open shared memory " << name << ": " << std::strerror(errno) << "\n";
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < kHeaderBytes) {
+    std::cerr << "Shared memory " << name << " is too small\n";
+    ::close(fd);
+    return false;
+  }
+  const size_t bytes = (size_t)info.st_size;
+  void *map = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    std::cerr << "Failed to map shared memory " << name << ": " << std::strerror(errno) << "\n";
+    return false;
+  }
+
+  const SharedEntityHeader *h = (const SharedEntityHeader *)map;
+  if (h->magic != SharedEntityHeader::kMagic || h->version != SharedEntityHeader::kVersion ||
+      h->entitySize != sizeof(Entity) ||
+      kHeaderBytes + (size_t)h->capacity * sizeof(Entity) > bytes) {
+    std::cerr << "Shared memory " << name << " isn't an entity store from this build\n";
+    munmap(map, bytes);
+    return false;
+  }
+  header = (SharedEntityHeader *)map;
+  entities = (Entity *)((char *)map + kHeaderBytes);
+  mappedBytes = bytes;
+  owner = false;
+  return true;
+#endif
+}
+
+void SharedEntityStore::close() {
+#ifndef _WIN32
+  if (header) munmap(header, mappedBytes);
+  if (owner) shm_unlink(name.c_str());
+#endif
+  header = nullptr;
+  entities = nullptr;
+  mappedBytes = 0;
+  owner = false;
+}
+
+void SharedEntityStore::publish(const Entity *source, size_t count, uint64_t tick) {
+  if (!header || !owner) return;
+  const size_t capacity = header->capacity;
+  const size_t copied = count < capacity ? count : capacity;
+
+  // Odd: readers that start now wait, and ones already reading will see
+  // the sequence has moved.
+  uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  header->tick.store(tick, std::memory_order_relaxed);
+  header->count.store(copied, std::memory_order_relaxed);
+  header->dropped.store(count - copied, std::memory_order_relaxed);
+  std::memcpy(entities, source, copied * sizeof(Entity));
+
+  header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SharedEntityStore::beginRead(uint64_t &sequence) const {
+  sequence = header->sequence.load(std::memory_order_acquire);
+  return !(sequence & 1);
+}
+
+bool SharedEntityStore::endRead(uint64_t sequence) const {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return header->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+bool SharedEntityStore::read(std::vector<Entity> &out, uint64_t &tick, int maxAttempts) const {
+  if (!header) return false;
+  for (int attempt = 0; attempt < maxAttempts; attempt++) {
+    uint64_t sequence;
+    if (!beginRead(sequence)) {
+      // Mid-publish, or a writer that died mid-publish; either way it
+      // uses up an attempt, so readers of a dead writer still give up.
+      retries++;
+      std::this_thread::yield();
+      continue;
+    }
+    if (sequence == 0) return false;  // nothing published yet
+    size_t count = getCount();
+    if (count > header->capacity) count = header->capacity;  // torn; retried below
+    out.resize(count);
+    std::memcpy(out.data(), entities, count * sizeof(Entity));
+    tick = getTick();
+    if (endRead(sequence)) return true;
+    retries++;
+  }
+  return false;
+}
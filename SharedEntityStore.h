@@ -0,0 +1,94 @@
+// SharedEntityStore.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Entity.h"
+
+// The start of a shared entity segment; the entities follow it. `sequence`
+// is a seqlock: odd while the writer is copying, bumped to the next even
+// value once it's done, so a reader that sees the same even value before
+// and after reading got one whole tick.
+struct SharedEntityHeader {
+  static constexpr uint32_t kMagic = 0x57454E54;  // "WENT"
+  static constexpr uint32_t kVersion = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entitySize;  // sizeof(Entity) in the writer's build
+  uint32_t capacity;    // entities the segment holds
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> tick;
+  std::atomic<uint64_t> count;  // entities in the last publish, <= capacity
+  std::atomic<uint64_t> dropped;  // entities past capacity in the last publish
+};
+
+// A named POSIX shared-memory segment (shm_open + mmap) holding a copy of
+// the entity array, so profilers, spectators and replay recorders in other
+// processes can read live world state in place, without a socket or any
+// serialization. The game publishes once per tick (the demo does with
+// --share NAME), which costs one memcpy of the array; readers never block
+// it (a seqlock, not a mutex), they retry if the copy changed under them.
+//
+// The writer creates the segment and removes its name when closed;
+// readers open it read-only by the same name. Entities are raw bytes, so
+// readers must be built with the same Entity layout (entitySize is checked
+// on open). POSIX only; create and open fail on Windows.
+class SharedEntityStore {
+ public:
+  SharedEntityStore() = default;
+  ~SharedEntityStore();
+
+  SharedEntityStore(const SharedEntityStore &) = delete;
+  SharedEntityStore &operator=(const SharedEntityStore &) = delete;
+
+  // Creates (or replaces) the segment `name` ("/whiskers", say; the slash
+  // is added if missing) with room for `capacity` entities. False (and an
+  // error on std::cerr) on failure.
+  bool create(const std::string &name, size_t capacity);
+  // Maps an existing segment read-only.
+  bool open(const std::string &name);
+  // Unmaps, and removes the name if this store created it.
+  void close();
+  bool isOpen() const { return header != nullptr; }
+
+  // Writer: copies `count` entities (up to capacity) in as the state at
+  // `tick`, e.g. EntityManager::getEntities() once per tick after physics.
+  void publish(const Entity *entities, size_t count, uint64_t tick);
+  void publish(const std::vector<Entity> &entities, uint64_t tick) {
+    publish(entities.data(), entities.size(), tick);
+  }
+
+  // Reader: copies the latest whole tick out, retrying while a publish is
+  // in progress or the copy was torn. False if nothing's been published
+  // yet or the writer kept getting in the way for `maxAttempts` (as it
+  // would if it crashed mid-publish).
+  bool read(std::vector<Entity> &out, uint64_t &tick, int maxAttempts = 1000) const;
+  // For reading in place: beginRead takes the sequence, false (try again
+  // later) while a publish is in progress; read what's needed from
+  // getEntities, then endRead says whether it was one tick throughout (if
+  // not, start over). Neither waits, so the caller bounds its retries.
+  bool beginRead(uint64_t &sequence) const;
+  bool endRead(uint64_t sequence) const;
+
+  const Entity *getEntities() const { return entities; }
+  size_t getCapacity() const { return header ? header->capacity : 0; }
+  // Read between beginRead and endRead.
+  uint64_t getTick() const { return header->tick.load(std::memory_order_relaxed); }
+  size_t getCount() const { return (size_t)header->count.load(std::memory_order_relaxed); }
+  // Entities the last publish had no room for.
+  size_t getDropped() const { return (size_t)header->dropped.load(std::memory_order_relaxed); }
+  // Reads retried by read (torn, or begun mid-publish), in total.
+  uint64_t getRetries() const { return retries; }
+
+ private:
+  std::string name;
+  bool owner = false;
+  SharedEntityHeader *header = nullptr;
+  Entity *entities = nullptr;
+  size_t mappedBytes = 0;
+  mutable uint64_t retries = 0;
+};
@@ -0,0 +1,78 @@
+// ShipControl.h
+#pragma once
+#include <cstdint>
+
+#include "Fixed.h"
+
+// The keys main.cpp reads: W, A, D and a press of SPACE.
+enum InputButtons : uint8_t {
+  kInputThrust = 1,
+  kInputLeft = 2,
+  kInputRight = 4,
+  kInputFire = 8,  // set only on the command for the frame the key went down
+};
+
+// Ship handling as main.cpp has always done it, shared by main.cpp,
+// GameServer and VecEnv so the game, the server and training all fly the
+// same ship. Templated on the entity type: on Entity it's the usual float
+// math, on FixedEntity every step is integer math and so identical on every
+// platform, for lockstep.
+
+constexpr float kShipRadius = 16.0f;
+constexpr float kRotationSpeed = 180.0f;  // degrees per second
+constexpr float kThrustPower = 3.0f;      // acceleration units per second²
+constexpr float kDrag = 0.995f;           // per 60th of a second without thrust
+constexpr float kBulletRadius = 2.0f;
+constexpr float kBulletSpeed = 2.0f;
+constexpr float kBulletTtl = 1.5f;
+constexpr float kMuzzleOffset = 0.2f;
+
+// What a tick of `dt` without thrust scales the velocity by.
+template <typename Real>
+Real shipDrag(Real dt) {
+  return power(Real(kDrag), dt * Real(60));
+}
+
+// Turning, thrust along the heading, and drag while not thrusting. `drag`
+// is shipDrag(dt), for callers that steer many ships with the same dt.
+template <typename E>
+void steerShip(E &ship, uint8_t buttons, decltype(E::angle) dt, decltype(E::angle) drag) {
+  using Real = decltype(E::angle);
+  using Vec = decltype(E::velocity);
+
+  if (buttons & kInputLeft)
+    ship.angularVelocity = Real(kRotationSpeed);
+  else if (buttons & kInputRight)
+    ship.angularVelocity = -Real(kRotationSpeed);
+  else
+    ship.angularVelocity = Real(0);
+
+  if (buttons & kInputThrust) {
+    Real heading = ship.angle + Real(90);
+    Vec dir(cosDegrees(heading), sinDegrees(heading));
+    ship.velocity += dir * (Real(kThrustPower) * dt);
+  } else {
+    ship.velocity *= drag;
+  }
+}
+
+template <typename E>
+void steerShip(E &ship, uint8_t buttons, decltype(E::angle) dt) {
+  steerShip(ship, buttons, dt, shipDrag(dt));
+}
+
+// A bullet leaving the ship's nose.
+template <typename E>
+E makeBullet(const E &ship) {
+  using Real = decltype(E::angle);
+  using Vec = decltype(E::velocity);
+  Real heading = ship.angle + Real(90);
+  Vec dir(cosDegrees(heading), sinDegrees(heading));
+  E bullet;
+  bullet.type = EntityType::Bullet;
+  bullet.radius = Real(kBulletRadius);
+  bullet.ttl = Real(kBulletTtl);
+  bullet.position = ship.position + dir * Real(kMuzzleOffset);
+  bullet.velocity = dir * Real(kBulletSpeed);
+  return bullet;
+}
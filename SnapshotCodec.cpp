@@ -0,0 +1,281 @@
+// SnapshotCodec.cpp
+#include "SnapshotCodec.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "BitStream.h"
+#include "PhysicsSystem.h"
+
+namespace {
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+constexpr float kPositionScale = 65536.0f / kPeriod;
+constexpr float kVelocityScale = 32767.0f / SnapshotCodec::maxSpeed;
+constexpr float kAngleScale = 65536.0f / 360.0f;
+constexpr float kRadiusScale = 16.0f;
+constexpr unsigned kRadiusBits = 12;
+constexpr unsigned kTypeBits = 2;
+
+inline uint16_t wrap16(float v) {
+  return (uint16_t)(uint32_t)(int32_t)std::lround(v);
+}
+
+// Differences go out zigzagged (0, -1, 1, -2, ...) behind a prefix naming
+// how many bits follow.
+void writeDelta(BitWriter &w, uint16_t value, uint16_t reference) {
+  int16_t d = (int16_t)(uint16_t)(value - reference);
+  uint16_t z = (uint16_t)(((uint16_t)d << 1) ^ (uint16_t)(d >> 15));
+  if (z == 0) {
+    w.write(0b0, 1);
+  } else if (z < 16) {
+    w.write(0b01, 2);
+    w.write(z, 4);
+  } else if (z < 256) {
+    w.write(0b011, 3);
+    w.write(z, 8);
+  } else {
+    w.write(0b111, 3);
+    w.write(z, 16);
+  }
+}
+
+uint16_t readDelta(BitReader &r, uint16_t reference) {
+  uint16_t z = 0;
+  if (r.bit()) {
+    if (!r.bit())
+      z = (uint16_t)r.read(4);
+    else
+      z = (uint16_t)r.read(r.bit() ? 16 : 8);
+  }
+  uint16_t d = (uint16_t)((z >> 1) ^ (uint16_t)-(int16_t)(z & 1));
+  return (uint16_t)(reference + d);
+}
+
+// Where the baseline's velocity carries its position over `elapsed`, in
+// position quanta. Encoder and decoder must agree to the bit, so this works
+// from the quantized velocity alone.
+inline uint16_t predict(uint16_t position, uint16_t velocity, double quantaPerStep) {
+  long steps = std::lround(((int)velocity - 0x8000) * quantaPerStep);
+  return (uint16_t)(position + (uint16_t)steps);
+}
+
+double quantaPerStep(float elapsed) {
+  return (double)elapsed / kVelocityScale * kPositionScale;
+}
+
+const QuantizedEntity kEmpty;
+
+// A live entity that differs from the baseline `b` (which may be dead).
+void writeLive(BitWriter &w, const QuantizedEntity &q, const QuantizedEntity &b, double step) {
+  bool reshaped = !b.alive || q.type != b.type || q.radius != b.radius;
+  w.bit(reshaped);
+  if (reshaped) {
+    w.write(q.type, kTypeBits);
+    w.write(q.radius, kRadiusBits);
+  }
+  writeDelta(w, q.x, predict(b.x, b.vx, step));
+  writeDelta(w, q.y, predict(b.y, b.vy, step));
+  writeDelta(w, q.vx, b.vx);
+  writeDelta(w, q.vy, b.vy);
+  writeDelta(w, q.angle, b.angle);
+}
+
+void readLive(BitReader &r, const QuantizedEntity &b, double step, QuantizedEntity &q) {
+  q.alive = 1;
+  if (r.bit()) {
+    q.type = (uint8_t)r.read(kTypeBits);
+    q.radius = (uint16_t)r.read(kRadiusBits);
+  } else {
+    q.type = b.type;
+    q.radius = b.radius;
+  }
+  q.x = readDelta(r, predict(b.x, b.vx, step));
+  q.y = readDelta(r, predict(b.y, b.vy, step));
+  q.vx = readDelta(r, b.vx);
+  q.vy = readDelta(r, b.vy);
+  q.angle = readDelta(r, b.angle);
+}
+
+// Gaps between view slots as Elias gamma codes of gap + 1: n one bits,
+// a zero, then the low n bits. 1 bit for adjacent slots, 7 for up to 7
+// apart.
+void writeGap(BitWriter &w, uint32_t gap) {
+  uint64_t v = (uint64_t)gap + 1;
+  unsigned n = 0;
+  while ((v >> (n + 1)) != 0) n++;
+  for (unsigned i = 0; i < n; i++) w.bit(true);
+  w.bit(false);
+  if (n > 0) w.write((uint32_t)v, n);
+}
+
+bool readGap(BitReader &r, uint32_t &gap) {
+  unsigned n = 0;
+  while (r.bit()) {
+    if (++n > 32 || !r.ok()) return false;
+  }
+  uint64_t v = (1ull << n) | (n > 0 ? r.read(n) : 0);
+  gap = (uint32_t)(v - 1);
+  return r.ok() && v - 1 <= UINT32_MAX;
+}
+
+}  // namespace
+
+QuantizedEntity SnapshotCodec::quantize(const Entity &e) {
+  QuantizedEntity q;
+  if (e.radius < 0) return q;  // dead slots are all defaults, so they compare equal
+  q.x = wrap16((e.position.x + kBound) * kPositionScale);
+  q.y = wrap16((e.position.y + kBound) * kPositionScale);
+  q.vx = (uint16_t)(0x8000 + std::lround(std::clamp(e.velocity.x, -maxSpeed, maxSpeed) *
+                                         kVelocityScale));
+  q.vy = (uint16_t)(0x8000 + std::lround(std::clamp(e.velocity.y, -maxSpeed, maxSpeed) *
+                                         kVelocityScale));
+  q.angle = wrap16(e.angle * kAngleScale);
+  q.radius = (uint16_t)std::min<long>(std::lround(e.radius * kRadiusScale),
+                                      BitWriter::mask(kRadiusBits));
+  q.type = (uint8_t)e.type;
+  q.alive = 1;
+  return q;
+}
+
+Entity SnapshotCodec::dequantize(const QuantizedEntity &q) {
+  Entity e;
+  if (!q.alive) {
+    e.radius = -1;
+    return e;
+  }
+  e.position = glm::vec2(q.x / kPositionScale - kBound, q.y / kPositionScale - kBound);
+  e.velocity = glm::vec2(((int)q.vx - 0x8000) / kVelocityScale,
+                         ((int)q.vy - 0x8000) / kVelocityScale);
+  e.angle = q.angle / kAngleScale;
+  e.radius = q.radius / kRadiusScale;
+  e.type = (EntityType)q.type;
+  return e;
+}
+
+void SnapshotCodec::quantize(const std::vector<Entity> &entities,
+                             std::vector<QuantizedEntity> &out) {
+  out.resize(entities.size());
+  for (size_t i = 0; i < entities.size(); i++) out[i] = quantize(entities[i]);
+}
+
+void SnapshotCodec::dequantize(const std::vector<QuantizedEntity> &state,
+                               std::vector<Entity> &out) {
+  out.resize(state.size());
+  for (size_t i = 0; i < state.size(); i++) out[i] = dequantize(state[i]);
+}
+
+void SnapshotCodec::encode(const std::vector<QuantizedEntity> &current,
+                           const std::vector<QuantizedEntity> *baseline, float elapsed,
+                           std::vector<uint8_t> &out) {
+  const double step = quantaPerStep(elapsed);
+  const size_t based = baseline ? std::min(baseline->size(), current.size()) : 0;
+  BitWriter w(out);
+  w.write((uint32_t)current.size(), 32);
+  for (size_t i = 0; i < current.size(); i++) {
+    const QuantizedEntity &q = current[i];
+    const QuantizedEntity &b = i < based ? (*baseline)[i] : kEmpty;
+    if (q == b) {
+      w.bit(false);
+      continue;
+    }
+    w.bit(true);
+    w.bit(q.alive);
+    if (!q.alive) continue;
+
+    writeLive(w, q, b, step);
+  }
+}
+
+bool SnapshotCodec::decode(const uint8_t *data, size_t size,
+                           const std::vector<QuantizedEntity> *baseline, float elapsed,
+                           std::vector<QuantizedEntity> &out) {
+  const double step = quantaPerStep(elapsed);
+  BitReader r(data, size);
+  uint32_t count = r.read(32);
+  // Every slot takes at least a bit, which bounds a corrupt count.
+  if (!r.ok() || count > size * 8) return false;
+  const size_t based = baseline ? std::min<size_t>(baseline->size(), count) : 0;
+  out.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    const QuantizedEntity &b = i < based ? (*baseline)[i] : kEmpty;
+    QuantizedEntity &q = out[i];
+    if (!r.bit()) {
+      q = b;
+      continue;
+    }
+    q = QuantizedEntity();
+    if (!r.bit()) continue;
+
+    readLive(r, b, step, q);
+  }
+  return r.ok();
+}
+
+QuantizedEntity SnapshotCodec::extrapolate(const QuantizedEntity &q, float elapsed) {
+  if (!q.alive) return q;
+  const double step = quantaPerStep(elapsed);
+  QuantizedEntity e = q;
+  e.x = predict(q.x, q.vx, step);
+  e.y = predict(q.y, q.vy, step);
+  return e;
+}
+
+void SnapshotCodec::encodeView(const SnapshotView &current, const SnapshotView *baseline,
+                               float elapsed, std::vector<uint8_t> &out) {
+  const double step = quantaPerStep(elapsed);
+  BitWriter w(out);
+  w.write(current.slotCount, 32);
+  w.write((uint32_t)current.slots.size(), 32);
+  size_t j = 0;  // baseline cursor; both are in slot order
+  uint32_t next = 0;
+  for (size_t i = 0; i < current.slots.size(); i++) {
+    uint32_t slot = current.slots[i];
+    writeGap(w, slot - next);
+    next = slot + 1;
+
+    const QuantizedEntity *b = &kEmpty;
+    if (baseline) {
+      while (j < baseline->slots.size() && baseline->slots[j] < slot) j++;
+      if (j < baseline->slots.size() && baseline->slots[j] == slot) b = &baseline->states[j];
+    }
+    const QuantizedEntity &q = current.states[i];
+    if (q == *b) {
+      w.bit(false);
+      continue;
+    }
+    w.bit(true);
+    writeLive(w, q, *b, step);
+  }
+}
+
+bool SnapshotCodec::decodeView(const uint8_t *data, size_t size,
+                               const std::vector<QuantizedEntity> *baseline, float elapsed,
+                               std::vector<QuantizedEntity> &out) {
+  const double step = quantaPerStep(elapsed);
+  BitReader r(data, size);
+  uint32_t slotCount = r.read(32);
+  uint32_t count = r.read(32);
+  // Each entry takes at least two bits, and the slots cost nothing to
+  // skip, so bound the world by something a real server would send.
+  if (!r.ok() || count > size * 4 || count > slotCount || slotCount > maxViewSlots) return false;
+  out.assign(slotCount, kEmpty);
+  uint32_t next = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t gap;
+    if (!readGap(r, gap) || gap >= slotCount - next) return false;
+    uint32_t slot = next + gap;
+    next = slot + 1;
+
+    const QuantizedEntity &b =
+        baseline && slot < baseline->size() ? (*baseline)[slot] : kEmpty;
+    if (!r.bit()) {
+      if (!b.alive) return false;  // entries are live; an unchanged one needs a live baseline
+      out[slot] = b;
+      continue;
+    }
+    readLive(r, b, step, out[slot]);
+  }
+  return r.ok();
+}
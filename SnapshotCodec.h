@@ -0,0 +1,85 @@
+// SnapshotCodec.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Entity.h"
+
+// What a client needs of an entity, quantized:
+//   position  16 bits per axis over the world's wrap period, so wrapping is
+//             just 16-bit overflow (about 1/80 px)
+//   velocity  16 bits per axis, clamped to +/- maxSpeed
+//   angle     16 bits over 360 degrees
+//   radius    12 bits in 1/16 px (up to 256 px)
+//   type      2 bits, plus whether the slot is alive at all
+// Angular velocity and bullet ttl stay on the server.
+struct QuantizedEntity {
+  uint16_t x = 0x8000, y = 0x8000;    // 0x8000 is the world's centre
+  uint16_t vx = 0x8000, vy = 0x8000;  // and zero velocity
+  uint16_t angle = 0;
+  uint16_t radius = 0;
+  uint8_t type = 0;
+  uint8_t alive = 0;
+
+  bool operator==(const QuantizedEntity &o) const {
+    return x == o.x && y == o.y && vx == o.vx && vy == o.vy && angle == o.angle &&
+           radius == o.radius && type == o.type && alive == o.alive;
+  }
+  bool operator!=(const QuantizedEntity &o) const { return !(*this == o); }
+};
+
+// A client's view of the world under interest management (see
+// InterestManager): only the live entities it's being told about, by slot
+// in ascending order. Every other slot is dead as far as the client knows.
+struct SnapshotView {
+  uint32_t slotCount = 0;  // length of the world's entity array
+  std::vector<uint32_t> slots;
+  std::vector<QuantizedEntity> states;  // parallel to slots
+};
+
+// Encodes a world's quantized entities as a bit-packed delta against a
+// baseline the receiver already has (in practice the last snapshot it
+// acknowledged), or against an empty world when there is none.
+//
+// Each slot costs one bit if it matches the baseline. Otherwise positions
+// are sent as the difference from where the baseline's velocity would have
+// carried them over `elapsed` seconds, so anything coasting costs a few
+// bits; other fields are sent as plain differences. Differences use a
+// short prefix code: 1 bit for none, 6 for up to +/-8, 11 for up to +/-128,
+// else 19. Decoding needs the same baseline and `elapsed`.
+class SnapshotCodec {
+ public:
+  static constexpr float maxSpeed = 4.0f;  // world units per second
+
+  static QuantizedEntity quantize(const Entity &e);
+  static Entity dequantize(const QuantizedEntity &q);
+  static void quantize(const std::vector<Entity> &entities, std::vector<QuantizedEntity> &out);
+  static void dequantize(const std::vector<QuantizedEntity> &state, std::vector<Entity> &out);
+
+  // Appends the encoding of `current` to `out`. `baseline` may be null.
+  static void encode(const std::vector<QuantizedEntity> &current,
+                     const std::vector<QuantizedEntity> *baseline, float elapsed,
+                     std::vector<uint8_t> &out);
+  // False if the data is truncated or malformed; `out` is then unusable.
+  static bool decode(const uint8_t *data, size_t size,
+                     const std::vector<QuantizedEntity> *baseline, float elapsed,
+                     std::vector<QuantizedEntity> &out);
+
+  // Views cost per entity in the view rather than per slot in the world:
+  // each entry is its slot's gap from the previous one (1 bit when
+  // adjacent) and then the entity as above, against the baseline view's
+  // entry for that slot if it has one. Slots missing from the view decode
+  // as dead, so the client can treat the result like a full snapshot.
+  static void encodeView(const SnapshotView &current, const SnapshotView *baseline,
+                         float elapsed, std::vector<uint8_t> &out);
+  // `baseline` is the decoded (full-width) result of the baseline view.
+  static bool decodeView(const uint8_t *data, size_t size,
+                         const std::vector<QuantizedEntity> *baseline, float elapsed,
+                         std::vector<QuantizedEntity> &out);
+  static constexpr uint32_t maxViewSlots = 1u << 24;
+
+  // Where a client predicts `q` to be after `elapsed` seconds: the same
+  // position prediction encode uses.
+  static QuantizedEntity extrapolate(const QuantizedEntity &q, float elapsed);
+};
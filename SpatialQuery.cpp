@@ -0,0 +1,227 @@
+// SpatialQuery.cpp
+#include "SpatialQuery.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+// Rays are marched in legs this long (world units), each one a box query.
+constexpr float kRayLeg = 0.1f;
+
+inline float wrapCoordinate(float v) { return v - kPeriod * std::floor((v + kBound) / kPeriod); }
+
+inline float nearestOffset(float d) { return d - kPeriod * std::round(d / kPeriod); }
+
+}  // namespace
+
+void SpatialQuery::bind(const Broadphase *bp, const std::vector<Entity> *es) {
+  broadphase = bp;
+  entities = es;
+}
+
+void SpatialQuery::gather(glm::vec2 min, glm::vec2 max, Scratch &s) const {
+  s.candidates.clear();
+  if (!entities) return;
+  if (!broadphase) {
+    for (uint32_t i = 0; i < entities->size(); i++) s.candidates.push_back(i);
+    return;
+  }
+
+  // Recentre the box inside the world, capped at one world across.
+  glm::vec2 centre = (min + max) * 0.5f, half = (max - min) * 0.5f;
+  centre = glm::vec2(wrapCoordinate(centre.x), wrapCoordinate(centre.y));
+  half = glm::min(half, glm::vec2(kBound, kBound));
+  broadphase->queryBox(centre - half, centre + half, s.candidates);
+
+  std::sort(s.candidates.begin(), s.candidates.end());
+  s.candidates.erase(std::unique(s.candidates.begin(), s.candidates.end()), s.candidates.end());
+  while (!s.candidates.empty() && s.candidates.back() >= entities->size()) s.candidates.pop_back();
+}
+
+void SpatialQuery::radiusInto(glm::vec2 centre, float radius, Scratch &s,
+                              std::vector<uint32_t> &results) const {
+  gather(centre - glm::vec2(radius, radius), centre + glm::vec2(radius, radius), s);
+  for (uint32_t j : s.candidates) {
+    const Entity &e = (*entities)[j];
+    if (e.radius < 0) continue;
+    float dx = wrappedDistance(centre.x, e.position.x, kPeriod);
+    float dy = wrappedDistance(centre.y, e.position.y, kPeriod);
+    float reach = radius + e.radius * PhysicsSystem::radiusToWorld;
+    if (dx * dx + dy * dy <= reach * reach) results.push_back(j);
+  }
+}
+
+void SpatialQuery::radius(glm::vec2 centre, float radius, std::vector<uint32_t> &results) const {
+  radiusInto(centre, radius, scratch, results);
+}
+
+void SpatialQuery::aabb(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &results) const {
+  gather(min, max, scratch);
+  const glm::vec2 centre = (min + max) * 0.5f, half = (max - min) * 0.5f;
+  for (uint32_t j : scratch.candidates) {
+    const Entity &e = (*entities)[j];
+    if (e.radius < 0) continue;
+    // Distance from the circle's centre to the box, per axis.
+    float dx = std::max(wrappedDistance(centre.x, e.position.x, kPeriod) - half.x, 0.0f);
+    float dy = std::max(wrappedDistance(centre.y, e.position.y, kPeriod) - half.y, 0.0f);
+    float r = e.radius * PhysicsSystem::radiusToWorld;
+    if (dx * dx + dy * dy <= r * r) results.push_back(j);
+  }
+}
+
+void SpatialQuery::nearestInto(glm::vec2 centre, size_t k, uint32_t exclude, Scratch &s,
+                               std::vector<uint32_t> &results) const {
+  if (!entities || k == 0) return;
+
+  // Start from the radius that would hold about k entities if they were
+  // spread evenly, and double it until k are found within it. Past
+  // kBound * sqrt(2) the circle covers the whole torus.
+  const float density = std::max<float>(entities->size(), 1.0f) / (kPeriod * kPeriod);
+  float radius = 1.5f * std::sqrt(k / (glm::pi<float>() * density));
+  const float farthest = kBound * 1.4143f;
+  for (;;) {
+    bool all = radius >= farthest;
+    gather(centre - glm::vec2(radius, radius), centre + glm::vec2(radius, radius), s);
+    s.ranked.clear();
+    for (uint32_t j : s.candidates) {
+      const Entity &e = (*entities)[j];
+      if (e.radius < 0 || j == exclude) continue;
+      float dx = wrappedDistance(centre.x, e.position.x, kPeriod);
+      float dy = wrappedDistance(centre.y, e.position.y, kPeriod);
+      float d2 = dx * dx + dy * dy;
+      if (all || d2 <= radius * radius) s.ranked.push_back({d2, j});
+    }
+    if (s.ranked.size() >= k || all) break;
+    radius *= 2.0f;
+  }
+
+  size_t found = std::min(k, s.ranked.size());
+  std::partial_sort(s.ranked.begin(), s.ranked.begin() + found, s.ranked.end());
+  for (size_t i = 0; i < found; i++) results.push_back(s.ranked[i].second);
+}
+
+void SpatialQuery::nearest(glm::vec2 centre, size_t k, std::vector<uint32_t> &results,
+                           uint32_t exclude) const {
+  nearestInto(centre, k, exclude, scratch, results);
+}
+
+bool SpatialQuery::raycastWith(glm::vec2 origin, glm::vec2 direction, float maxDistance,
+                               Scratch &s, RaycastHit &hit) const {
+  // A circle the ray enters within a leg overlaps that leg's box, so once
+  // the best hit so far lies within the legs searched it is the nearest.
+  float best = maxDistance;
+  uint32_t bestEntity = none;
+  for (float start = 0.0f; start < maxDistance; start += kRayLeg) {
+    float end = std::min(start + kRayLeg, maxDistance);
+    glm::vec2 a = origin + direction * start, b = origin + direction * end;
+    gather(glm::min(a, b), glm::max(a, b), s);
+    glm::vec2 mid = (a + b) * 0.5f;
+    for (uint32_t j : s.candidates) {
+      const Entity &e = (*entities)[j];
+      if (e.radius < 0) continue;
+      // The circle's copy nearest this leg, in the ray's unwrapped frame.
+      glm::vec2 c = mid + glm::vec2(nearestOffset(e.position.x - mid.x),
+                                    nearestOffset(e.position.y - mid.y));
+      float r = e.radius * PhysicsSystem::radiusToWorld;
+      glm::vec2 m = origin - c;
+      float bq = m.x * direction.x + m.y * direction.y;
+      float cq = m.x * m.x + m.y * m.y - r * r;
+      if (cq > 0.0f && bq > 0.0f) continue;
+      float disc = bq * bq - cq;
+      if (disc < 0.0f) continue;
+      float t = std::max(-bq - std::sqrt(disc), 0.0f);
+      if (t > best) continue;
+      if (t < best || j < bestEntity) {
+        best = t;
+        bestEntity = j;
+      }
+    }
+    if (bestEntity != none && best <= end) break;
+  }
+  if (bestEntity == none) return false;
+
+  glm::vec2 p = origin + direction * best;
+  hit.entity = bestEntity;
+  hit.distance = best;
+  hit.point = glm::vec2(wrapCoordinate(p.x), wrapCoordinate(p.y));
+  return true;
+}
+
+bool SpatialQuery::raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance,
+                           RaycastHit &hit) const {
+  return raycastWith(origin, direction, maxDistance, scratch, hit);
+}
+
+template <typename Fn>
+void SpatialQuery::forEachQuery(size_t count, JobSystem *jobs, Fn &&fn) const {
+  size_t chunkCount = (count + batchGrain - 1) / batchGrain;
+  if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+  auto run = [&](size_t begin, size_t end) {
+    Scratch &s = chunks[begin / batchGrain];
+    for (size_t q = begin; q < end; q++) fn(q, s);
+  };
+  if (jobs) {
+    jobs->parallelFor(count, batchGrain, run);
+  } else {
+    for (size_t begin = 0; begin < count; begin += batchGrain) {
+      run(begin, std::min(begin + batchGrain, count));
+    }
+  }
+}
+
+void SpatialQuery::radiusBatch(const glm::vec2 *centres, const float *radii, size_t count,
+                               std::vector<uint32_t> &results, std::vector<uint32_t> &offsets,
+                               JobSystem *jobs) const {
+  size_t chunkCount = (count + batchGrain - 1) / batchGrain;
+  if (chunks.size() < chunkCount) chunks.resize(chunkCount);
+  for (size_t c = 0; c < chunkCount; c++) {
+    chunks[c].results.clear();
+    chunks[c].counts.clear();
+  }
+  forEachQuery(count, jobs, [&](size_t q, Scratch &s) {
+    size_t before = s.results.size();
+    radiusInto(centres[q], radii[q], s, s.results);
+    s.counts.push_back((uint32_t)(s.results.size() - before));
+  });
+
+  // Stitch the chunks together in query order.
+  offsets.resize(count + 1);
+  size_t first = results.size();
+  offsets[0] = (uint32_t)first;
+  size_t q = 0;
+  for (size_t c = 0; c < chunkCount; c++) {
+    results.insert(results.end(), chunks[c].results.begin(), chunks[c].results.end());
+    for (uint32_t n : chunks[c].counts) {
+      offsets[q + 1] = offsets[q] + n;
+      q++;
+    }
+  }
+}
+
+void SpatialQuery::nearestBatch(const glm::vec2 *centres, const uint32_t *exclude, size_t count,
+                                size_t k, std::vector<uint32_t> &results, JobSystem *jobs) const {
+  size_t first = results.size();
+  results.resize(first + count * k, none);
+  forEachQuery(count, jobs, [&](size_t q, Scratch &s) {
+    s.results.clear();
+    nearestInto(centres[q], k, exclude ? exclude[q] : none, s, s.results);
+    std::copy(s.results.begin(), s.results.end(), results.begin() + first + q * k);
+  });
+}
+
+void SpatialQuery::raycastBatch(const glm::vec2 *origins, const glm::vec2 *directions,
+                                size_t count, float maxDistance, std::vector<RaycastHit> &hits,
+                                JobSystem *jobs) const {
+  hits.resize(count);
+  forEachQuery(count, jobs, [&](size_t q, Scratch &s) {
+    if (!raycastWith(origins[q], directions[q], maxDistance, s, hits[q])) {
+      hits[q] = RaycastHit{};
+      hits[q].entity = none;
+    }
+  });
+}
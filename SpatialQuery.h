@@ -0,0 +1,78 @@
+// SpatialQuery.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+#include "Broadphase.h"
+#include "JobSystem.h"
+
+// "What's near here" queries for gameplay and AI, answered from the active
+// broadphase's structure (Broadphase::queryBox) instead of scanning every
+// entity. All distances wrap on the torus. Candidates come from the
+// broadphase as of the last PhysicsSystem::update and are tested exactly
+// against current positions, so entities spawned since then aren't found.
+// With no broadphase, every entity is a candidate.
+//
+// Results are appended to caller-owned vectors; reusing them keeps queries
+// allocation-free once they've grown. Single queries share scratch space and
+// must stay on one thread; the batch variants split the queries over a job
+// system and return results in query order.
+class SpatialQuery {
+ public:
+  static constexpr uint32_t none = 0xffffffffu;
+
+  // PhysicsSystem binds its broadphase and entity array after each update.
+  void bind(const Broadphase *broadphase, const std::vector<Entity> *entities);
+
+  // Live entities whose circle overlaps the circle (world units).
+  void radius(glm::vec2 centre, float radius, std::vector<uint32_t> &results) const;
+  // Live entities whose circle overlaps the box.
+  void aabb(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &results) const;
+  // Up to k live entities nearest by centre distance, nearest first, other
+  // than `exclude`.
+  void nearest(glm::vec2 centre, size_t k, std::vector<uint32_t> &results,
+               uint32_t exclude = none) const;
+  // Nearest entity circle along the ray within maxDistance; direction must be
+  // normalized.
+  bool raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, RaycastHit &hit) const;
+
+  // Query i's results are results[offsets[i]] .. results[offsets[i + 1]].
+  void radiusBatch(const glm::vec2 *centres, const float *radii, size_t count,
+                   std::vector<uint32_t> &results, std::vector<uint32_t> &offsets,
+                   JobSystem *jobs = nullptr) const;
+  // k slots per query, nearest first, padded with none.
+  void nearestBatch(const glm::vec2 *centres, const uint32_t *exclude, size_t count, size_t k,
+                    std::vector<uint32_t> &results, JobSystem *jobs = nullptr) const;
+  // One hit per ray; entity is none for a miss.
+  void raycastBatch(const glm::vec2 *origins, const glm::vec2 *directions, size_t count,
+                    float maxDistance, std::vector<RaycastHit> &hits,
+                    JobSystem *jobs = nullptr) const;
+
+ private:
+  struct Scratch {
+    std::vector<uint32_t> candidates;
+    std::vector<std::pair<float, uint32_t>> ranked;
+    std::vector<uint32_t> results, counts;  // batch chunk output
+  };
+
+  static constexpr size_t batchGrain = 64;  // queries per job chunk
+
+  void gather(glm::vec2 min, glm::vec2 max, Scratch &s) const;
+  void radiusInto(glm::vec2 centre, float radius, Scratch &s,
+                  std::vector<uint32_t> &results) const;
+  void nearestInto(glm::vec2 centre, size_t k, uint32_t exclude, Scratch &s,
+                   std::vector<uint32_t> &results) const;
+  bool raycastWith(glm::vec2 origin, glm::vec2 direction, float maxDistance, Scratch &s,
+                   RaycastHit &hit) const;
+  // Runs fn(query, scratch) for every query, chunked over jobs.
+  template <typename Fn>
+  void forEachQuery(size_t count, JobSystem *jobs, Fn &&fn) const;
+
+  const Broadphase *broadphase = nullptr;
+  const std::vector<Entity> *entities = nullptr;
+
+  mutable Scratch scratch;
+  mutable std::vector<Scratch> chunks;  // one per batch chunk
+};
@@ -0,0 +1,158 @@
+// SpriteBatch.cpp
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <glm/gtc/type_ptr.hpp>
+
+const char *spriteVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+uniform mat4 projection;
+
+out vec2 TexCoord;
+out vec4 Tint;
+
+void main()
+{
+    gl_Position = projection * vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+    Tint = aColor;
+}
+)";
+
+const char *spriteFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec4 Tint;
+out vec4 FragColor;
+
+uniform sampler2D atlasPage;
+
+void main()
+{
+    FragColor = texture(atlasPage, TexCoord) * Tint;
+}
+)";
+
+SpriteBatch::~SpriteBatch() {
+  glDeleteBuffers(1, &VBO);
+  glDeleteBuffers(1, &IBO);
+  glDeleteVertexArrays(1, &VAO);
+  glDeleteProgram(program);
+}
+
+void SpriteBatch::init(GLuint spriteProgram, int pageCount) {
+  program = spriteProgram;
+  projLoc = glGetUniformLocation(program, "projection");
+  glUseProgram(program);
+  glUniform1i(glGetUniformLocation(program, "atlasPage"), 0);
+
+  pages.assign(pageCount, {});
+
+  glGenVertexArrays(1, &VAO);
+  glGenBuffers(1, &VBO);
+  glGenBuffers(1, &IBO);
+
+  glBindVertexArray(VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, x));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, u));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                        (void *)offsetof(Vertex, r));
+  glEnableVertexAttribArray(2);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);  // recorded in the VAO
+  glBindVertexArray(0);
+
+  ensureIndexCapacity(1024);
+}
+
+void SpriteBatch::ensureIndexCapacity(size_t quads) {
+  if (quads <= indexCapacity) return;
+  size_t capacity = indexCapacity ? indexCapacity : 1024;
+  while (capacity < quads) capacity *= 2;
+
+  // The same 0,1,2 2,3,0 pattern works for every quad, so the index buffer is
+  // static and only grows.
+  std::vector<uint32_t> indices(capacity * 6);
+  for (uint32_t q = 0; q < capacity; q++) {
+    uint32_t base = q * 4;
+    uint32_t *i = &indices[q * 6];
+    i[0] = base;
+    i[1] = base + 1;
+    i[2] = base + 2;
+    i[3] = base + 2;
+    i[4] = base + 3;
+    i[5] = base;
+  }
+  glBindVertexArray(VAO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(),
+               GL_STATIC_DRAW);
+  glBindVertexArray(0);
+  indexCapacity = capacity;
+}
+
+void SpriteBatch::add(const AtlasRegion &region, glm::vec2 position, glm::vec2 size, float angle,
+                      glm::vec4 tint) {
+  float rad = glm::radians(angle);
+  glm::vec2 axisX = glm::vec2(std::cos(rad), std::sin(rad)) * (size.x * 0.5f);
+  glm::vec2 axisY = glm::vec2(-std::sin(rad), std::cos(rad)) * (size.y * 0.5f);
+
+  uint8_t r = (uint8_t)(glm::clamp(tint.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+  uint8_t g = (uint8_t)(glm::clamp(tint.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+  uint8_t b = (uint8_t)(glm::clamp(tint.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+  uint8_t a = (uint8_t)(glm::clamp(tint.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+  // Image row 0 is at v = uvMin.y, so the top edge of the quad takes uvMin.y.
+  glm::vec2 bl = position - axisX - axisY, br = position + axisX - axisY;
+  glm::vec2 tr = position + axisX + axisY, tl = position - axisX + axisY;
+  std::vector<Vertex> &v = pages[region.page];
+  v.push_back({bl.x, bl.y, region.uvMin.x, region.uvMax.y, r, g, b, a});
+  v.push_back({br.x, br.y, region.uvMax.x, region.uvMax.y, r, g, b, a});
+  v.push_back({tr.x, tr.y, region.uvMax.x, region.uvMin.y, r, g, b, a});
+  v.push_back({tl.x, tl.y, region.uvMin.x, region.uvMin.y, r, g, b, a});
+}
+
+void SpriteBatch::flush(const glm::mat4 &projection, const std::vector<GLuint> &pageTextures) {
+  drawCalls = 0;
+  staging.clear();
+  size_t maxQuads = 0;
+  for (auto &page : pages) {
+    staging.insert(staging.end(), page.begin(), page.end());
+    maxQuads = std::max(maxQuads, page.size() / 4);
+  }
+  if (staging.empty()) return;
+  ensureIndexCapacity(maxQuads);
+
+  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBufferData(GL_ARRAY_BUFFER, staging.size() * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, staging.size() * sizeof(Vertex), staging.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glUseProgram(program);
+  glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+  glActiveTexture(GL_TEXTURE0);
+  glBindVertexArray(VAO);
+
+  // Sprites layer in submission order, so skip depth testing while drawing.
+  glDisable(GL_DEPTH_TEST);
+  GLint baseVertex = 0;
+  for (size_t p = 0; p < pages.size(); p++) {
+    if (!pages[p].empty()) {
+      glBindTexture(GL_TEXTURE_2D, pageTextures[p]);
+      glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(pages[p].size() / 4 * 6), GL_UNSIGNED_INT,
+                               nullptr, baseVertex);
+      drawCalls++;
+    }
+    baseVertex += (GLint)pages[p].size();
+    pages[p].clear();
+  }
+  glEnable(GL_DEPTH_TEST);
+  glBindVertexArray(0);
+}
@@ -0,0 +1,50 @@
+// SpriteBatch.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "TextureAtlas.h"
+#include "glad/glad.h"
+
+// Collects textured quads with atlas UVs and draws them with one draw call per
+// atlas page. All pages share a single dynamic vertex buffer that is orphaned
+// and refilled on every flush.
+class SpriteBatch {
+ public:
+  SpriteBatch() = default;
+  ~SpriteBatch();
+
+  // Takes ownership of the sprite shader program (see spriteVertexShaderSource).
+  void init(GLuint program, int pageCount);
+
+  // position/size in world units, angle in degrees (same convention as Entity).
+  void add(const AtlasRegion &region, glm::vec2 position, glm::vec2 size, float angle,
+           glm::vec4 tint);
+
+  // Draws everything queued since the last flush and clears the batch.
+  void flush(const glm::mat4 &projection, const std::vector<GLuint> &pageTextures);
+
+  int lastDrawCalls() const { return drawCalls; }
+
+ private:
+  struct Vertex {
+    float x, y;
+    float u, v;
+    uint8_t r, g, b, a;
+  };
+
+  void ensureIndexCapacity(size_t quads);
+
+  GLuint program = 0;
+  GLuint projLoc = 0;
+  GLuint VAO = 0, VBO = 0, IBO = 0;
+  size_t indexCapacity = 0;  // in quads
+
+  std::vector<std::vector<Vertex>> pages;  // queued vertices per atlas page
+  std::vector<Vertex> staging;             // pages concatenated for upload
+  int drawCalls = 0;
+};
+
+extern const char *spriteVertexShaderSource;
+extern const char *spriteFragmentShaderSource;
@@ -0,0 +1,297 @@
+// StateHasher.cpp
+#include "StateHasher.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define WHISKERS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#define WHISKERS_TARGET_AVX2
+#else
+#define WHISKERS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static_assert(sizeof(Entity) == 9 * sizeof(float), "entities are hashed as raw bytes; no padding");
+
+namespace {
+
+constexpr uint64_t kPrime32_1 = 0x9E3779B1u;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+constexpr size_t kStripeBytes = 64;
+// Stripe s uses key words s % 16 .. s % 16 + 7; after every 16 stripes the
+// lanes are scrambled with words 16..23.
+constexpr size_t kStripesPerBlock = 16;
+
+struct Secret {
+  uint64_t w[kStripesPerBlock + 8];
+};
+
+constexpr Secret makeSecret() {
+  Secret s{};
+  uint64_t x = 0x5748534B45525331ull;  // SplitMix64 stream
+  for (uint64_t &w : s.w) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    w = z ^ (z >> 31);
+  }
+  return s;
+}
+
+constexpr Secret kSecret = makeSecret();
+
+inline uint64_t read64(const uint8_t *p) {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+// Per lane i: acc[i] += d[i ^ 1] + lo32(d[i] ^ key[i]) * hi32(d[i] ^ key[i]).
+inline void stripeScalar(uint64_t acc[8], const uint8_t *p, const uint64_t *key) {
+  uint64_t d[8];
+  for (int i = 0; i < 8; i++) d[i] = read64(p + 8 * i);
+  for (int i = 0; i < 8; i++) {
+    uint64_t dk = d[i] ^ key[i];
+    acc[i] += d[i ^ 1] + (dk & 0xffffffffu) * (dk >> 32);
+  }
+}
+
+inline void scrambleScalar(uint64_t acc[8], const uint64_t *key) {
+  for (int i = 0; i < 8; i++) {
+    uint64_t a = acc[i];
+    a ^= a >> 47;
+    a ^= key[i];
+    acc[i] = a * kPrime32_1;
+  }
+}
+
+void accumulateScalar(uint64_t acc[8], const uint8_t *p, size_t stripes) {
+  for (size_t s = 0; s < stripes; s++, p += kStripeBytes) {
+    size_t k = s % kStripesPerBlock;
+    stripeScalar(acc, p, kSecret.w + k);
+    if (k == kStripesPerBlock - 1) scrambleScalar(acc, kSecret.w + kStripesPerBlock);
+  }
+}
+
+#ifdef WHISKERS_X86
+
+void accumulateSSE2(uint64_t acc[8], const uint8_t *p, size_t stripes) {
+  __m128i a[4];
+  for (int j = 0; j < 4; j++) a[j] = _mm_loadu_si128((const __m128i *)(acc + 2 * j));
+  const __m128i prime = _mm_set1_epi64x((long long)kPrime32_1);
+  for (size_t s = 0; s < stripes; s++, p += kStripeBytes) {
+    size_t k = s % kStripesPerBlock;
+    const uint64_t *key = kSecret.w + k;
+    for (int j = 0; j < 4; j++) {
+      __m128i d = _mm_loadu_si128((const __m128i *)(p + 16 * j));
+      __m128i dk = _mm_xor_si128(d, _mm_loadu_si128((const __m128i *)(key + 2 * j)));
+      __m128i product = _mm_mul_epu32(dk, _mm_srli_epi64(dk, 32));
+      __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+      a[j] = _mm_add_epi64(a[j], _mm_add_epi64(swapped, product));
+    }
+    if (k == kStripesPerBlock - 1) {
+      for (int j = 0; j < 4; j++) {
+        __m128i v = _mm_xor_si128(a[j], _mm_srli_epi64(a[j], 47));
+        v = _mm_xor_si128(v, _mm_loadu_si128((const __m128i *)(kSecret.w + 16 + 2 * j)));
+        __m128i lo = _mm_mul_epu32(v, prime);
+        __m128i hi = _mm_mul_epu32(_mm_srli_epi64(v, 32), prime);
+        a[j] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+      }
+    }
+  }
+  for (int j = 0; j < 4; j++) _mm_storeu_si128((__m128i *)(acc + 2 * j), a[j]);
+}
+
+WHISKERS_TARGET_AVX2
+void accumulateAVX2(uint64_t acc[8], const uint8_t *p, size_t stripes) {
+  __m256i a[2];
+  for (int j = 0; j < 2; j++) a[j] = _mm256_loadu_si256((const __m256i *)(acc + 4 * j));
+  const __m256i prime = _mm256_set1_epi64x((long long)kPrime32_1);
+  for (size_t s = 0; s < stripes; s++, p += kStripeBytes) {
+    size_t k = s % kStripesPerBlock;
+    const uint64_t *key = kSecret.w + k;
+    for (int j = 0; j < 2; j++) {
+      __m256i d = _mm256_loadu_si256((const __m256i *)(p + 32 * j));
+      __m256i dk = _mm256_xor_si256(d, _mm256_loadu_si256((const __m256i *)(key + 4 * j)));
+      __m256i product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+      __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+      a[j] = _mm256_add_epi64(a[j], _mm256_add_epi64(swapped, product));
+    }
+    if (k == kStripesPerBlock - 1) {
+      for (int j = 0; j < 2; j++) {
+        __m256i v = _mm256_xor_si256(a[j], _mm256_srli_epi64(a[j], 47));
+        v = _mm256_xor_si256(v, _mm256_loadu_si256((const __m256i *)(kSecret.w + 16 + 4 * j)));
+        __m256i lo = _mm256_mul_epu32(v, prime);
+        __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(v, 32), prime);
+        a[j] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+      }
+    }
+  }
+  for (int j = 0; j < 2; j++) _mm256_storeu_si256((__m256i *)(acc + 4 * j), a[j]);
+}
+
+#endif  // WHISKERS_X86
+
+// Low and high halves of the 128-bit product, xored.
+uint64_t mulFold(uint64_t a, uint64_t b) {
+  uint64_t ll = (a & 0xffffffffu) * (b & 0xffffffffu);
+  uint64_t lh = (a & 0xffffffffu) * (b >> 32);
+  uint64_t hl = (a >> 32) * (b & 0xffffffffu);
+  uint64_t hh = (a >> 32) * (b >> 32);
+  uint64_t cross = (ll >> 32) + (hl & 0xffffffffu) + lh;
+  uint64_t upper = (hl >> 32) + (cross >> 32) + hh;
+  uint64_t lower = (cross << 32) | (ll & 0xffffffffu);
+  return lower ^ upper;
+}
+
+// A whole word of hex digits that fits in 64 bits.
+bool parseHex(const std::string &word, uint64_t &value) {
+  if (!std::isxdigit((unsigned char)word[0])) return false;  // strtoull would take a sign
+  char *end = nullptr;
+  errno = 0;
+  value = std::strtoull(word.c_str(), &end, 16);
+  return errno == 0 && *end == '\0';
+}
+
+// False for anything that isn't a tick and hex hashes, so a damaged line
+// is skipped rather than throwing out of findDivergence.
+bool parseLine(const std::string &line, uint32_t &tick, uint64_t &hash,
+               std::vector<uint64_t> &blocks) {
+  std::istringstream in(line);
+  std::string word;
+  if (!(in >> tick >> word) || !parseHex(word, hash)) return false;
+  blocks.clear();
+  uint64_t block;
+  while (in >> word) {
+    if (!parseHex(word, block)) return false;
+    blocks.push_back(block);
+  }
+  return true;
+}
+
+}  // namespace
+
+StateHasher::StateHasher() : simd(Narrowphase::bestSimd()) {}
+
+void StateHasher::setSimd(Narrowphase::Simd level) {
+  simd = std::min(level, Narrowphase::bestSimd());
+}
+
+uint64_t StateHasher::hashBytes(const void *data, size_t size) const {
+  uint64_t acc[8] = {kPrime32_1,          kPrime64_1,          0xC2B2AE3D27D4EB4Full,
+                     0x165667B19E3779F9ull, 0x85EBCA77C2B2AE63ull, 0x85EBCA77u,
+                     0x27D4EB2F165667C5ull, 0x9E3779B1u};
+  const uint8_t *p = (const uint8_t *)data;
+  size_t stripes = size / kStripeBytes;
+  switch (simd) {
+#ifdef WHISKERS_X86
+    case Narrowphase::Simd::AVX2:
+      accumulateAVX2(acc, p, stripes);
+      break;
+    case Narrowphase::Simd::SSE2:
+      accumulateSSE2(acc, p, stripes);
+      break;
+#endif
+    default:
+      accumulateScalar(acc, p, stripes);
+      break;
+  }
+  size_t rest = size - stripes * kStripeBytes;
+  if (rest > 0) {
+    uint8_t last[kStripeBytes] = {};
+    std::memcpy(last, p + stripes * kStripeBytes, rest);
+    stripeScalar(acc, last, kSecret.w + stripes % kStripesPerBlock);
+  }
+
+  uint64_t h = size * kPrime64_1;
+  for (int i = 0; i < 4; i++) {
+    h += mulFold(acc[2 * i] ^ kSecret.w[2 * i + 1], acc[2 * i + 1] ^ kSecret.w[2 * i + 2]);
+  }
+  h ^= h >> 37;
+  h *= 0x165667919E3779F9ull;
+  return h ^ (h >> 32);
+}
+
+uint64_t StateHasher::update(uint32_t tick, const std::vector<Entity> &entities) {
+  const size_t blocks = (entities.size() + blockEntities - 1) / blockEntities;
+  blockHashes.resize(blocks);
+  for (size_t b = 0; b < blocks; b++) {
+    size_t first = b * blockEntities;
+    size_t count = std::min(blockEntities, entities.size() - first);
+    blockHashes[b] = hashBytes(entities.data() + first, count * sizeof(Entity));
+  }
+  lastTick = tick;
+  tickHash = hashBytes(blockHashes.data(), blocks * sizeof(uint64_t));
+
+  if (log) {
+    char word[24];
+    std::snprintf(word, sizeof(word), "%016llx", (unsigned long long)tickHash);
+    *log << tick << ' ' << word;
+    if (logBlocks) {
+      for (uint64_t h : blockHashes) {
+        std::snprintf(word, sizeof(word), " %016llx", (unsigned long long)h);
+        *log << word;
+      }
+    }
+    *log << '\n';
+  }
+  return tickHash;
+}
+
+bool StateHasher::findDivergence(std::istream &a, std::istream &b, Divergence &out) {
+  std::string lineA, lineB;
+  uint32_t tickA = 0, tickB = 0;
+  uint64_t hashA = 0, hashB = 0;
+  std::vector<uint64_t> blocksA, blocksB;
+  bool haveA = false, haveB = false;
+  for (;;) {
+    if (!haveA) {
+      if (!std::getline(a, lineA)) return false;
+      haveA = parseLine(lineA, tickA, hashA, blocksA);
+      continue;
+    }
+    if (!haveB) {
+      if (!std::getline(b, lineB)) return false;
+      haveB = parseLine(lineB, tickB, hashB, blocksB);
+      continue;
+    }
+    // Logs may start at different ticks; skip ahead on the one behind.
+    if (tickA != tickB) {
+      (tickA < tickB ? haveA : haveB) = false;
+      continue;
+    }
+    if (hashA != hashB) break;
+    haveA = haveB = false;
+  }
+
+  out.tick = tickA;
+  out.firstEntity = 0;
+  out.entityCount = 0;
+  if (blocksA.empty() || blocksB.empty()) return true;
+  size_t common = std::min(blocksA.size(), blocksB.size());
+  size_t block = 0;
+  while (block < common && blocksA[block] == blocksB[block]) block++;
+  out.firstEntity = block * blockEntities;
+  out.entityCount = blockEntities;
+  return true;
+}
+
+size_t StateHasher::firstDifferentEntity(const std::vector<Entity> &a,
+                                         const std::vector<Entity> &b) {
+  size_t common = std::min(a.size(), b.size());
+  for (size_t i = 0; i < common; i++) {
+    if (std::memcmp(&a[i], &b[i], sizeof(Entity)) != 0) return i;
+  }
+  return a.size() == b.size() ? SIZE_MAX : common;
+}
@@ -0,0 +1,72 @@
+// StateHasher.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "Entity.h"
+#include "Narrowphase.h"  // Narrowphase::Simd
+
+// Per-tick hash of the entity array for desync detection in lockstep and
+// replays. Entities are hashed as raw bytes, so anything short of a bit-for-
+// bit match shows up. Each block of blockEntities entities gets its own hash
+// and the tick hash is the hash of those, so when two runs' tick hashes
+// differ, comparing block hashes narrows it down to a few entities.
+//
+// The hash is XXH3-style: eight 64-bit lanes take 64-byte stripes, each a
+// 32x32->64 multiply and an add, which vectorizes (4 lanes per AVX2
+// instruction, 2 per SSE2) and runs close to memory speed. Every path gives
+// the same value, so runs on different machines compare directly (on
+// little-endian CPUs; the raw bytes are hashed as they lie).
+class StateHasher {
+ public:
+  static constexpr size_t blockEntities = 64;
+
+  // Where two runs' logs first disagree: the tick, and which entities when
+  // both logs have block hashes (entityCount is 0 when they don't).
+  struct Divergence {
+    uint32_t tick = 0;
+    size_t firstEntity = 0;
+    size_t entityCount = 0;
+  };
+
+  StateHasher();
+
+  // Hashes `entities` as the state at `tick`, writes the log line if a log
+  // is set, and returns the tick hash.
+  uint64_t update(uint32_t tick, const std::vector<Entity> &entities);
+  uint64_t getHash() const { return tickHash; }
+  uint32_t getTick() const { return lastTick; }
+  const std::vector<uint64_t> &getBlockHashes() const { return blockHashes; }
+
+  // Each update appends "tick hash" in hex, followed by the block hashes if
+  // `blocks` (about 16 bytes of log per 64 entities). Not owned.
+  void setLog(std::ostream *out, bool blocks = false) {
+    log = out;
+    logBlocks = blocks;
+  }
+
+  // Best level the CPU supports is picked at construction; every level
+  // gives the same hashes.
+  void setSimd(Narrowphase::Simd level);
+  Narrowphase::Simd getSimd() const { return simd; }
+
+  uint64_t hashBytes(const void *data, size_t size) const;
+
+  // Reads two logs written by setLog and finds the first tick both have
+  // whose hashes differ. False if they agree everywhere they overlap.
+  // Lines that don't parse (a torn last write, say) are skipped.
+  static bool findDivergence(std::istream &a, std::istream &b, Divergence &out);
+  // First entity whose bytes differ, the array length if one array is a
+  // prefix of the other, or SIZE_MAX if they're identical.
+  static size_t firstDifferentEntity(const std::vector<Entity> &a, const std::vector<Entity> &b);
+
+ private:
+  Narrowphase::Simd simd = Narrowphase::Simd::Scalar;
+  uint32_t lastTick = 0;
+  uint64_t tickHash = 0;
+  std::vector<uint64_t> blockHashes;
+  std::ostream *log = nullptr;
+  bool logBlocks = false;
+};
@@ -0,0 +1,168 @@
+// SweepAndPruneBroadphase.cpp
+#include "SweepAndPruneBroadphase.h"
+
+#include <algorithm>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+// Marks proxies from the right strip in the seam sweep (ids stay < 2^31).
+constexpr uint32_t kShifted = 0x80000000u;
+
+// Endpoints are padded so the sweep never rejects a pair that the exact
+// centre-distance test (shared with the other broadphases) would accept.
+constexpr float kSlop = 1e-5f;
+
+
+inline BroadphasePair makePair(uint32_t a, uint32_t b) {
+  return a < b ? BroadphasePair{a, b} : BroadphasePair{b, a};
+}
+
+}  // namespace
+
+void SweepAndPruneBroadphase::sync(const std::vector<Entity> &entities) {
+  if (entities.size() < inSet.size()) reset();  // array was compacted
+  inSet.resize(entities.size(), 0);
+
+  // Refresh endpoints in the existing order and drop entities that died.
+  maxRadius = 0.0f;
+  size_t kept = 0;
+  for (size_t i = 0; i < proxies.size(); i++) {
+    const Entity &e = entities[proxies[i].id];
+    if (e.radius < 0) {
+      inSet[proxies[i].id] = 0;
+      continue;
+    }
+    ProxyCircle c = proxyCircle(e);
+    float r = c.radius;
+    proxies[kept++] = {c.centre.x - r - kSlop, c.centre.x + r + kSlop, c.centre.x, c.centre.y, r,
+                       proxies[i].id};
+    maxRadius = std::max(maxRadius, r);
+  }
+  proxies.resize(kept);
+
+  // Nearly sorted after one frame of motion, so this is close to O(n).
+  for (size_t i = 1; i < proxies.size(); i++) {
+    Proxy p = proxies[i];
+    size_t j = i;
+    while (j > 0 && proxies[j - 1].minX > p.minX) {
+      proxies[j] = proxies[j - 1];
+      j--;
+    }
+    proxies[j] = p;
+  }
+
+  // New (or revived) entities arrive in no particular order, possibly
+  // hundreds at once, so they're sorted on their own and merged in.
+  for (size_t i = 0; i < entities.size(); i++) {
+    const Entity &e = entities[i];
+    if (e.radius < 0 || inSet[i]) continue;
+    inSet[i] = 1;
+    ProxyCircle c = proxyCircle(e);
+    float r = c.radius;
+    proxies.push_back(
+        {c.centre.x - r - kSlop, c.centre.x + r + kSlop, c.centre.x, c.centre.y, r, (uint32_t)i});
+    maxRadius = std::max(maxRadius, r);
+  }
+  if (proxies.size() > kept) {
+    auto byMinX = [](const Proxy &a, const Proxy &b) { return a.minX < b.minX; };
+    std::sort(proxies.begin() + kept, proxies.end(), byMinX);
+    std::inplace_merge(proxies.begin(), proxies.begin() + kept, proxies.end(), byMinX);
+  }
+}
+
+void SweepAndPruneBroadphase::findPairs(const std::vector<Entity> &entities,
+                                        std::vector<BroadphasePair> &pairs) {
+  pairs.clear();
+  sync(entities);
+
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  const size_t n = proxies.size();
+  for (size_t i = 0; i < n; i++) {
+    const Proxy &a = proxies[i];
+    for (size_t j = i + 1; j < n && proxies[j].minX <= a.maxX; j++) {
+      const Proxy &b = proxies[j];
+      float reach = a.r + b.r;
+      if (wrappedDistance(a.y, b.y, period) <= reach &&
+          wrappedDistance(a.x, b.x, period) <= reach) {
+        pairs.push_back(makePair(a.id, b.id));
+      }
+    }
+  }
+
+  sweepSeam(pairs);
+}
+
+// Pairs that only overlap across the x seam: a near the right edge and b near
+// the left edge with a.maxX - period >= b.minX. Any such b has
+// minX <= -bound + maxRadius and any such a has maxX >= bound - maxRadius.
+void SweepAndPruneBroadphase::sweepSeam(std::vector<BroadphasePair> &pairs) {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+
+  leftStrip.clear();
+  for (const Proxy &p : proxies) {
+    if (p.minX > -bound + maxRadius) break;
+    leftStrip.push_back(p);
+  }
+  if (leftStrip.empty()) return;
+
+  // Right-strip members have minX >= bound - 3 * maxRadius (less the slop on
+  // both ends); scan back from the end.
+  rightStrip.clear();
+  for (size_t i = proxies.size(); i-- > 0;) {
+    const Proxy &p = proxies[i];
+    if (p.minX < bound - 3.0f * maxRadius - 2.0f * kSlop) break;
+    if (p.maxX >= bound - maxRadius) {
+      // x stays unshifted so the exact test matches the main sweep bit for bit.
+      rightStrip.push_back({p.minX - period, p.maxX - period, p.x, p.y, p.r, p.id | kShifted});
+    }
+  }
+  if (rightStrip.empty()) return;
+  std::reverse(rightStrip.begin(), rightStrip.end());
+
+  seam.resize(leftStrip.size() + rightStrip.size());
+  std::merge(leftStrip.begin(), leftStrip.end(), rightStrip.begin(), rightStrip.end(),
+             seam.begin(), [](const Proxy &a, const Proxy &b) { return a.minX < b.minX; });
+
+  for (size_t i = 0; i < seam.size(); i++) {
+    const Proxy &a = seam[i];
+    for (size_t j = i + 1; j < seam.size() && seam[j].minX <= a.maxX; j++) {
+      const Proxy &b = seam[j];
+      if ((a.id & kShifted) == (b.id & kShifted)) continue;  // same side: main sweep has it
+      uint32_t idA = a.id & ~kShifted, idB = b.id & ~kShifted;
+      float reach = a.r + b.r;
+      if (idA != idB && wrappedDistance(a.y, b.y, period) <= reach &&
+          wrappedDistance(a.x, b.x, period) <= reach) {
+        pairs.push_back(makePair(idA, idB));
+      }
+    }
+  }
+}
+
+void SweepAndPruneBroadphase::queryBox(glm::vec2 min, glm::vec2 max,
+                                       std::vector<uint32_t> &candidates) const {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  const float centreY = 0.5f * (min.y + max.y), halfY = 0.5f * (max.y - min.y);
+  // A proxy's maxX is at most this far past its minX.
+  const float span = 2.0f * (maxRadius + kSlop);
+
+  // The box itself, plus its image on the far side of any x edge that it, or
+  // a proxy overlapping it across the seam, hangs over.
+  float shifts[3] = {0.0f, 0.0f, 0.0f};
+  int images = 1;
+  if (max.x + span > bound) shifts[images++] = -period;
+  if (min.x - span < -bound) shifts[images++] = period;
+  for (int k = 0; k < images; k++) {
+    float lo = min.x + shifts[k], hi = max.x + shifts[k];
+    auto first = std::lower_bound(proxies.begin(), proxies.end(), lo - span,
+                                  [](const Proxy &p, float v) { return p.minX < v; });
+    for (auto it = first; it != proxies.end() && it->minX <= hi; ++it) {
+      if (it->maxX < lo) continue;
+      if (halfY < bound && wrappedDistance(it->y, centreY, period) > halfY + it->r) continue;
+      candidates.push_back(it->id);
+    }
+  }
+}
@@ -0,0 +1,35 @@
+// SweepAndPruneBroadphase.h
+#pragma once
+#include "Broadphase.h"
+
+// Sweep-and-prune along x. Proxies stay sorted by their min-x endpoint between
+// calls, and since entities move a little each frame the insertion sort that
+// restores the order is close to linear. Overlaps across the x wrap seam are
+// found by a second sweep over the two edge strips with the right strip
+// shifted one world width to the left; y wrap is handled by testing y with
+// the minimum-image distance.
+class SweepAndPruneBroadphase : public Broadphase {
+ public:
+  void findPairs(const std::vector<Entity> &entities, std::vector<BroadphasePair> &pairs) override;
+  void reset() override {
+    proxies.clear();
+    inSet.clear();
+  }
+  const char *name() const override { return "sap"; }
+  void queryBox(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &candidates) const override;
+
+ private:
+  struct Proxy {
+    float minX, maxX, x, y, r;
+    uint32_t id;
+  };
+
+  void sync(const std::vector<Entity> &entities);
+  void sweepSeam(std::vector<BroadphasePair> &pairs);
+
+  std::vector<Proxy> proxies;  // sorted by minX, persists across calls
+  std::vector<uint8_t> inSet;  // per entity: has a proxy (live when last seen)
+  float maxRadius = 0.0f;
+
+  std::vector<Proxy> leftStrip, rightStrip, seam;
+};
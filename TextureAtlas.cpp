@@ -0,0 +1,58 @@
+// TextureAtlas.cpp
+#include "TextureAtlas.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool TextureAtlas::load(const std::string &manifestPath) {
+  std::ifstream file(manifestPath);
+  if (!file) {
+    std::cerr << "Failed to open atlas: " << manifestPath << "\n";
+    return false;
+  }
+
+  std::string dir;
+  size_t slash = manifestPath.find_last_of("/\\");
+  if (slash != std::string::npos) dir = manifestPath.substr(0, slash + 1);
+
+  std::vector<glm::ivec2> pageSizes;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream in(line);
+    std::string kind;
+    in >> kind;
+    if (kind == "page") {
+      int index;
+      std::string name;
+      glm::ivec2 size;
+      in >> index >> name >> size.x >> size.y;
+      if (!in || index != (int)pages.size()) {
+        std::cerr << "Bad atlas page line: " << line << "\n";
+        return false;
+      }
+      pages.push_back(dir + name);
+      pageSizes.push_back(size);
+    } else if (kind == "sprite") {
+      std::string name;
+      AtlasRegion r;
+      int x, y;
+      in >> name >> r.page >> x >> y >> r.pixelSize.x >> r.pixelSize.y;
+      if (!in || r.page < 0 || r.page >= (int)pages.size()) {
+        std::cerr << "Bad atlas sprite line: " << line << "\n";
+        return false;
+      }
+      glm::vec2 pageSize(pageSizes[r.page]);
+      r.uvMin = glm::vec2((float)x, (float)y) / pageSize;
+      r.uvMax = glm::vec2((float)(x + r.pixelSize.x), (float)(y + r.pixelSize.y)) / pageSize;
+      names[name] = (int)regions.size();
+      regions.push_back(r);
+    }
+  }
+  return true;
+}
+
+int TextureAtlas::find(const std::string &name) const {
+  auto it = names.find(name);
+  return it == names.end() ? -1 : it->second;
+}
@@ -0,0 +1,36 @@
+// TextureAtlas.h
+#pragma once
+#include <glm/glm.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sprite regions packed by whiskers_atlaspack. The .atlas manifest is plain text:
+//
+//   page <index> <file> <width> <height>
+//   sprite <name> <page> <x> <y> <width> <height>
+//
+// Page files are relative to the manifest; pixel rects have their origin at the
+// top-left of the page image.
+struct AtlasRegion {
+  int page = 0;
+  glm::vec2 uvMin{0.0f, 0.0f};
+  glm::vec2 uvMax{1.0f, 1.0f};
+  glm::ivec2 pixelSize{0, 0};
+};
+
+class TextureAtlas {
+ public:
+  bool load(const std::string &manifestPath);
+
+  // Index of a sprite by name, or -1.
+  int find(const std::string &name) const;
+  int size() const { return (int)regions.size(); }
+  const AtlasRegion &region(int sprite) const { return regions[sprite]; }
+  const std::vector<std::string> &pageFiles() const { return pages; }
+
+ private:
+  std::vector<std::string> pages;
+  std::vector<AtlasRegion> regions;
+  std::unordered_map<std::string, int> names;
+};
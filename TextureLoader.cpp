@@ -0,0 +1,193 @@
+// TextureLoader.cpp
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+TextureLoader::~TextureLoader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  if (worker.joinable()) worker.join();
+
+  for (Decoded &d : decoded) stbi_image_free(d.pixels);
+  for (Slot &slot : slots) glDeleteTextures(1, &slot.texture);
+  glDeleteTextures(1, &placeholder);
+  glDeleteBuffers(2, pbos);
+}
+
+void TextureLoader::init() {
+  // 1x1 neutral grey shown until the real image arrives.
+  const unsigned char grey[4] = {128, 128, 128, 255};
+  glGenTextures(1, &placeholder);
+  glBindTexture(GL_TEXTURE_2D, placeholder);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenBuffers(2, pbos);
+
+  worker = std::thread(&TextureLoader::workerLoop, this);
+}
+
+size_t TextureLoader::request(const std::string &filepath) {
+  size_t id = slots.size();
+  slots.emplace_back();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.emplace_back(id, filepath);
+    inFlight++;
+  }
+  wake.notify_one();
+  return id;
+}
+
+// Path of the baked sibling if it exists and is at least as new as the source.
+static std::string findBakedTexture(const std::string &filepath) {
+  namespace fs = std::filesystem;
+  fs::path baked = fs::path(filepath).replace_extension(".wtex");
+  std::error_code ec;
+  auto bakedTime = fs::last_write_time(baked, ec);
+  if (ec) return {};
+  auto sourceTime = fs::last_write_time(filepath, ec);
+  if (!ec && sourceTime > bakedTime) return {};  // stale bake, use the source image
+  return baked.string();
+}
+
+void TextureLoader::workerLoop() {
+  for (;;) {
+    std::pair<size_t, std::string> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return stopping || !pending.empty(); });
+      if (stopping) return;
+      job = std::move(pending.front());
+      pending.pop_front();
+    }
+
+    Decoded d;
+    d.id = job.first;
+    d.filepath = std::move(job.second);
+    std::string bakedPath = findBakedTexture(d.filepath);
+    if (!bakedPath.empty()) {
+      d.baked = std::make_unique<BakedTexture>();
+      if (d.baked->open(bakedPath)) {
+        d.filepath = bakedPath;
+      } else {
+        d.baked.reset();
+      }
+    }
+    if (!d.baked) d.pixels = stbi_load(d.filepath.c_str(), &d.width, &d.height, &d.channels, 0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decoded.push_back(std::move(d));
+  }
+}
+
+void TextureLoader::pump(size_t budgetBytes) {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!decoded.empty() && budgetBytes > 0) {
+    Decoded &d = decoded.front();
+    lock.unlock();
+
+    if (d.baked) {
+      if (!uploadBakedLevels(d, budgetBytes)) return;  // continue next frame
+      finishUpload(d);
+    } else if (d.pixels) {
+      if (!uploadRows(d, budgetBytes)) return;  // continue next frame
+      glBindTexture(GL_TEXTURE_2D, slots[d.id].texture);
+      glGenerateMipmap(GL_TEXTURE_2D);
+      finishUpload(d);
+    } else {
+      std::cout << "Failed to load texture: " << d.filepath << std::endl;
+    }
+
+    stbi_image_free(d.pixels);
+    lock.lock();
+    decoded.pop_front();
+    inFlight--;
+  }
+}
+
+bool TextureLoader::uploadRows(Decoded &d, size_t &budgetBytes) {
+  GLenum format = (d.channels == 4) ? GL_RGBA : GL_RGB;
+  GLenum internalFormat = (d.channels == 4) ? GL_RGBA8 : GL_RGB8;
+  Slot &slot = slots[d.id];
+  if (d.rowsUploaded == 0) {
+    glGenTextures(1, &slot.texture);
+    glBindTexture(GL_TEXTURE_2D, slot.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, d.width, d.height, 0, format, GL_UNSIGNED_BYTE,
+                 nullptr);
+  }
+
+  // Copy a band of rows into an orphaned PBO and let the driver DMA it.
+  size_t rowBytes = (size_t)d.width * d.channels;
+  int rows = (int)std::max<size_t>(1, budgetBytes / rowBytes);
+  rows = std::min(rows, d.height - d.rowsUploaded);
+  size_t bytes = rowBytes * rows;
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+  nextPbo = (nextPbo + 1) % 2;
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+  void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  const void *src = nullptr;  // offset into the bound PBO
+  if (dst) {
+    std::memcpy(dst, d.pixels + rowBytes * d.rowsUploaded, bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  } else {
+    // Mapping failed; fall back to a plain client-memory upload.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    src = d.pixels + rowBytes * d.rowsUploaded;
+  }
+  glBindTexture(GL_TEXTURE_2D, slot.texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, d.rowsUploaded, d.width, rows, format, GL_UNSIGNED_BYTE,
+                  src);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  d.rowsUploaded += rows;
+  budgetBytes -= std::min(budgetBytes, bytes);
+  return d.rowsUploaded == d.height;
+}
+
+bool TextureLoader::uploadBakedLevels(Decoded &d, size_t &budgetBytes) {
+  Slot &slot = slots[d.id];
+  if (d.levelsUploaded == 0) {
+    glGenTextures(1, &slot.texture);
+    glBindTexture(GL_TEXTURE_2D, slot.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, d.baked->mipCount() - 1);
+  }
+
+  // Levels are already RGBA8 in upload layout: hand the mapped pages straight
+  // to the driver, whole levels at a time.
+  glBindTexture(GL_TEXTURE_2D, slot.texture);
+  while (d.levelsUploaded < d.baked->mipCount() && budgetBytes > 0) {
+    const BakedMipLevel &level = d.baked->level(d.levelsUploaded);
+    glTexImage2D(GL_TEXTURE_2D, d.levelsUploaded, GL_RGBA8, level.width, level.height, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, d.baked->levelData(d.levelsUploaded));
+    budgetBytes -= std::min<size_t>(budgetBytes, level.size);
+    d.levelsUploaded++;
+  }
+  return d.levelsUploaded == d.baked->mipCount();
+}
+
+void TextureLoader::finishUpload(Decoded &d) {
+  glBindTexture(GL_TEXTURE_2D, 0);
+  slots[d.id].ready = true;
+  std::cout << "Loaded texture: " << d.filepath << std::endl;
+}
+
+bool TextureLoader::idle() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return inFlight == 0;
+}
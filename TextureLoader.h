@@ -0,0 +1,78 @@
+// TextureLoader.h
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BakedTexture.h"
+#include "glad/glad.h"
+
+// Asynchronous texture loading. Images are decoded with stb_image on a worker
+// thread and uploaded on the GL thread through pixel buffer objects, a few rows
+// per frame, so loading never blocks the first frame. Until a texture is fully
+// uploaded, get() returns a placeholder.
+//
+// If an up-to-date baked sibling exists (foo.wtex next to foo.png, see
+// whiskers_texbake), it is memory-mapped instead and its mip levels are
+// uploaded straight from the mapping with no decode.
+class TextureLoader {
+ public:
+  TextureLoader() = default;
+  ~TextureLoader();
+
+  // Creates the placeholder and upload buffers and starts the decode thread.
+  // Requires a current GL context.
+  void init();
+
+  // Queues a file for loading and returns an id for get().
+  size_t request(const std::string &filepath);
+
+  // Current texture for an id: the placeholder until the upload finishes.
+  GLuint get(size_t id) const { return slots[id].ready ? slots[id].texture : placeholder; }
+
+  // Call once per frame on the GL thread; uploads at most budgetBytes of pixels.
+  void pump(size_t budgetBytes = 4 << 20);
+
+  // True once every requested texture has been uploaded (or failed).
+  bool idle();
+
+ private:
+  struct Slot {
+    GLuint texture = 0;
+    bool ready = false;
+  };
+
+  struct Decoded {
+    size_t id = 0;
+    std::string filepath;
+    unsigned char *pixels = nullptr;  // stbi-owned, nullptr if decoding failed
+    int width = 0, height = 0, channels = 0;
+    int rowsUploaded = 0;
+    std::unique_ptr<BakedTexture> baked;  // set instead of pixels for .wtex files
+    uint32_t levelsUploaded = 0;
+  };
+
+  void workerLoop();
+  bool uploadRows(Decoded &d, size_t &budgetBytes);
+  bool uploadBakedLevels(Decoded &d, size_t &budgetBytes);
+  void finishUpload(Decoded &d);
+
+  std::vector<Slot> slots;
+  GLuint placeholder = 0;
+
+  // Two PBOs used round-robin so mapping one never waits on the transfer in flight.
+  GLuint pbos[2] = {0, 0};
+  int nextPbo = 0;
+
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::pair<size_t, std::string>> pending;  // guarded by mutex
+  std::deque<Decoded> decoded;                         // guarded by mutex
+  bool stopping = false;                               // guarded by mutex
+  size_t inFlight = 0;                                 // guarded by mutex
+};
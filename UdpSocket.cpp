@@ -0,0 +1,163 @@
+// UdpSocket.cpp
+#include "UdpSocket.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr uintptr_t kClosed = ~(uintptr_t)0;
+
+// Winsock needs starting once per process; nothing to tear down at exit.
+bool startNetworking() {
+  static bool started = [] {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+  }();
+  return started;
+}
+
+bool wouldBlock() {
+  int error = WSAGetLastError();
+  return error == WSAEWOULDBLOCK || error == WSAECONNRESET;  // ICMP port unreachable
+}
+#else
+using SocketHandle = int;
+constexpr int kClosed = -1;
+
+bool startNetworking() {
+  return true;
+}
+
+bool wouldBlock() {
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED;
+}
+#endif
+
+sockaddr_in toSockaddr(const NetAddress &a) {
+  sockaddr_in sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(a.ip);
+  sa.sin_port = htons(a.port);
+  return sa;
+}
+
+}  // namespace
+
+bool NetAddress::resolve(const std::string &host, uint16_t port, NetAddress &out) {
+  if (!startNetworking()) return false;
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  addrinfo *result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+    std::cerr << "Failed to resolve host: " << host << "\n";
+    return false;
+  }
+  out.ip = ntohl(((const sockaddr_in *)result->ai_addr)->sin_addr.s_addr);
+  out.port = port;
+  freeaddrinfo(result);
+  return true;
+}
+
+UdpSocket::~UdpSocket() {
+  close();
+}
+
+bool UdpSocket::isOpen() const {
+  return handle != kClosed;
+}
+
+bool UdpSocket::open(uint16_t port) {
+  close();
+  if (!startNetworking()) {
+    std::cerr << "Failed to start networking\n";
+    return false;
+  }
+
+  SocketHandle s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (s == (SocketHandle)kClosed) {
+    std::cerr << "Failed to create UDP socket\n";
+    return false;
+  }
+  handle = s;
+
+  sockaddr_in sa = toSockaddr({INADDR_ANY, port});
+  if (bind(s, (const sockaddr *)&sa, sizeof(sa)) != 0) {
+    std::cerr << "Failed to bind UDP port " << port << "\n";
+    close();
+    return false;
+  }
+
+#ifdef _WIN32
+  u_long nonBlocking = 1;
+  bool ok = ioctlsocket(s, FIONBIO, &nonBlocking) == 0;
+#else
+  bool ok = fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+  if (!ok) {
+    std::cerr << "Failed to make UDP socket non-blocking\n";
+    close();
+    return false;
+  }
+
+  socklen_t length = sizeof(sa);
+  getsockname(s, (sockaddr *)&sa, &length);
+  boundPort = ntohs(sa.sin_port);
+  return true;
+}
+
+void UdpSocket::close() {
+  if (!isOpen()) return;
+#ifdef _WIN32
+  closesocket((SocketHandle)handle);
+#else
+  ::close(handle);
+#endif
+  handle = kClosed;
+  boundPort = 0;
+}
+
+bool UdpSocket::send(const NetAddress &to, const void *data, size_t size) {
+  sockaddr_in sa = toSockaddr(to);
+  int sent = (int)sendto((SocketHandle)handle, (const char *)data, (int)size, 0,
+                         (const sockaddr *)&sa, sizeof(sa));
+  if (sent != (int)size) return false;
+  bytesSent += size;
+  packetsSent++;
+  return true;
+}
+
+int UdpSocket::receive(NetAddress &from, void *buffer, size_t capacity) {
+  sockaddr_in sa;
+  socklen_t length = sizeof(sa);
+  int received = (int)recvfrom((SocketHandle)handle, (char *)buffer, (int)capacity, 0,
+                               (sockaddr *)&sa, &length);
+  if (received < 0) return wouldBlock() ? 0 : -1;
+  from.ip = ntohl(sa.sin_addr.s_addr);
+  from.port = ntohs(sa.sin_port);
+  bytesReceived += received;
+  packetsReceived++;
+  return received;
+}
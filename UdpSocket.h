@@ -0,0 +1,55 @@
+// UdpSocket.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// IPv4 address and port, both in host byte order.
+struct NetAddress {
+  uint32_t ip = 0;
+  uint16_t port = 0;
+
+  bool operator==(const NetAddress &o) const { return ip == o.ip && port == o.port; }
+  bool operator!=(const NetAddress &o) const { return !(*this == o); }
+
+  static NetAddress loopback(uint16_t port) { return {0x7f000001u, port}; }
+  // Dotted quad or host name; false (and an error on std::cerr) if it
+  // doesn't resolve.
+  static bool resolve(const std::string &host, uint16_t port, NetAddress &out);
+};
+
+// Non-blocking IPv4 UDP socket. Counts the bytes and datagrams through it.
+class UdpSocket {
+ public:
+  UdpSocket() = default;
+  ~UdpSocket();
+
+  UdpSocket(const UdpSocket &) = delete;
+  UdpSocket &operator=(const UdpSocket &) = delete;
+
+  // Binds to `port` on every interface, or to any free port for 0.
+  bool open(uint16_t port = 0);
+  void close();
+  bool isOpen() const;
+  uint16_t getPort() const { return boundPort; }
+
+  bool send(const NetAddress &to, const void *data, size_t size);
+  // Size of the next datagram, 0 if none is waiting, -1 on error. Datagrams
+  // longer than `capacity` are truncated.
+  int receive(NetAddress &from, void *buffer, size_t capacity);
+
+  uint64_t getBytesSent() const { return bytesSent; }
+  uint64_t getBytesReceived() const { return bytesReceived; }
+  uint64_t getPacketsSent() const { return packetsSent; }
+  uint64_t getPacketsReceived() const { return packetsReceived; }
+
+ private:
+#ifdef _WIN32
+  uintptr_t handle = ~(uintptr_t)0;  // SOCKET
+#else
+  int handle = -1;
+#endif
+  uint16_t boundPort = 0;
+  uint64_t bytesSent = 0, bytesReceived = 0;
+  uint64_t packetsSent = 0, packetsReceived = 0;
+};
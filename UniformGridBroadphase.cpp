@@ -0,0 +1,143 @@
+// UniformGridBroadphase.cpp
+#include "UniformGridBroadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+
+namespace {
+
+inline bool overlaps(float ax, float ay, float ar, float bx, float by, float br, float period) {
+  float reach = ar + br;
+  return wrappedDistance(ax, bx, period) <= reach && wrappedDistance(ay, by, period) <= reach;
+}
+
+inline BroadphasePair makePair(uint32_t a, uint32_t b) {
+  return a < b ? BroadphasePair{a, b} : BroadphasePair{b, a};
+}
+
+}  // namespace
+
+void UniformGridBroadphase::findPairs(const std::vector<Entity> &entities,
+                                      std::vector<BroadphasePair> &pairs) {
+  pairs.clear();
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+
+  live.clear();
+  circles.resize(entities.size());
+  maxRadius = 0.0f;
+  for (size_t i = 0; i < entities.size(); i++) {
+    if (entities[i].radius < 0) continue;
+    live.push_back((uint32_t)i);
+    circles[i] = proxyCircle(entities[i]);
+    maxRadius = std::max(maxRadius, circles[i].radius);
+  }
+
+  const float cellSize = std::max(2.0f * maxRadius, period / 1024.0f);
+  cells = (int)(period / cellSize);
+
+  // With fewer than three cells per axis the neighbour stencil would visit the
+  // same cell twice; the world is all big objects anyway, so test every pair.
+  if (cells < 3) {
+    for (size_t i = 0; i < live.size(); i++) {
+      const ProxyCircle &a = circles[live[i]];
+      for (size_t j = i + 1; j < live.size(); j++) {
+        const ProxyCircle &b = circles[live[j]];
+        if (overlaps(a.centre.x, a.centre.y, a.radius, b.centre.x, b.centre.y, b.radius,
+                     period)) {
+          pairs.push_back({live[i], live[j]});
+        }
+      }
+    }
+    return;
+  }
+
+  // Counting sort of live entities into cells.
+  const float toCell = cells / period;
+  auto cellCoord = [&](float v) { return std::clamp((int)((v + bound) * toCell), 0, cells - 1); };
+
+  cellStart.assign((size_t)cells * cells + 1, 0);
+  cellOf.resize(live.size());
+  for (size_t i = 0; i < live.size(); i++) {
+    const ProxyCircle &c = circles[live[i]];
+    uint32_t cell = cellCoord(c.centre.y) * cells + cellCoord(c.centre.x);
+    cellOf[i] = cell;
+    cellStart[cell + 1]++;
+  }
+  for (size_t c = 1; c < cellStart.size(); c++) cellStart[c] += cellStart[c - 1];
+
+  binned.resize(live.size());
+  cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+  for (size_t i = 0; i < live.size(); i++) {
+    const ProxyCircle &c = circles[live[i]];
+    uint32_t slot = cellCursor[cellOf[i]]++;
+    binned[slot] = {c.centre.x, c.centre.y, c.radius, live[i]};
+  }
+
+  // Own cell plus the four neighbours of a half stencil, so each cell pair is
+  // visited once.
+  static const int stencil[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+  for (int cy = 0; cy < cells; cy++) {
+    for (int cx = 0; cx < cells; cx++) {
+      uint32_t cell = cy * cells + cx;
+      uint32_t begin = cellStart[cell], end = cellStart[cell + 1];
+      for (uint32_t i = begin; i < end; i++) {
+        const Proxy &a = binned[i];
+        for (uint32_t j = i + 1; j < end; j++) {
+          const Proxy &b = binned[j];
+          if (overlaps(a.x, a.y, a.r, b.x, b.y, b.r, period)) pairs.push_back(makePair(a.id, b.id));
+        }
+      }
+
+      for (const auto &offset : stencil) {
+        int nx = (cx + offset[0] + cells) % cells;
+        int ny = (cy + offset[1]) % cells;
+        uint32_t other = ny * cells + nx;
+        uint32_t otherBegin = cellStart[other], otherEnd = cellStart[other + 1];
+        for (uint32_t i = begin; i < end; i++) {
+          const Proxy &a = binned[i];
+          for (uint32_t j = otherBegin; j < otherEnd; j++) {
+            const Proxy &b = binned[j];
+            if (overlaps(a.x, a.y, a.r, b.x, b.y, b.r, period)) {
+              pairs.push_back(makePair(a.id, b.id));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+void UniformGridBroadphase::queryBox(glm::vec2 min, glm::vec2 max,
+                                     std::vector<uint32_t> &candidates) const {
+  if (cells < 3) {
+    candidates.insert(candidates.end(), live.begin(), live.end());
+    return;
+  }
+
+  // Entities are binned by centre, so widen the box by the largest radius.
+  const float bound = PhysicsSystem::worldBound;
+  const float toCell = cells / (2.0f * bound);
+  auto cellRange = [&](float lo, float hi, int &first, int &last) {
+    first = (int)std::floor((lo - maxRadius + bound) * toCell);
+    last = (int)std::floor((hi + maxRadius + bound) * toCell);
+    if (last - first >= cells) {
+      first = 0;
+      last = cells - 1;
+    }
+  };
+  int x0, x1, y0, y1;
+  cellRange(min.x, max.x, x0, x1);
+  cellRange(min.y, max.y, y0, y1);
+  for (int y = y0; y <= y1; y++) {
+    int cy = (y % cells + cells) % cells;
+    for (int x = x0; x <= x1; x++) {
+      uint32_t cell = cy * cells + (x % cells + cells) % cells;
+      for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+        candidates.push_back(binned[i].id);
+      }
+    }
+  }
+}
@@ -0,0 +1,29 @@
+// UniformGridBroadphase.h
+#pragma once
+#include "Broadphase.h"
+
+// Uniform grid over the torus, rebuilt every call with a counting sort. Cells
+// are at least as wide as the largest entity's diameter, so each entity is
+// binned by its centre and only its own and half of the neighbouring cells
+// need testing.
+class UniformGridBroadphase : public Broadphase {
+ public:
+  void findPairs(const std::vector<Entity> &entities, std::vector<BroadphasePair> &pairs) override;
+  const char *name() const override { return "grid"; }
+  void queryBox(glm::vec2 min, glm::vec2 max, std::vector<uint32_t> &candidates) const override;
+
+ private:
+  struct Proxy {
+    float x, y, r;
+    uint32_t id;
+  };
+
+  std::vector<uint32_t> cellStart;  // cellCount + 1 prefix sums
+  std::vector<uint32_t> cellCursor;
+  std::vector<uint32_t> cellOf;  // per live entity, parallel to live
+  std::vector<uint32_t> live;
+  std::vector<ProxyCircle> circles;  // indexed by entity
+  std::vector<Proxy> binned;
+  int cells = 0;  // per axis; below 3, nothing is binned
+  float maxRadius = 0.0f;
+};
@@ -0,0 +1,232 @@
+// VecEnv.cpp
+#include "VecEnv.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "PhysicsSystem.h"
+#include "ShipControl.h"
+
+namespace {
+
+// Ship handling and bullets come from ShipControl.h. main.cpp fires once
+// per key press; agents holding fire get a shot this often.
+constexpr float kFireInterval = 0.25f;
+
+// New episodes: asteroid sizes (pixels) and speeds, and the clear space
+// around the ship.
+constexpr float kMinAsteroidRadius = 12.0f;
+constexpr float kMaxAsteroidRadius = 32.0f;
+constexpr float kMinAsteroidSpeed = 0.05f;
+constexpr float kMaxAsteroidSpeed = 0.2f;
+constexpr float kSpawnClearance = 0.4f;
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+
+// Offset to the nearest copy, for offsets between two in-world positions.
+// Branch-free: offsets between random entities go either way.
+inline float nearestOffset(float d) {
+  return d - kPeriod * (float)(d > kBound) + kPeriod * (float)(d < -kBound);
+}
+
+inline glm::vec2 nearestOffset(glm::vec2 d) { return {nearestOffset(d.x), nearestOffset(d.y)}; }
+
+// SplitMix64's output function.
+inline uint64_t mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+inline glm::vec2 heading(const Entity &ship) {
+  float rad = glm::radians(ship.angle + 90.0f);
+  return {std::cos(rad), std::sin(rad)};
+}
+
+}  // namespace
+
+VecEnv::VecEnv(size_t worldCount, uint32_t asteroidCount, uint64_t seed)
+    : worldCount(worldCount),
+      asteroidCount(asteroidCount),
+      stride(1 + asteroidCount + bulletSlots),
+      observationSize(shipFeatures + asteroidFeatures * asteroidCount),
+      entities(worldCount * stride),
+      rngState(worldCount),
+      episodeSteps(worldCount),
+      cooldowns(worldCount),
+      observations(worldCount * observationSize),
+      rewards(worldCount),
+      dones(worldCount) {
+  // Each world's stream starts at an unrelated point of the sequence.
+  for (size_t w = 0; w < worldCount; w++) rngState[w] = mix(seed ^ mix(w + 1));
+  reset();
+}
+
+float VecEnv::random(size_t w) {
+  uint64_t z = mix(rngState[w] += 0x9e3779b97f4a7c15ull);  // SplitMix64
+  return (z >> 40) * (1.0f / 16777216.0f);
+}
+
+void VecEnv::reset() {
+  for (size_t w = 0; w < worldCount; w++) {
+    resetWorld(w);
+    observe(w);
+    rewards[w] = 0.0f;
+    dones[w] = 0;
+  }
+}
+
+void VecEnv::resetWorld(size_t w) {
+  Entity *e = &entities[w * stride];
+
+  e[0] = Entity();
+  e[0].type = EntityType::Ship;
+  e[0].radius = kShipRadius;
+
+  for (uint32_t a = 1; a <= asteroidCount; a++) {
+    Entity &rock = e[a];
+    rock = Entity();
+    rock.type = EntityType::Asteroid;
+    rock.radius = kMinAsteroidRadius + random(w) * (kMaxAsteroidRadius - kMinAsteroidRadius);
+    do {
+      rock.position = {random(w) * kPeriod - kBound, random(w) * kPeriod - kBound};
+    } while (glm::dot(rock.position, rock.position) < kSpawnClearance * kSpawnClearance);
+    float rad = random(w) * 2.0f * glm::pi<float>();
+    float speed = kMinAsteroidSpeed + random(w) * (kMaxAsteroidSpeed - kMinAsteroidSpeed);
+    rock.velocity = glm::vec2(std::cos(rad), std::sin(rad)) * speed;
+    rock.angularVelocity = (random(w) - 0.5f) * 180.0f;
+  }
+
+  for (uint32_t b = 1 + asteroidCount; b < stride; b++) {
+    e[b] = Entity();
+    e[b].type = EntityType::Bullet;
+    e[b].radius = -1.0f;
+  }
+
+  episodeSteps[w] = 0;
+  cooldowns[w] = 0.0f;
+}
+
+void VecEnv::stepWorld(size_t w, const Action &action, float dragFactor) {
+  Entity *e = &entities[w * stride];
+  Entity &ship = e[0];
+  const float dt = timeStep;
+
+  uint8_t buttons = action.thrust ? kInputThrust : 0;
+  if (action.rotate > 0)
+    buttons |= kInputLeft;
+  else if (action.rotate < 0)
+    buttons |= kInputRight;
+  steerShip(ship, buttons, dt, dragFactor);
+
+  cooldowns[w] -= dt;
+  if (action.fire && cooldowns[w] <= 0.0f) {
+    for (uint32_t b = 1 + asteroidCount; b < stride; b++) {
+      if (e[b].radius >= 0) continue;
+      e[b] = makeBullet(ship);
+      cooldowns[w] = kFireInterval;
+      break;
+    }
+  }
+
+  PhysicsSystem::integrate(e, stride, dt);
+
+  // Bullets are tested along this tick's path, so they can't skip over a
+  // small asteroid. Paths are all the same length, so most bullets are
+  // ruled out by distance before the segment test.
+  const float toWorld = PhysicsSystem::radiusToWorld;
+  const float bulletReach = kBulletRadius * toWorld;
+  const float pathLength = kBulletSpeed * dt;
+  uint32_t live[bulletSlots];
+  uint32_t liveCount = 0;
+  for (uint32_t b = 1 + asteroidCount; b < stride; b++) {
+    if (e[b].radius >= 0) live[liveCount++] = b;
+  }
+
+  float reward = 0.0f;
+  bool crashed = false;
+  uint32_t remaining = 0;
+  for (uint32_t a = 1; a <= asteroidCount; a++) {
+    Entity &rock = e[a];
+    if (rock.radius < 0) continue;
+    const float r = rock.radius * toWorld;
+
+    bool destroyed = false;
+    const float reach = r + bulletReach;
+    const float nearby = reach + pathLength;
+    for (uint32_t k = 0; k < liveCount && !destroyed; k++) {
+      Entity &bullet = e[live[k]];
+      if (bullet.radius < 0) continue;  // spent on an earlier asteroid
+      glm::vec2 end = nearestOffset(bullet.position - rock.position);
+      if (glm::dot(end, end) > nearby * nearby) continue;
+      glm::vec2 move = bullet.velocity * dt;
+      glm::vec2 start = end - move;
+      float t = std::clamp(-glm::dot(start, move) / glm::dot(move, move), 0.0f, 1.0f);
+      glm::vec2 closest = start + move * t;
+      if (glm::dot(closest, closest) <= reach * reach) {
+        bullet.radius = -1.0f;
+        rock.radius = -1.0f;
+        reward += 1.0f;
+        destroyed = true;
+      }
+    }
+    if (destroyed) continue;
+
+    remaining++;
+    glm::vec2 d = nearestOffset(ship.position - rock.position);
+    float shipReach = r + ship.radius * toWorld;
+    if (glm::dot(d, d) <= shipReach * shipReach) crashed = true;
+  }
+  if (crashed) reward -= 1.0f;
+
+  episodeSteps[w]++;
+  bool done = crashed || remaining == 0 || episodeSteps[w] >= maxSteps;
+  rewards[w] = reward;
+  dones[w] = done;
+  if (done) resetWorld(w);
+}
+
+void VecEnv::observe(size_t w) {
+  const Entity *e = &entities[w * stride];
+  const Entity &ship = e[0];
+  float *o = &observations[w * observationSize];
+
+  glm::vec2 dir = heading(ship);
+  o[0] = ship.position.x;
+  o[1] = ship.position.y;
+  o[2] = ship.velocity.x;
+  o[3] = ship.velocity.y;
+  o[4] = dir.x;
+  o[5] = dir.y;
+  o += shipFeatures;
+
+  for (uint32_t a = 1; a <= asteroidCount; a++, o += asteroidFeatures) {
+    const Entity &rock = e[a];
+    if (rock.radius < 0) {
+      std::fill(o, o + asteroidFeatures, 0.0f);
+      continue;
+    }
+    glm::vec2 d = nearestOffset(rock.position - ship.position);
+    o[0] = d.x;
+    o[1] = d.y;
+    o[2] = rock.velocity.x;
+    o[3] = rock.velocity.y;
+    o[4] = rock.radius * PhysicsSystem::radiusToWorld;
+  }
+}
+
+void VecEnv::step(const Action *actions) {
+  const float dragFactor = shipDrag(timeStep);
+  auto run = [&](size_t begin, size_t end) {
+    for (size_t w = begin; w < end; w++) {
+      stepWorld(w, actions[w], dragFactor);
+      observe(w);
+    }
+  };
+  if (jobs) {
+    jobs->parallelFor(worldCount, worldGrain, run);
+  } else {
+    run(0, worldCount);
+  }
+}
@@ -0,0 +1,94 @@
+// VecEnv.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Entity.h"
+#include "JobSystem.h"
+
+// Many independent copies of the game for training ship-control agents,
+// stepped together with no window. Each world is one ship, a fixed number of
+// asteroid slots and a few bullet slots, laid out back to back in a single
+// entity array (world w owns getEntitiesPerWorld() entries from
+// w * getEntitiesPerWorld()), so stepping a world touches one small
+// contiguous block and worlds step in parallel without sharing anything.
+//
+// Ships handle as in main.cpp. Worlds move with PhysicsSystem::integrate;
+// collision is a direct test of the handful of circles in each world rather
+// than a broadphase, and asteroids are destroyed by a single hit. A world
+// whose episode ends (ship crashed, asteroids cleared or step limit reached)
+// starts a new episode straight away.
+//
+// Results for a given seed don't depend on the thread count.
+class VecEnv {
+ public:
+  struct Action {
+    int8_t rotate = 0;  // +1 turns left (A), -1 right (D)
+    uint8_t thrust = 0;
+    uint8_t fire = 0;  // fires if the gun has cooled down
+  };
+
+  // Per asteroid slot: position relative to the ship (nearest copy on the
+  // torus), velocity and radius in world units; zeros for destroyed ones.
+  static constexpr size_t asteroidFeatures = 5;
+  // Ship position, velocity, and heading as a unit vector.
+  static constexpr size_t shipFeatures = 6;
+
+  VecEnv(size_t worldCount, uint32_t asteroidCount = 8, uint64_t seed = 1);
+
+  // Starts a new episode in every world and writes first observations.
+  void reset();
+  // Advances every world one tick with actions[w]. Afterwards world w's
+  // observation, reward and done flag are at index w of the buffers below;
+  // if its episode ended, the observation is already the new episode's
+  // first.
+  void step(const Action *actions);
+
+  size_t getWorldCount() const { return worldCount; }
+  size_t getObservationSize() const { return observationSize; }
+  // worldCount x getObservationSize() floats, row per world.
+  const float *getObservations() const { return observations.data(); }
+  // +1 per asteroid destroyed this tick, -1 for a crash.
+  const float *getRewards() const { return rewards.data(); }
+  const uint8_t *getDones() const { return dones.data(); }
+
+  size_t getEntitiesPerWorld() const { return stride; }
+  const Entity *getWorld(size_t w) const { return &entities[w * stride]; }
+
+  void setTimeStep(float dt) { timeStep = dt; }
+  float getTimeStep() const { return timeStep; }
+  // Ticks before an episode is cut off.
+  void setMaxSteps(uint32_t steps) { maxSteps = steps; }
+  uint32_t getMaxSteps() const { return maxSteps; }
+
+  // Pool the worlds are spread over; null (the default) steps them on the
+  // calling thread. Not owned.
+  void setJobSystem(JobSystem *js) { jobs = js; }
+  JobSystem *getJobSystem() const { return jobs; }
+
+ private:
+  static constexpr uint32_t bulletSlots = 6;
+  static constexpr size_t worldGrain = 64;  // worlds per job chunk
+
+  void resetWorld(size_t w);
+  void stepWorld(size_t w, const Action &action, float dragFactor);
+  void observe(size_t w);
+  float random(size_t w);  // uniform in [0, 1), from the world's own stream
+
+  size_t worldCount;
+  uint32_t asteroidCount;
+  size_t stride;  // entities per world: ship, asteroids, bullets
+  size_t observationSize;
+  float timeStep = 1.0f / 60.0f;
+  uint32_t maxSteps = 3600;
+  JobSystem *jobs = nullptr;
+
+  std::vector<Entity> entities;
+  std::vector<uint64_t> rngState;
+  std::vector<uint32_t> episodeSteps;
+  std::vector<float> cooldowns;  // seconds until each ship can fire
+  std::vector<float> observations;
+  std::vector<float> rewards;
+  std::vector<uint8_t> dones;
+};
@@ -0,0 +1,149 @@
+// WorldServer.cpp
+#include "WorldServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "Broadphase.h"
+
+namespace {
+
+// A rebalance has to cut the busiest thread's load by this much to be worth
+// moving worlds (and their caches) around.
+constexpr double kRebalanceGain = 0.9;
+
+}  // namespace
+
+WorldServer::WorldServer(JobSystem &jobs, float tickRate)
+    : jobs(jobs),
+      tickInterval(1.0f / tickRate),
+      threadWorlds(jobs.getThreadCount()),
+      threadLoad(jobs.getThreadCount(), 0.0) {}
+
+uint32_t WorldServer::addWorld() {
+  uint32_t id;
+  if (!freeIds.empty()) {
+    id = freeIds.back();
+    freeIds.pop_back();
+  } else {
+    id = (uint32_t)worlds.size();
+    worlds.emplace_back();
+  }
+  worlds[id] = std::make_unique<World>();
+  worlds[id]->physics.setBroadphase(createBroadphase("grid"));
+  worldCount++;
+
+  // Until it has been timed, a new world is guessed to cost the average.
+  double estimate = 0.0;
+  for (double load : threadLoad) estimate += load;
+  estimate = worldCount > 1 ? estimate / (double)(worldCount - 1) : 0.0;
+
+  unsigned best = 0;
+  for (unsigned t = 1; t < threadWorlds.size(); t++) {
+    if (threadLoad[t] < threadLoad[best] ||
+        (threadLoad[t] == threadLoad[best] &&
+         threadWorlds[t].size() < threadWorlds[best].size())) {
+      best = t;
+    }
+  }
+  assign(id, best);
+  threadLoad[best] += estimate;
+  worlds[id]->estimatedMs = estimate;
+  return id;
+}
+
+void WorldServer::removeWorld(uint32_t world) {
+  if (!isActive(world)) return;
+  unsigned thread = worlds[world]->stats.thread;
+  std::vector<uint32_t> &list = threadWorlds[thread];
+  list.erase(std::find(list.begin(), list.end(), world));
+  threadLoad[thread] -= worlds[world]->estimatedMs;
+  worlds[world].reset();
+  freeIds.push_back(world);
+  worldCount--;
+}
+
+void WorldServer::assign(uint32_t world, unsigned thread) {
+  worlds[world]->stats.thread = thread;
+  threadWorlds[thread].push_back(world);
+}
+
+double WorldServer::getThreadLoadMs(unsigned thread) const { return threadLoad[thread]; }
+
+int WorldServer::update(float elapsed) {
+  accumulator += elapsed;
+  int ticks = (int)(accumulator / tickInterval);
+  if (ticks > maxTicksPerUpdate) {
+    ticks = maxTicksPerUpdate;
+    accumulator = 0.0f;  // drop the backlog rather than chase it
+  } else {
+    accumulator -= ticks * tickInterval;
+  }
+  if (ticks > 0) tick(ticks);
+  return ticks;
+}
+
+void WorldServer::tick(int ticks) {
+  jobs.forEachThread([&](unsigned thread) { runThread(thread, ticks); });
+
+  ticksSinceRebalance += ticks;
+  if (rebalanceInterval > 0 && ticksSinceRebalance >= rebalanceInterval) {
+    ticksSinceRebalance = 0;
+    rebalance();
+  }
+}
+
+void WorldServer::runThread(unsigned thread, int ticks) {
+  using Clock = std::chrono::steady_clock;
+  double load = 0.0;
+  for (uint32_t id : threadWorlds[thread]) {
+    World &w = *worlds[id];
+    for (int t = 0; t < ticks; t++) {
+      auto start = Clock::now();
+      if (tickFn) tickFn(id, w.entities, tickInterval);
+      w.physics.update(w.entities, tickInterval);
+      double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+      WorldStats &s = w.stats;
+      s.lastTickMs = ms;
+      s.averageTickMs = s.ticks == 0 ? ms : s.averageTickMs + (ms - s.averageTickMs) / 32.0;
+      s.maxTickMs = std::max(s.maxTickMs, ms);
+      s.ticks++;
+    }
+    w.estimatedMs = w.stats.averageTickMs;
+    load += w.estimatedMs;
+  }
+  threadLoad[thread] = load;
+}
+
+void WorldServer::rebalance() {
+  const unsigned threads = (unsigned)threadWorlds.size();
+  if (threads < 2 || worldCount == 0) return;
+
+  std::vector<std::pair<double, uint32_t>> byCost;
+  byCost.reserve(worldCount);
+  for (uint32_t id = 0; id < worlds.size(); id++) {
+    if (worlds[id]) byCost.push_back({worlds[id]->estimatedMs, id});
+  }
+  std::sort(byCost.begin(), byCost.end(), [](const auto &a, const auto &b) {
+    return a.first != b.first ? a.first > b.first : a.second < b.second;
+  });
+
+  std::vector<double> load(threads, 0.0);
+  std::vector<unsigned> placement(byCost.size());
+  for (size_t i = 0; i < byCost.size(); i++) {
+    unsigned best = (unsigned)(std::min_element(load.begin(), load.end()) - load.begin());
+    placement[i] = best;
+    load[best] += byCost[i].first;
+  }
+
+  double oldMax = *std::max_element(threadLoad.begin(), threadLoad.end());
+  double newMax = *std::max_element(load.begin(), load.end());
+  if (newMax >= oldMax * kRebalanceGain) return;
+
+  for (std::vector<uint32_t> &list : threadWorlds) list.clear();
+  for (size_t i = 0; i < byCost.size(); i++) assign(byCost[i].second, placement[i]);
+  for (std::vector<uint32_t> &list : threadWorlds) std::sort(list.begin(), list.end());
+  threadLoad = load;
+}
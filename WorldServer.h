@@ -0,0 +1,98 @@
+// WorldServer.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include "PhysicsSystem.h"
+
+// Hosts many independent matches in one process. Every world has its own
+// EntityManager and PhysicsSystem and ticks at the same fixed rate; update
+// turns elapsed wall time into whole ticks and runs them for every world.
+//
+// Worlds are pinned to the pool's threads (JobSystem::forEachThread), so a
+// world's entities stay in one core's cache from tick to tick, and each
+// thread runs all of an update's ticks for its worlds without waiting on the
+// others in between. Each world's tick is timed; every so often worlds are
+// reassigned, heaviest first, to the least loaded thread, and the new
+// assignment is kept only if it evens the load out noticeably.
+//
+// A world's PhysicsSystem runs single-threaded (worlds, not their insides,
+// are what's spread over the pool), so leave its job system unset.
+class WorldServer {
+ public:
+  struct WorldStats {
+    double lastTickMs = 0.0;
+    double averageTickMs = 0.0;  // moving average over roughly the last 32 ticks
+    double maxTickMs = 0.0;
+    uint64_t ticks = 0;
+    unsigned thread = 0;  // pool thread the world is pinned to
+  };
+
+  // Game logic for one world, run on the world's thread just before each
+  // physics update; called concurrently for worlds on different threads.
+  using TickFn = std::function<void(uint32_t world, EntityManager &em, float dt)>;
+
+  // Not owned; must outlive the server.
+  explicit WorldServer(JobSystem &jobs, float tickRate = 60.0f);
+
+  // Adds a world with a grid broadphase, on the least loaded thread.
+  uint32_t addWorld();
+  // Stops ticking the world and frees it; the id may be reused.
+  void removeWorld(uint32_t world);
+  size_t getWorldCount() const { return worldCount; }
+  bool isActive(uint32_t world) const { return world < worlds.size() && worlds[world]; }
+
+  EntityManager &getEntities(uint32_t world) { return worlds[world]->entities; }
+  PhysicsSystem &getPhysics(uint32_t world) { return worlds[world]->physics; }
+  const WorldStats &getStats(uint32_t world) const { return worlds[world]->stats; }
+
+  void setTickFunction(TickFn fn) { tickFn = std::move(fn); }
+
+  // Runs as many whole ticks as `elapsed` seconds (plus what was left over
+  // last time) cover, at most getMaxTicksPerUpdate; returns how many.
+  int update(float elapsed);
+  // Runs exactly `ticks` ticks regardless of the clock.
+  void tick(int ticks = 1);
+
+  float getTickInterval() const { return tickInterval; }
+  // Caps catch-up after a stall, so one slow frame can't snowball.
+  void setMaxTicksPerUpdate(int n) { maxTicksPerUpdate = n < 1 ? 1 : n; }
+  int getMaxTicksPerUpdate() const { return maxTicksPerUpdate; }
+  // Ticks between load rebalancing; 0 turns it off.
+  void setRebalanceInterval(uint32_t ticks) { rebalanceInterval = ticks; }
+
+  unsigned getThreadCount() const { return jobs.getThreadCount(); }
+  // Sum of the average tick cost of a thread's worlds.
+  double getThreadLoadMs(unsigned thread) const;
+  // Reassigns worlds to threads by average cost now.
+  void rebalance();
+
+ private:
+  struct World {
+    EntityManager entities;
+    PhysicsSystem physics;
+    WorldStats stats;
+    double estimatedMs = 0.0;  // averageTickMs, or a guess before the first tick
+  };
+
+  void assign(uint32_t world, unsigned thread);
+  void runThread(unsigned thread, int ticks);
+
+  JobSystem &jobs;
+  float tickInterval;
+  float accumulator = 0.0f;
+  int maxTicksPerUpdate = 4;
+  uint32_t rebalanceInterval = 300;
+  uint64_t ticksSinceRebalance = 0;
+  TickFn tickFn;
+
+  std::vector<std::unique_ptr<World>> worlds;  // null for removed ids
+  std::vector<uint32_t> freeIds;
+  size_t worldCount = 0;
+  std::vector<std::vector<uint32_t>> threadWorlds;  // worlds pinned to each thread
+  std::vector<double> threadLoad;                   // estimatedMs summed per thread
+};
@@ -0,0 +1,306 @@
+// WorldShard.cpp
+#include "WorldShard.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr float kBound = PhysicsSystem::worldBound;
+constexpr float kPeriod = 2.0f * PhysicsSystem::worldBound;
+// Far more than any tick's message; anything bigger is a corrupt stream.
+constexpr uint32_t kMaxMessageBytes = 1u << 30;
+
+inline int wrapIndex(int i, int n) {
+  return (i % n + n) % n;
+}
+
+void appendRaw(std::vector<uint8_t> &out, const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  out.insert(out.end(), bytes, bytes + size);
+}
+
+void putU32(std::vector<uint8_t> &out, size_t offset, uint32_t v) {
+  std::memcpy(out.data() + offset, &v, 4);
+}
+
+uint32_t getU32(const std::vector<uint8_t> &in, size_t offset) {
+  uint32_t v;
+  std::memcpy(&v, in.data() + offset, 4);
+  return v;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+int ShardLayout::regionOf(glm::vec2 position) const {
+  int column = (int)std::floor((position.x + kBound) / (kPeriod / columns));
+  int row = (int)std::floor((position.y + kBound) / (kPeriod / rows));
+  return std::clamp(row, 0, rows - 1) * columns + std::clamp(column, 0, columns - 1);
+}
+
+void ShardLayout::regionsNear(glm::vec2 position, float reach, std::vector<int> &out) const {
+  out.clear();
+  const float width = kPeriod / columns, height = kPeriod / rows;
+  int c0 = (int)std::floor((position.x - reach + kBound) / width);
+  int c1 = (int)std::floor((position.x + reach + kBound) / width);
+  int r0 = (int)std::floor((position.y - reach + kBound) / height);
+  int r1 = (int)std::floor((position.y + reach + kBound) / height);
+  c1 = std::min(c1, c0 + columns - 1);
+  r1 = std::min(r1, r0 + rows - 1);
+  for (int r = r0; r <= r1; r++) {
+    for (int c = c0; c <= c1; c++) {
+      int region = wrapIndex(r, rows) * columns + wrapIndex(c, columns);
+      if (std::find(out.begin(), out.end(), region) == out.end()) out.push_back(region);
+    }
+  }
+}
+
+void ShardLayout::neighbours(int region, std::vector<int> &out) const {
+  out.clear();
+  const int row = region / columns, column = region % columns;
+  for (int dr = -1; dr <= 1; dr++) {
+    for (int dc = -1; dc <= 1; dc++) {
+      int n = wrapIndex(row + dr, rows) * columns + wrapIndex(column + dc, columns);
+      if (n != region && std::find(out.begin(), out.end(), n) == out.end()) out.push_back(n);
+    }
+  }
+  std::sort(out.begin(), out.end());
+}
+
+WorldShard::WorldShard(const ShardLayout &shardLayout, int shardRegion)
+    : layout(shardLayout), region(shardRegion) {}
+
+WorldShard::~WorldShard() {
+#ifndef _WIN32
+  for (Link &l : links) close(l.fd);
+#endif
+}
+
+bool WorldShard::createLinkPair(int &a, int &b) {
+#ifdef _WIN32
+  (void)a;
+  (void)b;
+  std::cerr << "Shard links need POSIX sockets\n";
+  return false;
+#else
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    std::cerr << "Failed to create shard link: " << std::strerror(errno) << "\n";
+    return false;
+  }
+  a = fds[0];
+  b = fds[1];
+  return true;
+#endif
+}
+
+void WorldShard::addLink(int target, int fd) {
+  Link l;
+  l.region = target;
+  l.fd = fd;
+  auto at = std::lower_bound(links.begin(), links.end(), target,
+                             [](const Link &a, int r) { return a.region < r; });
+  links.insert(at, std::move(l));
+}
+
+void WorldShard::addEntity(uint32_t id, const Entity &e) {
+  entities.createEntity(e);
+  ids.push_back(id);
+}
+
+WorldShard::Link *WorldShard::linkTo(int target) {
+  for (Link &l : links) {
+    if (l.region == target) return &l;
+  }
+  return nullptr;
+}
+
+void WorldShard::sendGhost(const Entity &e, int owner) {
+  layout.regionsNear(e.position, layout.ghostWidth + e.radius * PhysicsSystem::radiusToWorld,
+                     near);
+  for (int r : near) {
+    if (r == owner) continue;
+    if (r == region) {
+      ghosts.push_back(e);  // handed off, but still near enough to collide with
+      continue;
+    }
+    if (Link *l = linkTo(r)) {
+      appendRaw(l->out, &e, sizeof(Entity));
+      l->ghostCount++;
+      stats.ghostsOut++;
+    }
+  }
+}
+
+bool WorldShard::tick(float dt) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Entity> &es = entities.getEntities();
+  const size_t owned = es.size();
+  es.insert(es.end(), ghosts.begin(), ghosts.end());
+  physics.update(entities, dt);
+  es.resize(owned);  // the ghosts were only there to be collided with
+  stats.updateMs += elapsedMs(start);
+
+  start = std::chrono::steady_clock::now();
+  for (Link &l : links) {
+    l.out.assign(headerBytes, 0);
+    l.handoffs = 0;
+    l.ghostCount = 0;
+  }
+
+  // Hand off whatever has left the region, keeping the rest in order.
+  leaving.clear();
+  size_t kept = 0;
+  for (size_t i = 0; i < owned; i++) {
+    int owner = layout.regionOf(es[i].position);
+    if (owner != region) {
+      if (Link *l = linkTo(owner)) {
+        appendRaw(l->out, &ids[i], sizeof(uint32_t));
+        appendRaw(l->out, &es[i], sizeof(Entity));
+        l->handoffs++;
+        stats.handoffsOut++;
+        leaving.emplace_back(es[i], owner);
+        continue;
+      }
+      stats.strays++;
+    }
+    es[kept] = es[i];
+    ids[kept] = ids[i];
+    kept++;
+  }
+  es.resize(kept);
+  ids.resize(kept);
+
+  ghosts.clear();
+  if (!links.empty()) {
+    for (const Entity &e : es) sendGhost(e, region);
+    for (const auto &[e, owner] : leaving) sendGhost(e, owner);
+  }
+
+  bool ok = exchange();
+  for (const Link &l : links) ok = ok && unpack(l);
+  stats.exchangeMs += elapsedMs(start);
+  stats.ticks++;
+  return ok;
+}
+
+bool WorldShard::exchange() {
+#ifdef _WIN32
+  return links.empty();
+#else
+  for (Link &l : links) {
+    putU32(l.out, 0, (uint32_t)(l.out.size() - 4));
+    putU32(l.out, 4, (uint32_t)stats.ticks);
+    putU32(l.out, 8, l.handoffs);
+    putU32(l.out, 12, l.ghostCount);
+    l.sent = 0;
+    l.in.resize(4);
+    l.received = 0;
+  }
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_DONTWAIT | MSG_NOSIGNAL;  // a dead neighbour is an error, not a signal
+#else
+  const int flags = MSG_DONTWAIT;
+#endif
+
+  // Send ours and read theirs at the same time, so two big messages
+  // crossing can't both block on full socket buffers.
+  std::vector<pollfd> fds;
+  std::vector<Link *> polled;
+  for (;;) {
+    fds.clear();
+    polled.clear();
+    for (Link &l : links) {
+      short events = 0;
+      if (l.sent < l.out.size()) events |= POLLOUT;
+      if (l.received < l.in.size()) events |= POLLIN;
+      if (events == 0) continue;
+      fds.push_back({l.fd, events, 0});
+      polled.push_back(&l);
+    }
+    if (fds.empty()) return true;
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "Shard " << region << ": poll failed: " << std::strerror(errno) << "\n";
+      return false;
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+      Link &l = *polled[i];
+      short revents = fds[i].revents;
+      if ((revents & (POLLERR | POLLNVAL)) || (revents & POLLHUP && !(revents & POLLIN))) {
+        std::cerr << "Shard " << region << ": link to " << l.region << " closed\n";
+        return false;
+      }
+      if (revents & POLLOUT) {
+        ssize_t n = send(l.fd, l.out.data() + l.sent, l.out.size() - l.sent, flags);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+          std::cerr << "Shard " << region << ": send to " << l.region << " failed\n";
+          return false;
+        }
+        if (n > 0) l.sent += (size_t)n;
+      }
+      if (revents & POLLIN) {
+        ssize_t n = recv(l.fd, l.in.data() + l.received, l.in.size() - l.received, MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+          std::cerr << "Shard " << region << ": link to " << l.region << " closed\n";
+          return false;
+        }
+        if (n > 0) l.received += (size_t)n;
+        if (l.received == 4 && l.in.size() == 4) {
+          uint32_t length = getU32(l.in, 0);
+          if (length < headerBytes - 4 || length > kMaxMessageBytes) {
+            std::cerr << "Shard " << region << ": bad message from " << l.region << "\n";
+            return false;
+          }
+          l.in.resize(4 + (size_t)length);
+        }
+      }
+    }
+  }
+#endif
+}
+
+bool WorldShard::unpack(const Link &l) {
+  uint32_t tick = getU32(l.in, 4);
+  uint32_t handoffs = getU32(l.in, 8);
+  uint32_t ghostCount = getU32(l.in, 12);
+  const size_t handoffBytes = sizeof(uint32_t) + sizeof(Entity);
+  if (tick != (uint32_t)stats.ticks ||
+      l.in.size() != headerBytes + handoffs * handoffBytes + ghostCount * sizeof(Entity)) {
+    std::cerr << "Shard " << region << ": message from " << l.region << " out of step\n";
+    return false;
+  }
+
+  const uint8_t *p = l.in.data() + headerBytes;
+  for (uint32_t i = 0; i < handoffs; i++, p += handoffBytes) {
+    uint32_t id;
+    Entity e;
+    std::memcpy(&id, p, sizeof(uint32_t));
+    std::memcpy(&e, p + sizeof(uint32_t), sizeof(Entity));
+    addEntity(id, e);
+  }
+  for (uint32_t i = 0; i < ghostCount; i++, p += sizeof(Entity)) {
+    Entity e;
+    std::memcpy(&e, p, sizeof(Entity));
+    ghosts.push_back(e);
+  }
+  stats.handoffsIn += handoffs;
+  stats.ghostsIn += ghostCount;
+  return true;
+}
@@ -0,0 +1,119 @@
+// WorldShard.h
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+
+// The torus PhysicsSystem wraps at +/- worldBound, cut into columns x rows
+// equal regions, numbered row by row from the bottom left.
+struct ShardLayout {
+  int columns = 1;
+  int rows = 1;
+  // How far past its region an entity's circle is copied to the
+  // neighbours as a ghost, in world units. Needs to cover the biggest
+  // entity plus a tick's movement, so collisions across a border are seen
+  // from both sides.
+  float ghostWidth = 0.1f;
+
+  int getRegionCount() const { return columns * rows; }
+  int regionOf(glm::vec2 position) const;
+  // Every region the box `reach` either side of `position` touches, its
+  // own included, each once.
+  void regionsNear(glm::vec2 position, float reach, std::vector<int> &out) const;
+  // Regions sharing an edge or a corner with `region`, not itself, each
+  // once (with two columns, left and right are the same region).
+  void neighbours(int region, std::vector<int> &out) const;
+};
+
+// One region of a sharded world, meant to run in its own process. It owns
+// the entities in its region and simulates them with its own
+// PhysicsSystem, along with read-only "ghost" copies of its neighbours'
+// entities near the border, so collisions across the border happen on
+// both sides. After each update, entities that have moved into another
+// region are handed off to that region's shard, and copies of those near a
+// border go to the shards across it as ghosts for the next tick.
+//
+// Shards talk over stream sockets (see createLinkPair), one per pair of
+// neighbours, and run in lockstep: tick sends every neighbour one message
+// and waits for one from each. Entities cross as raw bytes, so every shard
+// must be the same build on the same machine. Fracture must stay off:
+// fragments spawned from a ghost would have no owner. POSIX only for now.
+class WorldShard {
+ public:
+  struct Stats {
+    uint64_t ticks = 0;
+    uint64_t handoffsOut = 0, handoffsIn = 0;
+    uint64_t ghostsOut = 0, ghostsIn = 0;
+    // Entities that left for a region that isn't a neighbour (they moved
+    // more than a region in one tick); kept, though outside the region.
+    uint64_t strays = 0;
+    double updateMs = 0.0;    // physics, summed over ticks
+    double exchangeMs = 0.0;  // sending and waiting, summed over ticks
+  };
+
+  WorldShard(const ShardLayout &layout, int region);
+  ~WorldShard();
+
+  WorldShard(const WorldShard &) = delete;
+  WorldShard &operator=(const WorldShard &) = delete;
+
+  // A connected pair of stream sockets for two shards, one end each, e.g.
+  // made before fork. False (and an error on std::cerr) if unsupported.
+  static bool createLinkPair(int &a, int &b);
+  // Talks to `region`'s shard over `fd`, which the shard then owns.
+  void addLink(int region, int fd);
+
+  // An entity this shard starts out owning; `id` follows it from shard to
+  // shard.
+  void addEntity(uint32_t id, const Entity &e);
+
+  // Updates physics over the owned entities and the last tick's ghosts,
+  // then swaps handoffs and ghosts with every neighbour. False if a link
+  // failed; the shard is then out of step and should stop.
+  bool tick(float dt);
+
+  // Owned entities and their ids, in the same order.
+  const std::vector<Entity> &getEntities() { return entities.getEntities(); }
+  const std::vector<uint32_t> &getIds() const { return ids; }
+  size_t getGhostCount() const { return ghosts.size(); }
+  PhysicsSystem &getPhysics() { return physics; }
+  int getRegion() const { return region; }
+  const Stats &getStats() const { return stats; }
+
+ private:
+  // Messages are a header (byte count after the first word, tick, handoff
+  // count, ghost count, all u32 in host order), then the handoffs (u32 id
+  // and the entity), then the ghosts.
+  struct Link {
+    int region = -1;
+    int fd = -1;
+    std::vector<uint8_t> out;  // this tick's message
+    size_t sent = 0;
+    uint32_t handoffs = 0, ghostCount = 0;
+    std::vector<uint8_t> in;  // the neighbour's, as it arrives
+    size_t received = 0;
+  };
+  static constexpr size_t headerBytes = 16;
+
+  Link *linkTo(int target);
+  void sendGhost(const Entity &e, int owner);
+  bool exchange();
+  bool unpack(const Link &link);
+
+  ShardLayout layout;
+  int region;
+  EntityManager entities;  // owned, plus this tick's ghosts during update
+  PhysicsSystem physics;
+  std::vector<uint32_t> ids;
+  std::vector<Entity> ghosts;  // for the next tick
+  std::vector<Link> links;     // by region
+  Stats stats;
+
+  // Scratch.
+  std::vector<int> near;
+  std::vector<std::pair<Entity, int>> leaving;  // handed off this tick, to whom
+};
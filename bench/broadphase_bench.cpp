@@ -0,0 +1,256 @@
+// broadphase_bench.cpp
+// Times the collision broadphases on asteroid fields moving under
+// PhysicsSystem::update, for a uniform spread and for tight clusters (the
+// case that overloads grid cells and long sweep-and-prune runs), and for a
+// mixed field of fast bullets, asteroids and a few big rocks (the case where
+// one large radius forces coarse grid cells).
+//
+//   whiskers_broadphase_bench [--broadphase grid|sap|tree|all] [--entities N]
+//                             [--steps K] [--distribution uniform|clustered|mixed|all]
+//                             [--max-radius PX] [--verify]
+//
+// Asteroid radii are uniform in [PX/4, PX] pixels. The demo's 8..32 px rocks
+// (--max-radius 32) cover the whole world several times over at 10k, so the
+// default is 8 px to keep pair counts at game-like densities.
+// --verify checks every broadphase's pair set (and the tree's radius queries
+// and raycasts) against brute force each step and exits non-zero on a
+// mismatch; use a small --entities with it.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AabbTreeBroadphase.h"
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+
+static std::vector<Entity> makeField(const std::string &distribution, int count,
+                                     float maxRadius) {
+  const float bound = PhysicsSystem::worldBound;
+  std::vector<Entity> field(count);
+  std::mt19937 rng(7);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+
+  // Clusters straddle the wrap seams too, so seam handling is on the hot path.
+  std::vector<glm::vec2> centres = {{-bound, 0.3f}, {bound * 0.5f, -bound}, {0.1f, 0.2f},
+                                    {-0.6f, -0.5f}, {0.7f, 0.6f}};
+  std::normal_distribution<float> spread(0.0f, 0.08f);
+
+  for (int i = 0; i < count; i++) {
+    Entity &e = field[i];
+    if (distribution == "clustered") {
+      glm::vec2 c = centres[i % centres.size()];
+      e.position = {c.x + spread(rng), c.y + spread(rng)};
+      e.position.x = std::fmod(e.position.x + 3.0f * bound, 2.0f * bound) - bound;
+      e.position.y = std::fmod(e.position.y + 3.0f * bound, 2.0f * bound) - bound;
+    } else {
+      e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    }
+    float rad = unit() * 6.2831853f;
+    glm::vec2 dir(std::cos(rad), std::sin(rad));
+    if (distribution == "mixed" && i % 5 != 0) {
+      e.type = EntityType::Bullet;
+      e.radius = 2.0f;
+      e.ttl = 2.0f + unit() * 8.0f;
+      e.velocity = dir * 2.0f;
+      continue;
+    }
+    e.type = EntityType::Asteroid;
+    e.radius = maxRadius * (0.25f + 0.75f * unit());
+    if (distribution == "mixed" && i % 100 == 0) e.radius = 48.0f + unit() * 16.0f;
+    e.velocity = dir * (0.05f + unit() * 0.3f);
+    e.angularVelocity = unit() * 360.0f - 180.0f;
+  }
+  return field;
+}
+
+static void bruteForce(const std::vector<Entity> &entities, std::vector<BroadphasePair> &pairs) {
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  pairs.clear();
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    if (entities[i].radius < 0) continue;
+    for (uint32_t j = i + 1; j < entities.size(); j++) {
+      if (entities[j].radius < 0) continue;
+      float reach = (entities[i].radius + entities[j].radius) * PhysicsSystem::radiusToWorld;
+      if (wrappedDistance(entities[i].position.x, entities[j].position.x, period) <= reach &&
+          wrappedDistance(entities[i].position.y, entities[j].position.y, period) <= reach) {
+        pairs.push_back({i, j});
+      }
+    }
+  }
+}
+
+// Nearest hit over the nine images of each circle; fine for rays shorter than
+// half the world.
+static bool bruteRaycast(const std::vector<Entity> &entities, glm::vec2 origin, glm::vec2 dir,
+                         float maxDistance, RaycastHit &hit) {
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  bool found = false;
+  hit.distance = maxDistance;
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    if (entities[i].radius < 0) continue;
+    float r = entities[i].radius * PhysicsSystem::radiusToWorld;
+    for (int sx = -1; sx <= 1; sx++) {
+      for (int sy = -1; sy <= 1; sy++) {
+        glm::vec2 m = origin - (entities[i].position + glm::vec2(sx * period, sy * period));
+        float b = m.x * dir.x + m.y * dir.y;
+        float c = m.x * m.x + m.y * m.y - r * r;
+        float disc = b * b - c;
+        if ((c > 0.0f && b > 0.0f) || disc < 0.0f) continue;
+        float t = std::max(-b - std::sqrt(disc), 0.0f);
+        if (t <= hit.distance) {
+          hit.distance = t;
+          hit.entity = i;
+          found = true;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+// Checks the tree's radius queries and raycasts against brute force.
+static bool verifyQueries(const AabbTreeBroadphase &tree, const std::vector<Entity> &entities,
+                          std::mt19937 &rng) {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  std::vector<uint32_t> found, expected;
+  for (int q = 0; q < 16; q++) {
+    glm::vec2 p(unit() * period - bound, unit() * period - bound);
+    float radius = 0.02f + unit() * 0.2f;
+    found.clear();
+    expected.clear();
+    tree.queryRadius(entities, p, radius, found);
+    for (uint32_t i = 0; i < entities.size(); i++) {
+      if (entities[i].radius < 0) continue;
+      float dx = wrappedDistance(p.x, entities[i].position.x, period);
+      float dy = wrappedDistance(p.y, entities[i].position.y, period);
+      float reach = radius + entities[i].radius * PhysicsSystem::radiusToWorld;
+      if (dx * dx + dy * dy <= reach * reach) expected.push_back(i);
+    }
+    std::sort(found.begin(), found.end());
+    if (found != expected) {
+      std::cerr << "queryRadius: found " << found.size() << ", expected " << expected.size()
+                << "\n";
+      return false;
+    }
+
+    float rad = unit() * 6.2831853f;
+    glm::vec2 dir(std::cos(rad), std::sin(rad));
+    RaycastHit hit, expectedHit;
+    bool hitFound = tree.raycast(entities, p, dir, 1.0f, hit);
+    bool hitExpected = bruteRaycast(entities, p, dir, 1.0f, expectedHit);
+    if (hitFound != hitExpected ||
+        (hitFound && std::fabs(hit.distance - expectedHit.distance) > 1e-4f)) {
+      std::cerr << "raycast: " << (hitFound ? hit.distance : -1.0f) << " vs "
+                << (hitExpected ? expectedHit.distance : -1.0f) << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+static void sortPairs(std::vector<BroadphasePair> &pairs) {
+  std::sort(pairs.begin(), pairs.end(), [](const BroadphasePair &x, const BroadphasePair &y) {
+    return x.a != y.a ? x.a < y.a : x.b < y.b;
+  });
+}
+
+int main(int argc, char *argv[]) {
+  std::string broadphaseName = "all";
+  std::string distributionName = "all";
+  int entityCount = 10000;
+  int steps = 300;
+  float maxRadius = 8.0f;
+  bool verify = false;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--broadphase"))
+      broadphaseName = next();
+    else if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--steps"))
+      steps = std::atoi(next());
+    else if (!strcmp(argv[i], "--distribution"))
+      distributionName = next();
+    else if (!strcmp(argv[i], "--max-radius"))
+      maxRadius = (float)std::atof(next());
+    else if (!strcmp(argv[i], "--verify"))
+      verify = true;
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<std::string> broadphases = {"grid", "sap", "tree"};
+  if (broadphaseName != "all") broadphases = {broadphaseName};
+  std::vector<std::string> distributions = {"uniform", "clustered", "mixed"};
+  if (distributionName != "all") distributions = {distributionName};
+
+  const float dt = 1.0f / 60.0f;
+  bool ok = true;
+  for (const std::string &distribution : distributions) {
+    std::vector<Entity> field = makeField(distribution, entityCount, maxRadius);
+    for (const std::string &name : broadphases) {
+      std::unique_ptr<Broadphase> broadphase = createBroadphase(name);
+      if (!broadphase) {
+        std::cerr << "Unknown broadphase: " << name << "\n";
+        return 1;
+      }
+
+      EntityManager world;
+      for (const Entity &e : field) world.createEntity(e);
+      PhysicsSystem physicsSystem;  // integration only; the broadphase is timed alone
+
+      std::vector<BroadphasePair> pairs, expected;
+      std::mt19937 queryRng(11);
+      double seconds = 0.0;
+      size_t totalPairs = 0;
+      for (int s = 0; s < steps; s++) {
+        physicsSystem.update(world, dt);
+        auto start = std::chrono::steady_clock::now();
+        broadphase->findPairs(world.getEntities(), pairs);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalPairs += pairs.size();
+
+        if (verify) {
+          bruteForce(world.getEntities(), expected);
+          sortPairs(pairs);
+          if (pairs.size() != expected.size() ||
+              !std::equal(pairs.begin(), pairs.end(), expected.begin(),
+                          [](const BroadphasePair &x, const BroadphasePair &y) {
+                            return x.a == y.a && x.b == y.b;
+                          })) {
+            std::cerr << name << "/" << distribution << ": step " << s << " found "
+                      << pairs.size() << " pairs, expected " << expected.size() << "\n";
+            ok = false;
+            break;
+          }
+          auto *tree = dynamic_cast<AabbTreeBroadphase *>(broadphase.get());
+          if (tree && !verifyQueries(*tree, world.getEntities(), queryRng)) {
+            std::cerr << name << "/" << distribution << ": step " << s << " query mismatch\n";
+            ok = false;
+            break;
+          }
+        }
+      }
+
+      std::cout << name << " " << distribution << ": " << entityCount << " entities, "
+                << (seconds * 1000.0 / steps) << " ms/step, " << (totalPairs / steps)
+                << " pairs/step\n";
+    }
+  }
+
+  if (verify) std::cout << (ok ? "verify: OK" : "verify: FAILED") << "\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+// fixed_bench.cpp
+// Runs the same world in float and in Q16.16 fixed point (Fixed.h) and
+// reports what the deterministic path costs: integrate over every entity,
+// and ship control (steerShip, with its trig and drag) over many ships.
+// Also reports how far the fixed world drifts from the float one, the
+// error of the fixed trig and power functions. Then runs the ships and
+// asteroids as a FixedWorld, firing too, and prints its checksum, which
+// should be the same on every compiler and CPU.
+//
+//   whiskers_fixed_bench [--entities N] [--ships S] [--ticks T]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Fixed.h"
+#include "FixedWorld.h"
+#include "PhysicsSystem.h"
+#include "ShipControl.h"
+
+namespace {
+
+template <typename E>
+double runIntegrate(std::vector<E> &entities, int ticks, decltype(E::radius) dt) {
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < ticks; t++) PhysicsSystem::integrate(entities.data(), entities.size(), dt);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename E>
+double runShips(std::vector<E> &ships, const std::vector<uint8_t> &buttons, int ticks,
+                decltype(E::angle) dt) {
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < ticks; t++) {
+    const uint8_t *b = &buttons[(size_t)t * ships.size()];
+    for (size_t i = 0; i < ships.size(); i++) steerShip(ships[i], b[i], dt);
+    PhysicsSystem::integrate(ships.data(), ships.size(), dt);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Distance on the torus.
+float wrappedDistance(glm::vec2 a, glm::vec2 b) {
+  const float period = 2.0f * PhysicsSystem::worldBound;
+  glm::vec2 d = a - b;
+  d.x -= period * std::round(d.x / period);
+  d.y -= period * std::round(d.y / period);
+  return std::sqrt(d.x * d.x + d.y * d.y);
+}
+
+template <typename F>
+float maxDrift(const std::vector<Entity> &floats, const std::vector<F> &fixeds) {
+  float worst = 0.0f;
+  for (size_t i = 0; i < floats.size(); i++) {
+    worst = std::max(worst, wrappedDistance(floats[i].position, fixeds[i].toEntity().position));
+  }
+  return worst;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int entityCount = 100000;
+  int shipCount = 10000;
+  int ticks = 300;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--ships"))
+      shipCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--ticks"))
+      ticks = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  // Generated in fixed point from integers, so the starting state (and so
+  // the checksum) doesn't depend on float rounding; the float world gets
+  // the same values, which floats hold exactly.
+  std::mt19937 rng(1);
+  const int32_t bound = Fixed(PhysicsSystem::worldBound).getRaw();
+  auto between = [&](int32_t lo, int32_t hi) {
+    return Fixed::fromRaw(lo + (int32_t)(rng() % (uint32_t)(hi - lo)));
+  };
+  const int32_t speed = Fixed(0.1).getRaw(), spin = Fixed(45).getRaw();
+
+  std::vector<FixedEntity> fixedAsteroids(entityCount), fixedShips(shipCount);
+  for (FixedEntity &e : fixedAsteroids) {
+    e.position = {between(-bound, bound), between(-bound, bound)};
+    e.velocity = {between(-speed, speed), between(-speed, speed)};
+    e.angularVelocity = between(-spin, spin);
+    e.radius = between(Fixed(8).getRaw(), Fixed(20).getRaw());
+  }
+  for (FixedEntity &s : fixedShips) {
+    s.type = EntityType::Ship;
+    s.radius = Fixed(16);
+    s.position = {between(-bound, bound), between(-bound, bound)};
+    s.angle = between(0, Fixed(360).getRaw());
+  }
+  FixedWorld world;
+  for (const FixedEntity &e : fixedAsteroids) world.createEntity(e);
+  for (const FixedEntity &e : fixedShips) world.createEntity(e);
+  std::vector<Entity> asteroids, ships;
+  for (const FixedEntity &e : fixedAsteroids) asteroids.push_back(e.toEntity());
+  for (const FixedEntity &e : fixedShips) ships.push_back(e.toEntity());
+
+  // Buttons held for a while, as a player would.
+  std::vector<uint8_t> buttons((size_t)ticks * shipCount);
+  for (int s = 0; s < shipCount; s++) {
+    uint8_t held = 0;
+    for (int t = 0; t < ticks; t++) {
+      if (rng() % 20 == 0) held = (uint8_t)(rng() % 8);
+      buttons[(size_t)t * shipCount + s] = held;
+    }
+  }
+
+  const float dt = 1.0f / 60.0f;
+  const Fixed fixedDt(1.0 / 60.0);
+  double floatIntegrate = runIntegrate(asteroids, ticks, dt);
+  double fixedIntegrate = runIntegrate(fixedAsteroids, ticks, fixedDt);
+  double floatShips = runShips(ships, buttons, ticks, dt);
+  double fixedShipsTime = runShips(fixedShips, buttons, ticks, fixedDt);
+
+  auto ns = [&](double seconds, int count) { return seconds * 1e9 / ((double)ticks * count); };
+  std::cout << "fixed point: " << entityCount << " asteroids, " << shipCount << " ships, "
+            << ticks << " ticks\n";
+  std::cout << "  integrate      float " << ns(floatIntegrate, entityCount) << " ns/entity, fixed "
+            << ns(fixedIntegrate, entityCount) << " ns/entity ("
+            << fixedIntegrate / floatIntegrate << "x)\n";
+  std::cout << "  ship control   float " << ns(floatShips, shipCount) << " ns/ship, fixed "
+            << ns(fixedShipsTime, shipCount) << " ns/ship (" << fixedShipsTime / floatShips
+            << "x)\n";
+
+  // The fixed world's velocities are quantized to 1/65536 and dt to
+  // 1092/65536 s, so positions drift slowly away from the float world's.
+  std::cout << "  drift          asteroids " << maxDrift(asteroids, fixedAsteroids)
+            << ", ships " << maxDrift(ships, fixedShips) << " world units after " << ticks
+            << " ticks\n";
+
+  float sinError = 0.0f, powError = 0.0f;
+  for (int d = -7200; d <= 7200; d++) {
+    float degrees = d * 0.1f;
+    float exact = (float)std::sin(degrees * 3.14159265358979 / 180.0);
+    sinError = std::max(sinError, std::fabs(sinDegrees(Fixed(degrees)).toFloat() - exact));
+  }
+  for (int e = 1; e <= 600; e++) {
+    float exponent = e * 0.01f;
+    float exact = std::pow(0.995f, exponent);
+    float approx = power(Fixed(0.995), Fixed(exponent)).toFloat();
+    powError = std::max(powError, std::fabs(approx - exact));
+  }
+  std::cout << "  max error      sin " << sinError << ", pow(0.995, x) " << powError << "\n";
+
+  // The lockstep world: the same start and buttons, plus a shot from each
+  // ship every half second.
+  std::vector<uint8_t> commands(shipCount);
+  for (int t = 0; t < ticks; t++) {
+    for (int s = 0; s < shipCount; s++) {
+      uint8_t fire = (t + s) % 30 == 0 ? kInputFire : 0;
+      commands[s] = buttons[(size_t)t * shipCount + s] | fire;
+    }
+    world.step(commands.data(), commands.size());
+  }
+  std::cout << "  fixed checksum " << std::hex << std::setw(16) << std::setfill('0')
+            << world.checksum() << std::dec
+            << " (FixedWorld; same on every platform for the same arguments)\n";
+  return 0;
+}
@@ -0,0 +1,175 @@
+// fracture_bench.cpp
+// Splits a burst of asteroids every frame and times the frame with the
+// fragment pool reserved up front and with the pool growing on demand, and
+// checks each batch conserves mass and momentum.
+//
+//   whiskers_fracture_bench [--asteroids N] [--burst K] [--frames F] [--broadphase grid|sap|tree]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "FractureSystem.h"
+#include "PhysicsSystem.h"
+
+namespace {
+
+// Mass, momentum, and the sum of momentum magnitudes to scale errors by.
+struct Totals {
+  double mass = 0.0, px = 0.0, py = 0.0, scale = 0.0;
+
+  void add(const Entity &e, double sign) {
+    double m = (double)e.radius * e.radius * sign;
+    mass += m;
+    px += m * e.velocity.x;
+    py += m * e.velocity.y;
+    scale += std::fabs(m) * std::hypot(e.velocity.x, e.velocity.y);
+  }
+};
+
+Totals asteroidTotals(const std::vector<Entity> &entities) {
+  Totals t;
+  for (const Entity &e : entities) {
+    if (e.type == EntityType::Asteroid && e.radius >= 0) t.add(e, 1.0);
+  }
+  return t;
+}
+
+struct Run {
+  std::vector<double> frameMs, applyMs;
+  size_t spawned = 0, finalEntities = 0, pool = 0, live = 0;
+  double worstMass = 0.0, worstMomentum = 0.0;
+};
+
+Run simulate(const std::vector<Entity> &initial, int burst, int frames, size_t reserve,
+             const std::string &broadphaseName) {
+  EntityManager em;
+  for (const Entity &e : initial) em.createEntity(e);
+  PhysicsSystem physics;
+  physics.setBroadphase(createBroadphase(broadphaseName));
+  FractureSystem fracture;
+  if (reserve) fracture.reserve(em, reserve);
+
+  Run run;
+  std::mt19937 rng(17);
+  std::vector<uint32_t> live;
+  for (int f = 0; f < frames; f++) {
+    auto start = std::chrono::steady_clock::now();
+    physics.update(em, 1.0f / 60.0f);
+
+    // Hit a random selection of the live asteroids, pushing each a little.
+    std::vector<Entity> &entities = em.getEntities();
+    live.clear();
+    for (uint32_t i = 0; i < entities.size(); i++) {
+      if (entities[i].type == EntityType::Asteroid && entities[i].radius >= 0) live.push_back(i);
+    }
+    size_t hits = std::min<size_t>(burst, live.size());
+    Totals expected = asteroidTotals(entities);
+    const float pieceScale = 1.0f / std::sqrt((float)fracture.getPieces());
+    for (size_t k = 0; k < hits; k++) {
+      std::swap(live[k], live[k + rng() % (live.size() - k)]);
+      const Entity &target = entities[live[k]];
+      glm::vec2 impulse(((int)(rng() % 201) - 100) * 0.01f, ((int)(rng() % 201) - 100) * 0.01f);
+      fracture.queueSplit(live[k], impulse);
+      if (target.radius * pieceScale < fracture.getMinRadius()) {
+        expected.add(target, -1.0);  // too small: destroyed, taking its share along
+      } else {
+        expected.px += impulse.x;
+        expected.py += impulse.y;
+      }
+    }
+
+    auto applyStart = std::chrono::steady_clock::now();
+    run.spawned += fracture.apply(em);
+    auto end = std::chrono::steady_clock::now();
+    run.applyMs.push_back(std::chrono::duration<double>(end - applyStart).count() * 1000.0);
+    run.frameMs.push_back(std::chrono::duration<double>(end - start).count() * 1000.0);
+
+    Totals after = asteroidTotals(em.getEntities());
+    run.worstMass = std::max(run.worstMass, std::fabs(after.mass - expected.mass) / expected.mass);
+    double momentumError = std::hypot(after.px - expected.px, after.py - expected.py);
+    run.worstMomentum = std::max(run.worstMomentum, momentumError / expected.scale);
+  }
+  run.finalEntities = em.getEntities().size();
+  for (const Entity &e : em.getEntities()) run.live += e.radius >= 0;
+  run.pool = fracture.getPoolSize();
+  return run;
+}
+
+void report(const char *label, Run &run) {
+  auto stats = [](std::vector<double> v, double &mean, double &p99, double &max) {
+    std::sort(v.begin(), v.end());
+    mean = 0.0;
+    for (double x : v) mean += x;
+    mean /= v.size();
+    p99 = v[v.size() * 99 / 100];
+    max = v.back();
+  };
+  double fMean, fP99, fMax, aMean, aP99, aMax;
+  stats(run.frameMs, fMean, fP99, fMax);
+  stats(run.applyMs, aMean, aP99, aMax);
+  std::cout << label << ": " << run.spawned << " fragments, " << run.live << " left of "
+            << run.finalEntities << " entity slots (" << run.pool << " pooled); frame mean " << fMean << " ms, p99 "
+            << fP99 << ", max " << fMax << "; apply mean " << aMean << " ms, p99 " << aP99
+            << ", max " << aMax << "; worst relative mass error " << run.worstMass
+            << ", momentum error " << run.worstMomentum << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int asteroidCount = 1500;
+  int burst = 300;
+  int frames = 60;
+  std::string broadphaseName = "grid";
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--asteroids"))
+      asteroidCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--burst"))
+      burst = std::atoi(next());
+    else if (!strcmp(argv[i], "--frames"))
+      frames = std::atoi(next());
+    else if (!strcmp(argv[i], "--broadphase"))
+      broadphaseName = next();
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (!createBroadphase(broadphaseName)) {
+    std::cerr << "Unknown broadphase: " << broadphaseName << "\n";
+    return 1;
+  }
+
+  const float bound = PhysicsSystem::worldBound;
+  std::vector<Entity> initial(asteroidCount);
+  std::mt19937 rng(13);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (Entity &e : initial) {
+    e.type = EntityType::Asteroid;
+    e.radius = 12.0f + unit() * 12.0f;
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    float heading = unit() * 2.0f * glm::pi<float>();
+    e.velocity = glm::vec2(std::cos(heading), std::sin(heading)) * (0.05f + unit() * 0.1f);
+  }
+
+  std::cout << asteroidCount << " asteroids, " << burst << " splits/frame for " << frames
+            << " frames, " << broadphaseName << "\n";
+  // Radii below 24 px split at most twice into three before the pieces are
+  // too small, so nine slots per asteroid cover every piece alive at once.
+  Run pooled = simulate(initial, burst, frames, (size_t)asteroidCount * 9, broadphaseName);
+  report("pooled", pooled);
+  Run onDemand = simulate(initial, burst, frames, 0, broadphaseName);
+  report("on demand", onDemand);
+  return pooled.worstMass < 1e-6 && pooled.worstMomentum < 1e-5 ? 0 : 1;
+}
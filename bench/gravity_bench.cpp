@@ -0,0 +1,135 @@
+// gravity_bench.cpp
+// Barnes-Hut accuracy against the exact pairwise sum for a range of theta,
+// then throughput of both on a larger field. Fields are uniform or clustered
+// (clusters straddling the world edges exercise the minimum-image rules).
+//
+//   whiskers_gravity_bench [--bodies N] [--accuracy-bodies N] [--threads T]
+//                          [--distribution uniform|clustered] [--repeat K]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "GravityField.h"
+#include "JobSystem.h"
+#include "PhysicsSystem.h"
+
+namespace {
+
+std::vector<Entity> makeField(int count, bool clustered, unsigned seed) {
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  std::mt19937 rng(seed);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  std::normal_distribution<float> spread(0.0f, 0.06f);
+  // The first centre sits on the world corner.
+  const glm::vec2 centres[6] = {{bound, bound},    {-0.4f, 0.3f}, {0.5f, -0.6f},
+                                {-0.7f, -0.8f}, {0.2f, 0.9f},   {1.0f, 0.0f}};
+
+  std::vector<Entity> entities(count);
+  for (int i = 0; i < count; i++) {
+    Entity &e = entities[i];
+    e.type = EntityType::Asteroid;
+    e.radius = 2.0f + unit() * 6.0f;
+    if (clustered) {
+      glm::vec2 p = centres[i % 6] + glm::vec2(spread(rng), spread(rng));
+      p.x -= period * std::floor((p.x + bound) / period);
+      p.y -= period * std::floor((p.y + bound) / period);
+      e.position = p;
+    } else {
+      e.position = {unit() * period - bound, unit() * period - bound};
+    }
+  }
+  return entities;
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int bodyCount = 20000;
+  int accuracyCount = 2000;
+  unsigned threads = JobSystem::defaultWorkerCount() + 1;
+  std::string distribution = "clustered";
+  int repeat = 5;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--bodies"))
+      bodyCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--accuracy-bodies"))
+      accuracyCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--threads"))
+      threads = (unsigned)std::max(1, std::atoi(next()));
+    else if (!strcmp(argv[i], "--distribution"))
+      distribution = next();
+    else if (!strcmp(argv[i], "--repeat"))
+      repeat = std::max(1, std::atoi(next()));
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (distribution != "uniform" && distribution != "clustered") {
+    std::cerr << "Unknown distribution: " << distribution << "\n";
+    return 1;
+  }
+  const bool clustered = distribution == "clustered";
+  const float thetas[] = {0.2f, 0.3f, 0.5f, 0.7f, 1.0f};
+
+  JobSystem jobs(threads - 1);
+  GravityField field;
+  field.addWell(glm::vec2(0.0f, 0.0f), 2000.0f);
+
+  // Accuracy: relative error of each body's acceleration.
+  std::vector<Entity> small = makeField(accuracyCount, clustered, 7);
+  std::vector<glm::vec2> exact, approx;
+  field.computeExact(small, &jobs, exact);
+  std::cout << distribution << ", " << threads << " threads\n";
+  std::cout << "accuracy (" << accuracyCount << " bodies):\n";
+  for (float theta : thetas) {
+    field.setTheta(theta);
+    field.computeAccelerations(small, &jobs, approx);
+    std::vector<float> errors;
+    for (size_t i = 0; i < small.size(); i++) {
+      float reference = glm::length(exact[i]);
+      if (reference > 0.0f) errors.push_back(glm::length(approx[i] - exact[i]) / reference);
+    }
+    std::sort(errors.begin(), errors.end());
+    double mean = 0.0;
+    for (float e : errors) mean += e;
+    mean /= errors.size();
+    std::cout << "  theta " << theta << ": mean " << mean * 100.0 << "%, median "
+              << errors[errors.size() / 2] * 100.0 << "%, p99 "
+              << errors[errors.size() * 99 / 100] * 100.0 << "%, max " << errors.back() * 100.0
+              << "%\n";
+  }
+
+  // Throughput.
+  std::vector<Entity> large = makeField(bodyCount, clustered, 9);
+  std::cout << "throughput (" << bodyCount << " bodies):\n";
+  auto start = std::chrono::steady_clock::now();
+  field.computeExact(large, &jobs, exact);
+  double exactSeconds = seconds(start);
+  std::cout << "  exact: " << exactSeconds * 1000.0 << " ms\n";
+  for (float theta : thetas) {
+    field.setTheta(theta);
+    field.computeAccelerations(large, &jobs, approx);  // warm-up
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) field.computeAccelerations(large, &jobs, approx);
+    double t = seconds(start) / repeat;
+    std::cout << "  theta " << theta << ": " << t * 1000.0 << " ms, " << bodyCount / t / 1e6
+              << " Mbodies/s, " << field.getNodeCount() << " nodes, " << exactSeconds / t
+              << "x exact\n";
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+// narrowphase_bench.cpp
+// Times Narrowphase::findContacts at each SIMD level on the broadphase pairs
+// of a bullet-vs-asteroid field, and checks every level returns exactly the
+// scalar path's contacts.
+//
+//   whiskers_narrowphase_bench [--entities N] [--repeat K] [--broadphase grid|sap|tree]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Broadphase.h"
+#include "Narrowphase.h"
+#include "PhysicsSystem.h"
+
+static bool sameContacts(const std::vector<Contact> &x, const std::vector<Contact> &y) {
+  if (x.size() != y.size()) return false;
+  for (size_t i = 0; i < x.size(); i++) {
+    if (x[i].a != y[i].a || x[i].b != y[i].b || x[i].normal.x != y[i].normal.x ||
+        x[i].normal.y != y[i].normal.y || x[i].penetration != y[i].penetration) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  int entityCount = 100000;
+  int repeat = 50;
+  std::string broadphaseName = "grid";
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--repeat"))
+      repeat = std::atoi(next());
+    else if (!strcmp(argv[i], "--broadphase"))
+      broadphaseName = next();
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  // Mostly bullets, plus asteroids for them to hit.
+  const float bound = PhysicsSystem::worldBound;
+  std::vector<Entity> entities(entityCount);
+  std::mt19937 rng(3);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (int i = 0; i < entityCount; i++) {
+    Entity &e = entities[i];
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    if (i % 10) {
+      e.type = EntityType::Bullet;
+      e.radius = 2.0f;
+    } else {
+      e.type = EntityType::Asteroid;
+      e.radius = 8.0f + unit() * 24.0f;
+    }
+  }
+
+  std::unique_ptr<Broadphase> broadphase = createBroadphase(broadphaseName);
+  if (!broadphase) {
+    std::cerr << "Unknown broadphase: " << broadphaseName << "\n";
+    return 1;
+  }
+  std::vector<BroadphasePair> pairs;
+  broadphase->findPairs(entities, pairs);
+
+  Narrowphase narrowphase;
+  std::vector<Contact> reference, contacts;
+  bool ok = true;
+  for (Narrowphase::Simd level :
+       {Narrowphase::Simd::Scalar, Narrowphase::Simd::SSE2, Narrowphase::Simd::AVX2}) {
+    narrowphase.setSimd(level);
+    if (narrowphase.getSimd() != level) {
+      std::cout << Narrowphase::simdName(level) << ": not supported on this CPU\n";
+      continue;
+    }
+
+    narrowphase.findContacts(entities, pairs, contacts);  // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) narrowphase.findContacts(entities, pairs, contacts);
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool match = true;
+    if (level == Narrowphase::Simd::Scalar) {
+      reference = contacts;
+    } else {
+      match = sameContacts(reference, contacts);
+      ok = ok && match;
+    }
+    std::cout << Narrowphase::simdName(level) << ": " << pairs.size() << " pairs, "
+              << contacts.size() << " contacts, " << (seconds * 1000.0 / repeat) << " ms, "
+              << (pairs.size() * repeat / seconds / 1e6) << " Mpairs/s"
+              << (match ? "" : "  MISMATCH") << "\n";
+  }
+  return ok ? 0 : 1;
+}
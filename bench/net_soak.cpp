@@ -0,0 +1,177 @@
+// net_soak.cpp
+// Runs a GameServer and a crowd of GameClients over 127.0.0.1 in real time
+// and reports what a match costs on the wire: per-client bandwidth each way,
+// server upload, snapshots completed or lost to missing fragments, latency
+// from sending an input to a snapshot acknowledging it, and how often
+// interpolation ran past the newest snapshot and had to hold it.
+// --interest turns on interest management, with --budget entities refreshed
+// per client per snapshot; clients' ships are then spread over the world.
+//
+//   whiskers_net_soak [--clients N] [--asteroids A] [--seconds S] [--snapshot-interval T]
+//                     [--interest] [--budget B]
+//
+// Every client holds random keys for a while at a time and taps fire now and
+// then. Exits non-zero if a client never connects or never sees a snapshot.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "GameClient.h"
+#include "GameServer.h"
+
+namespace {
+
+void populate(EntityManager &em, int asteroids) {
+  const float bound = PhysicsSystem::worldBound;
+  std::mt19937 rng(1);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (int i = 0; i < asteroids; i++) {
+    Entity e;
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    e.velocity = {(unit() - 0.5f) * 0.2f, (unit() - 0.5f) * 0.2f};
+    e.radius = 8.0f + unit() * 12.0f;
+    em.createEntity(e);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int clientCount = 16;
+  int asteroids = 200;
+  float seconds = 10.0f;
+  int snapshotInterval = 3;
+  bool interest = false;
+  int budget = -1;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--clients"))
+      clientCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--asteroids"))
+      asteroids = std::atoi(next());
+    else if (!strcmp(argv[i], "--seconds"))
+      seconds = (float)std::atof(next());
+    else if (!strcmp(argv[i], "--snapshot-interval"))
+      snapshotInterval = std::atoi(next());
+    else if (!strcmp(argv[i], "--interest"))
+      interest = true;
+    else if (!strcmp(argv[i], "--budget"))
+      budget = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  GameServer server;
+  populate(server.getEntities(), asteroids);
+  server.setSnapshotInterval((uint32_t)snapshotInterval);
+  server.setInterestManagement(interest);
+  if (budget >= 0) server.getInterestManager().setBudget((size_t)budget);
+  if (!server.start(0)) return 1;
+  NetAddress address = NetAddress::loopback(server.getPort());
+
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point begin = Clock::now();
+  auto now = [&]() { return std::chrono::duration<double>(Clock::now() - begin).count(); };
+
+  std::vector<std::unique_ptr<GameClient>> clients;
+  for (int i = 0; i < clientCount; i++) {
+    clients.push_back(std::make_unique<GameClient>());
+    if (!clients.back()->connect(address, now())) return 1;
+  }
+
+  std::cout << "net soak: " << clientCount << " clients, " << asteroids << " asteroids, "
+            << seconds << " s at 60 Hz, snapshot every " << snapshotInterval << " ticks"
+            << (interest ? ", interest managed" : "") << "\n";
+
+  std::mt19937 rng(7);
+  std::vector<uint8_t> held(clientCount, 0);
+  std::vector<Entity> view;
+  std::vector<double> tickMs;
+  const double interval = server.getTickInterval();
+  const int ticks = (int)(seconds / interval);
+  for (int t = 0; t < ticks; t++) {
+    server.tick();
+    if (interest && t == 30) {
+      // Everyone has connected by now; their ships all started at the
+      // centre, which would give every client the same view.
+      const float bound = PhysicsSystem::worldBound;
+      std::uniform_real_distribution<float> coordinate(-bound, bound);
+      for (Entity &e : server.getEntities().getEntities()) {
+        if (e.type == EntityType::Ship && e.radius >= 0) {
+          e.position = {coordinate(rng), coordinate(rng)};
+        }
+      }
+    }
+    tickMs.push_back(server.getLastTickMs());
+
+    double time = now();
+    for (int c = 0; c < clientCount; c++) {
+      GameClient &client = *clients[c];
+      client.update(time);
+      if (rng() % 30 == 0) held[c] = (uint8_t)(rng() % 8);  // some of thrust, left, right
+      uint8_t buttons = held[c];
+      if (rng() % 20 == 0) buttons |= kInputFire;
+      client.sendInput(buttons, time);
+      client.interpolate(time, view);
+    }
+
+    // Pace to the tick rate, as a real server would.
+    double wait = (t + 1) * interval - now();
+    if (wait > 0) std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+  }
+  const double elapsed = now();
+
+  bool ok = true;
+  uint64_t snapshots = 0, incomplete = 0, undecodable = 0, stalls = 0, samples = 0;
+  double latencySum = 0.0, latencyMax = 0.0, upMax = 0.0, downMax = 0.0;
+  for (int c = 0; c < clientCount; c++) {
+    const GameClient &client = *clients[c];
+    const GameClient::Stats &s = client.getStats();
+    if (!client.isConnected() || s.snapshots == 0) {
+      std::cerr << "client " << c << (client.isConnected() ? " got no snapshots\n"
+                                                             : " never connected\n");
+      ok = false;
+    }
+    snapshots += s.snapshots;
+    incomplete += s.incomplete;
+    undecodable += s.undecodable;
+    stalls += s.stalls;
+    samples += s.latencySamples;
+    latencySum += s.latencySumMs;
+    latencyMax = std::max(latencyMax, s.latencyMaxMs);
+    upMax = std::max(upMax, client.getSocket().getBytesSent() * 8.0 / 1000.0 / elapsed);
+    downMax = std::max(downMax, client.getSocket().getBytesReceived() * 8.0 / 1000.0 / elapsed);
+  }
+
+  const UdpSocket &socket = server.getSocket();
+  std::sort(tickMs.begin(), tickMs.end());
+  double averageTick = 0.0;
+  for (double ms : tickMs) averageTick += ms;
+  averageTick /= std::max<size_t>(1, tickMs.size());
+
+  std::cout << "  per client     up " << upMax << " kbps, down " << downMax << " kbps (max)\n";
+  std::cout << "  server out     " << socket.getBytesSent() * 8.0 / 1000.0 / elapsed
+            << " kbps, " << socket.getPacketsSent() / elapsed << " datagrams/s\n";
+  std::cout << "  snapshots      " << snapshots << " complete, " << incomplete
+            << " incomplete, " << undecodable << " undecodable\n";
+  std::cout << "  input -> ack   avg " << (samples ? latencySum / samples : 0.0) << " ms, max "
+            << latencyMax << " ms\n";
+  std::cout << "  interp stalls  " << stalls << " of "
+            << (uint64_t)ticks * (uint64_t)clientCount << " frames\n";
+  std::cout << "  server tick    avg " << averageTick << " ms, p99 "
+            << (tickMs.empty() ? 0.0 : tickMs[(size_t)(0.99 * (tickMs.size() - 1))]) << " ms\n";
+
+  for (auto &client : clients) client->disconnect();
+  server.stop();
+  return ok ? 0 : 1;
+}
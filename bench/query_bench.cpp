@@ -0,0 +1,280 @@
+// query_bench.cpp
+// Checks SpatialQuery's radius, box, nearest-neighbour and ray queries
+// against brute force over each broadphase, then times them one at a time
+// and batched over a JobSystem. "scan" is the radius query with no
+// broadphase, i.e. a linear pass over every entity.
+//
+//   whiskers_query_bench [--broadphase grid|sap|tree|all] [--entities N] [--queries Q]
+//                        [--threads T] [--k K]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include "PhysicsSystem.h"
+#include "SpatialQuery.h"
+
+namespace {
+
+const float kBound = PhysicsSystem::worldBound;
+const float kPeriod = 2.0f * PhysicsSystem::worldBound;
+
+struct Queries {
+  std::vector<glm::vec2> centres, directions;
+  std::vector<float> radii;
+  std::vector<uint32_t> exclude;
+};
+
+bool bruteRaycast(const std::vector<Entity> &entities, glm::vec2 origin, glm::vec2 dir,
+                  float maxDistance, RaycastHit &hit) {
+  bool found = false;
+  hit.distance = maxDistance;
+  for (uint32_t i = 0; i < entities.size(); i++) {
+    if (entities[i].radius < 0) continue;
+    float r = entities[i].radius * PhysicsSystem::radiusToWorld;
+    for (int sx = -1; sx <= 1; sx++) {
+      for (int sy = -1; sy <= 1; sy++) {
+        glm::vec2 m = origin - (entities[i].position + glm::vec2(sx * kPeriod, sy * kPeriod));
+        float b = m.x * dir.x + m.y * dir.y;
+        float c = m.x * m.x + m.y * m.y - r * r;
+        float disc = b * b - c;
+        if ((c > 0.0f && b > 0.0f) || disc < 0.0f) continue;
+        float t = std::max(-b - std::sqrt(disc), 0.0f);
+        if (t <= hit.distance) {
+          hit.distance = t;
+          hit.entity = i;
+          found = true;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+bool verify(const SpatialQuery &query, const std::vector<Entity> &entities, const Queries &qs,
+            size_t k, float rayLength) {
+  std::vector<uint32_t> found, expected;
+  std::vector<std::pair<float, uint32_t>> ranked;
+  const size_t count = std::min<size_t>(qs.centres.size(), 200);
+  for (size_t q = 0; q < count; q++) {
+    glm::vec2 p = qs.centres[q];
+    float radius = qs.radii[q];
+
+    found.clear();
+    expected.clear();
+    query.radius(p, radius, found);
+    for (uint32_t i = 0; i < entities.size(); i++) {
+      if (entities[i].radius < 0) continue;
+      float dx = wrappedDistance(p.x, entities[i].position.x, kPeriod);
+      float dy = wrappedDistance(p.y, entities[i].position.y, kPeriod);
+      float reach = radius + entities[i].radius * PhysicsSystem::radiusToWorld;
+      if (dx * dx + dy * dy <= reach * reach) expected.push_back(i);
+    }
+    std::sort(found.begin(), found.end());
+    if (found != expected) {
+      std::cerr << "radius: found " << found.size() << ", expected " << expected.size() << "\n";
+      return false;
+    }
+
+    found.clear();
+    expected.clear();
+    glm::vec2 half(radius, 0.5f * radius);
+    query.aabb(p - half, p + half, found);
+    for (uint32_t i = 0; i < entities.size(); i++) {
+      if (entities[i].radius < 0) continue;
+      float dx = std::max(wrappedDistance(p.x, entities[i].position.x, kPeriod) - half.x, 0.0f);
+      float dy = std::max(wrappedDistance(p.y, entities[i].position.y, kPeriod) - half.y, 0.0f);
+      float r = entities[i].radius * PhysicsSystem::radiusToWorld;
+      if (dx * dx + dy * dy <= r * r) expected.push_back(i);
+    }
+    std::sort(found.begin(), found.end());
+    if (found != expected) {
+      std::cerr << "aabb: found " << found.size() << ", expected " << expected.size() << "\n";
+      return false;
+    }
+
+    found.clear();
+    expected.clear();
+    query.nearest(p, k, found, qs.exclude[q]);
+    ranked.clear();
+    for (uint32_t i = 0; i < entities.size(); i++) {
+      if (entities[i].radius < 0 || i == qs.exclude[q]) continue;
+      float dx = wrappedDistance(p.x, entities[i].position.x, kPeriod);
+      float dy = wrappedDistance(p.y, entities[i].position.y, kPeriod);
+      ranked.push_back({dx * dx + dy * dy, i});
+    }
+    std::sort(ranked.begin(), ranked.end());
+    for (size_t i = 0; i < std::min(k, ranked.size()); i++) expected.push_back(ranked[i].second);
+    if (found != expected) {
+      std::cerr << "nearest: found " << found.size() << ", expected " << expected.size() << "\n";
+      return false;
+    }
+
+    RaycastHit hit, expectedHit;
+    bool hitFound = query.raycast(p, qs.directions[q], rayLength, hit);
+    bool hitExpected = bruteRaycast(entities, p, qs.directions[q], rayLength, expectedHit);
+    if (hitFound != hitExpected ||
+        (hitFound && std::fabs(hit.distance - expectedHit.distance) > 1e-4f)) {
+      std::cerr << "raycast: " << (hitFound ? hit.distance : -1.0f) << " vs "
+                << (hitExpected ? expectedHit.distance : -1.0f) << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Fn>
+double time(Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char *label, size_t queries, double seconds) {
+  std::cout << "  " << label << ": " << (seconds * 1e6 / queries) << " us/query, "
+            << (queries / seconds / 1e6) << " Mqueries/s\n";
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  std::string broadphaseName = "all";
+  int entityCount = 20000;
+  int queryCount = 20000;
+  int threads = (int)JobSystem::defaultWorkerCount();
+  size_t k = 8;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--broadphase"))
+      broadphaseName = next();
+    else if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--queries"))
+      queryCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--threads"))
+      threads = std::atoi(next());
+    else if (!strcmp(argv[i], "--k"))
+      k = (size_t)std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<std::string> broadphases = {"grid", "sap", "tree"};
+  if (broadphaseName != "all") broadphases = {broadphaseName};
+
+  // Asteroids of 2..8 px drifting about, a tenth of them bullets.
+  std::mt19937 rng(5);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  EntityManager world;
+  for (int i = 0; i < entityCount; i++) {
+    Entity e;
+    e.position = {unit() * kPeriod - kBound, unit() * kPeriod - kBound};
+    if (i % 10 == 0) {
+      e.type = EntityType::Bullet;
+      e.radius = 2.0f;
+      e.ttl = 1e6f;
+      e.velocity = {unit() - 0.5f, unit() - 0.5f};
+    } else {
+      e.type = EntityType::Asteroid;
+      e.radius = 2.0f + unit() * 6.0f;
+      e.velocity = {(unit() - 0.5f) * 0.1f, (unit() - 0.5f) * 0.1f};
+    }
+    world.createEntity(e);
+  }
+
+  Queries qs;
+  for (int q = 0; q < queryCount; q++) {
+    qs.centres.push_back({unit() * kPeriod - kBound, unit() * kPeriod - kBound});
+    qs.radii.push_back(0.01f + unit() * 0.05f);
+    float angle = unit() * 6.2831853f;
+    qs.directions.push_back({std::cos(angle), std::sin(angle)});
+    qs.exclude.push_back((uint32_t)(rng() % entityCount));
+  }
+  const float rayLength = 0.5f;
+
+  PhysicsSystem physicsSystem;  // integration only
+  for (int s = 0; s < 10; s++) physicsSystem.update(world, 1.0f / 60.0f);
+
+  JobSystem jobs(threads > 0 ? (unsigned)threads : 0);
+  std::vector<uint32_t> results, offsets;
+  std::vector<RaycastHit> hits;
+  bool ok = true;
+
+  for (const std::string &name : broadphases) {
+    std::unique_ptr<Broadphase> broadphase = createBroadphase(name);
+    if (!broadphase) {
+      std::cerr << "Unknown broadphase: " << name << "\n";
+      return 1;
+    }
+    // Bound directly rather than through PhysicsSystem, whose solver nudges
+    // positions after its broadphase runs; brute force then sees exactly the
+    // state the broadphase indexed.
+    std::vector<BroadphasePair> pairs;
+    broadphase->findPairs(world.getEntities(), pairs);
+    SpatialQuery query;
+    query.bind(broadphase.get(), &world.getEntities());
+    const std::vector<Entity> &entities = world.getEntities();
+
+    bool match = verify(query, entities, qs, k, rayLength);
+    ok = ok && match;
+    std::cout << name << ": " << entityCount << " entities, " << queryCount << " queries"
+              << (match ? "" : "  MISMATCH") << "\n";
+
+    report("radius      ", queryCount, time([&] {
+             results.clear();
+             for (int q = 0; q < queryCount; q++) query.radius(qs.centres[q], qs.radii[q], results);
+           }));
+    report("radius batch", queryCount, time([&] {
+             results.clear();
+             query.radiusBatch(qs.centres.data(), qs.radii.data(), queryCount, results, offsets,
+                               &jobs);
+           }));
+    report("nearest      ", queryCount, time([&] {
+             results.clear();
+             for (int q = 0; q < queryCount; q++) {
+               query.nearest(qs.centres[q], k, results, qs.exclude[q]);
+             }
+           }));
+    report("nearest batch", queryCount, time([&] {
+             results.clear();
+             query.nearestBatch(qs.centres.data(), qs.exclude.data(), queryCount, k, results,
+                                &jobs);
+           }));
+    report("raycast      ", queryCount, time([&] {
+             RaycastHit hit;
+             for (int q = 0; q < queryCount; q++) {
+               query.raycast(qs.centres[q], qs.directions[q], rayLength, hit);
+             }
+           }));
+    report("raycast batch", queryCount, time([&] {
+             query.raycastBatch(qs.centres.data(), qs.directions.data(), queryCount, rayLength,
+                                hits, &jobs);
+           }));
+  }
+
+  // Linear pass for comparison, on a slice of the queries.
+  SpatialQuery scan;
+  scan.bind(nullptr, &world.getEntities());
+  int scanCount = std::min(queryCount, 1000);
+  std::cout << "scan: " << entityCount << " entities, " << scanCount << " queries\n";
+  report("radius      ", scanCount, time([&] {
+           results.clear();
+           for (int q = 0; q < scanCount; q++) scan.radius(qs.centres[q], qs.radii[q], results);
+         }));
+
+  std::cout << (ok ? "verify: OK" : "verify: FAILED") << "\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// server_bench.cpp
+// Hosts many matches of uneven size in one WorldServer and reports the
+// per-world tick cost, each thread's load, and how many such matches a core
+// could keep at 60 Hz. For comparison the same worlds are also ticked by a
+// plain JobSystem::parallelFor over worlds, where any thread may pick up any
+// world each tick.
+//
+//   whiskers_server_bench [--worlds N] [--asteroids A] [--seconds S] [--threads T]
+//
+// World i has A/2, A, 3A/2 or 2A asteroids (cycling), a ship that turns and
+// fires, and bullets reusing dead slots.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include "PhysicsSystem.h"
+#include "WorldServer.h"
+
+namespace {
+
+void populate(EntityManager &em, uint32_t world, int asteroids) {
+  const float bound = PhysicsSystem::worldBound;
+  std::mt19937 rng(world + 1);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+
+  Entity ship;
+  ship.type = EntityType::Ship;
+  ship.radius = 16.0f;
+  em.createEntity(ship);
+
+  int count = asteroids * (1 + (int)(world % 4)) / 2;
+  for (int i = 0; i < count; i++) {
+    Entity e;
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    e.velocity = {(unit() - 0.5f) * 0.2f, (unit() - 0.5f) * 0.2f};
+    e.radius = 8.0f + unit() * 12.0f;
+    em.createEntity(e);
+  }
+}
+
+// The ship (entity 0) spins and fires every tenth tick, as if someone were
+// playing.
+void play(EntityManager &em, uint64_t tick) {
+  std::vector<Entity> &entities = em.getEntities();
+  Entity &ship = entities[0];
+  ship.angularVelocity = 90.0f;
+  if (tick % 10) return;
+
+  float rad = glm::radians(ship.angle + 90.0f);
+  glm::vec2 dir(std::cos(rad), std::sin(rad));
+  Entity bullet;
+  bullet.type = EntityType::Bullet;
+  bullet.radius = 2.0f;
+  bullet.ttl = 1.5f;
+  bullet.position = ship.position + dir * 0.2f;
+  bullet.velocity = dir * 2.0f;
+  for (Entity &e : entities) {
+    if (e.type == EntityType::Bullet && e.radius < 0) {
+      e = bullet;
+      return;
+    }
+  }
+  em.createEntity(bullet);
+}
+
+double percentile(std::vector<double> v, double p) {
+  std::sort(v.begin(), v.end());
+  return v.empty() ? 0.0 : v[(size_t)(p * (v.size() - 1))];
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int worldCount = 64;
+  int asteroids = 200;
+  float seconds = 10.0f;
+  int threads = (int)JobSystem::defaultWorkerCount() + 1;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--worlds"))
+      worldCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--asteroids"))
+      asteroids = std::atoi(next());
+    else if (!strcmp(argv[i], "--seconds"))
+      seconds = (float)std::atof(next());
+    else if (!strcmp(argv[i], "--threads"))
+      threads = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (threads < 1) threads = 1;
+
+  JobSystem jobs((unsigned)(threads - 1));
+  const float dt = 1.0f / 60.0f;
+  const int ticks = (int)std::lround(seconds / dt);
+
+  // Pinned: the server, fed a fixed 60 Hz clock four ticks at a time.
+  WorldServer server(jobs);
+  server.setRebalanceInterval(120);
+  std::vector<uint64_t> played(worldCount, 0);
+  for (int w = 0; w < worldCount; w++) {
+    populate(server.getEntities(server.addWorld()), w, asteroids);
+  }
+  server.setTickFunction(
+      [&](uint32_t world, EntityManager &em, float) { play(em, played[world]++); });
+
+  auto start = std::chrono::steady_clock::now();
+  for (int done = 0; done < ticks;) done += server.update(4 * dt + 1e-6f);
+  double pinnedSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<double> costs;
+  for (int w = 0; w < worldCount; w++) costs.push_back(server.getStats(w).averageTickMs);
+  double meanCost = 0.0;
+  for (double c : costs) meanCost += c;
+  meanCost /= worldCount;
+
+  // Shared: every world is up for grabs by any thread each round.
+  struct Match {
+    EntityManager entities;
+    PhysicsSystem physics;
+    uint64_t played = 0;
+  };
+  std::vector<std::unique_ptr<Match>> matches;
+  for (int w = 0; w < worldCount; w++) {
+    matches.push_back(std::make_unique<Match>());
+    matches.back()->physics.setBroadphase(createBroadphase("grid"));
+    populate(matches.back()->entities, w, asteroids);
+  }
+  start = std::chrono::steady_clock::now();
+  for (int done = 0; done < ticks; done += 4) {
+    jobs.parallelFor(matches.size(), 1, [&](size_t begin, size_t end) {
+      for (size_t w = begin; w < end; w++) {
+        Match &m = *matches[w];
+        for (int t = 0; t < 4; t++) {
+          play(m.entities, m.played++);
+          m.physics.update(m.entities, dt);
+        }
+      }
+    });
+  }
+  double sharedSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << worldCount << " worlds, " << ticks << " ticks, " << server.getThreadCount()
+            << " threads\n";
+  std::cout << "tick cost per world: mean " << meanCost << " ms, p50 " << percentile(costs, 0.5)
+            << " ms, p99 " << percentile(costs, 0.99) << " ms, worst single tick ";
+  double worst = 0.0;
+  for (int w = 0; w < worldCount; w++) worst = std::max(worst, server.getStats(w).maxTickMs);
+  std::cout << worst << " ms\n";
+  std::cout << "thread load (ms/tick):";
+  for (unsigned t = 0; t < server.getThreadCount(); t++) {
+    std::cout << " " << server.getThreadLoadMs(t);
+  }
+  std::cout << "\n";
+  std::cout << "matches per core at 60 Hz: " << (1000.0 / 60.0) / meanCost << "\n";
+  std::cout << "pinned: " << (pinnedSeconds / seconds) << " s per simulated second, "
+            << (worldCount * (double)ticks / pinnedSeconds) << " world-ticks/s\n";
+  std::cout << "shared: " << (sharedSeconds / seconds) << " s per simulated second, "
+            << (worldCount * (double)ticks / sharedSeconds) << " world-ticks/s\n";
+  return 0;
+}
@@ -0,0 +1,296 @@
+// shard_bench.cpp
+// Runs the world split into regions, one WorldShard per process (forked),
+// on 1, 2, 4 and 8 processes.
+//
+//   whiskers_shard_bench [--entities N] [--ticks T] [--max-processes P]
+//
+// First a migration check for each layout, without a broadphase so the
+// physics is integration alone: every entity must come back exactly once,
+// inside its final shard's region, and bit for bit where a single-process
+// run puts it, after crossing borders. Then a timed run with the grid
+// broadphase and collisions across borders, reporting the slowest shard's
+// time per tick, the speedup over one process, and handoffs and ghosts per
+// tick. The speedup can't exceed the number of cores (printed alongside).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+#include "WorldShard.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+int main() {
+  std::cout << "shard: needs fork and POSIX sockets, skipped\n";
+  return 0;
+}
+
+#else
+
+namespace {
+
+constexpr float kDt = 1.0f / 60.0f;
+
+std::vector<Entity> makeWorld(int count) {
+  const float bound = PhysicsSystem::worldBound;
+  std::mt19937 rng(5);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  std::vector<Entity> world;
+  for (int i = 0; i < count; i++) {
+    Entity e;
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    // Fast enough that plenty cross a border within a few hundred ticks.
+    e.velocity = {(unit() - 0.5f) * 0.6f, (unit() - 0.5f) * 0.6f};
+    e.radius = 2.0f + unit() * 2.0f;
+    world.push_back(e);
+  }
+  return world;
+}
+
+bool writeAll(int fd, const void *data, size_t size) {
+  const char *p = (const char *)data;
+  while (size > 0) {
+    ssize_t n = write(fd, p, size);
+    if (n <= 0) return false;
+    p += n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+bool readAll(int fd, void *data, size_t size) {
+  char *p = (char *)data;
+  while (size > 0) {
+    ssize_t n = read(fd, p, size);
+    if (n <= 0) return false;
+    p += n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+// What each shard process sends back when it's done.
+struct ShardResult {
+  std::vector<uint32_t> ids;
+  std::vector<Entity> entities;
+  WorldShard::Stats stats;
+  double loopMs = 0.0;
+};
+
+// Ticks one shard in a child process and writes its result to `out`.
+void runChild(const ShardLayout &layout, int region, const std::vector<Entity> &world,
+              std::vector<std::pair<int, int>> links, int ticks, bool collide, int out) {
+  WorldShard shard(layout, region);
+  for (auto [neighbour, fd] : links) shard.addLink(neighbour, fd);
+  for (uint32_t id = 0; id < world.size(); id++) {
+    if (layout.regionOf(world[id].position) == region) shard.addEntity(id, world[id]);
+  }
+  if (collide) shard.getPhysics().setBroadphase(createBroadphase("grid"));
+
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < ticks; t++) {
+    if (!shard.tick(kDt)) _exit(1);
+  }
+  double loopMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  uint32_t count = (uint32_t)shard.getIds().size();
+  bool ok = writeAll(out, &count, sizeof(count)) &&
+            writeAll(out, shard.getIds().data(), count * sizeof(uint32_t)) &&
+            writeAll(out, shard.getEntities().data(), count * sizeof(Entity)) &&
+            writeAll(out, &shard.getStats(), sizeof(WorldShard::Stats)) &&
+            writeAll(out, &loopMs, sizeof(loopMs));
+  _exit(ok ? 0 : 1);
+}
+
+// Forks a shard per region, linked to its neighbours, runs them for
+// `ticks` and collects their results. False if any failed.
+bool runSharded(const ShardLayout &layout, const std::vector<Entity> &world, int ticks,
+                bool collide, std::vector<ShardResult> &results) {
+  const int regions = layout.getRegionCount();
+  std::vector<std::vector<std::pair<int, int>>> links(regions);
+  std::vector<int> near;
+  for (int a = 0; a < regions; a++) {
+    layout.neighbours(a, near);
+    for (int b : near) {
+      if (b < a) continue;
+      int fa, fb;
+      if (!WorldShard::createLinkPair(fa, fb)) return false;
+      links[a].push_back({b, fa});
+      links[b].push_back({a, fb});
+    }
+  }
+
+  std::vector<int> resultFds(regions);
+  std::vector<pid_t> children(regions);
+  for (int r = 0; r < regions; r++) {
+    int ends[2];
+    if (!WorldShard::createLinkPair(ends[0], ends[1])) return false;
+    pid_t pid = fork();
+    if (pid < 0) {
+      std::cerr << "fork failed\n";
+      return false;
+    }
+    if (pid == 0) {
+      close(ends[0]);
+      for (int other = 0; other < regions; other++) {
+        if (other == r) continue;
+        for (auto [neighbour, fd] : links[other]) close(fd);
+      }
+      for (int earlier = 0; earlier < r; earlier++) close(resultFds[earlier]);
+      runChild(layout, r, world, links[r], ticks, collide, ends[1]);
+    }
+    close(ends[1]);
+    resultFds[r] = ends[0];
+    children[r] = pid;
+  }
+  for (auto &l : links) {
+    for (auto [neighbour, fd] : l) close(fd);
+  }
+
+  bool ok = true;
+  results.assign(regions, {});
+  for (int r = 0; r < regions; r++) {
+    ShardResult &res = results[r];
+    uint32_t count = 0;
+    ok = ok && readAll(resultFds[r], &count, sizeof(count));
+    if (ok) {
+      res.ids.resize(count);
+      res.entities.resize(count);
+    }
+    ok = ok && readAll(resultFds[r], res.ids.data(), count * sizeof(uint32_t)) &&
+         readAll(resultFds[r], res.entities.data(), count * sizeof(Entity)) &&
+         readAll(resultFds[r], &res.stats, sizeof(WorldShard::Stats)) &&
+         readAll(resultFds[r], &res.loopMs, sizeof(res.loopMs));
+    close(resultFds[r]);
+  }
+  for (pid_t pid : children) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  if (!ok) std::cerr << "a shard failed\n";
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int entityCount = 20000;
+  int ticks = 300;
+  int maxProcesses = 8;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--ticks"))
+      ticks = std::atoi(next());
+    else if (!strcmp(argv[i], "--max-processes"))
+      maxProcesses = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  const std::vector<Entity> world = makeWorld(entityCount);
+  std::vector<ShardLayout> layouts;
+  for (auto [columns, rows] : {std::pair{1, 1}, {2, 1}, {2, 2}, {4, 2}}) {
+    ShardLayout layout;
+    layout.columns = columns;
+    layout.rows = rows;
+    if (layout.getRegionCount() <= maxProcesses) layouts.push_back(layout);
+  }
+
+  // The reference: one process, integration only.
+  EntityManager reference;
+  PhysicsSystem referencePhysics;
+  for (const Entity &e : world) reference.createEntity(e);
+  for (int t = 0; t < ticks; t++) referencePhysics.update(reference, kDt);
+  const std::vector<Entity> &expected = reference.getEntities();
+
+  bool allValid = true;
+  std::cout << "shard: " << entityCount << " entities, " << ticks << " ticks, "
+            << sysconf(_SC_NPROCESSORS_ONLN) << " cores\n";
+  std::cout << "  migration (no broadphase, against one process):\n";
+  for (const ShardLayout &layout : layouts) {
+    std::vector<ShardResult> results;
+    if (!runSharded(layout, world, ticks, false, results)) return 1;
+
+    std::vector<int> seen(world.size(), 0);
+    size_t exact = 0, misplaced = 0, handoffs = 0, strays = 0;
+    for (int r = 0; r < layout.getRegionCount(); r++) {
+      const ShardResult &res = results[r];
+      handoffs += res.stats.handoffsOut;
+      strays += res.stats.strays;
+      for (size_t i = 0; i < res.ids.size(); i++) {
+        uint32_t id = res.ids[i];
+        if (id >= world.size()) continue;
+        seen[id]++;
+        if (!std::memcmp(&res.entities[i], &expected[id], sizeof(Entity))) exact++;
+        if (layout.regionOf(res.entities[i].position) != r) misplaced++;
+      }
+    }
+    size_t once = 0;
+    for (int s : seen) once += s == 1;
+    bool valid = once == world.size() && exact == world.size() && misplaced == 0 &&
+                 strays == 0 && (layout.getRegionCount() == 1 || handoffs > 0);
+    allValid = allValid && valid;
+    std::cout << "    " << layout.columns << "x" << layout.rows << "  " << handoffs
+              << " handoffs, " << once << "/" << world.size() << " once, " << exact
+              << " exact, " << misplaced << " misplaced  " << (valid ? "ok" : "FAILED") << "\n";
+  }
+
+  std::cout << "  timed (grid broadphase, collisions across borders):\n";
+  double baseMs = 0.0;
+  for (const ShardLayout &layout : layouts) {
+    std::vector<ShardResult> results;
+    if (!runSharded(layout, world, ticks, true, results)) return 1;
+
+    double slowestMs = 0.0, updateMs = 0.0, exchangeMs = 0.0;
+    size_t total = 0;
+    uint64_t handoffs = 0, ghosts = 0;
+    for (const ShardResult &res : results) {
+      slowestMs = std::max(slowestMs, res.loopMs);
+      updateMs = std::max(updateMs, res.stats.updateMs);
+      exchangeMs = std::max(exchangeMs, res.stats.exchangeMs);
+      total += res.ids.size();
+      handoffs += res.stats.handoffsOut;
+      ghosts += res.stats.ghostsOut;
+    }
+    if (total != world.size()) {
+      std::cout << "    " << layout.columns << "x" << layout.rows << "  lost entities: " << total
+                << " of " << world.size() << "\n";
+      allValid = false;
+      continue;
+    }
+    double perTick = slowestMs / ticks;
+    const int processes = layout.getRegionCount();
+    if (processes == 1) baseMs = perTick;
+    std::cout << "    " << processes << " process" << (processes == 1 ? "" : "es") << " ("
+              << layout.columns << "x" << layout.rows << ")  " << perTick
+              << " ms/tick (physics " << updateMs / ticks << ", exchange " << exchangeMs / ticks
+              << ")  speedup " << (baseMs > 0.0 ? baseMs / perTick : 0.0) << "x  "
+              << (double)handoffs / ticks << " handoffs, " << (double)ghosts / ticks
+              << " ghosts per tick\n";
+  }
+
+  return allValid ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,205 @@
+// shm_bench.cpp
+// Measures what sharing the entity array costs the game, and what a tool in
+// another process gets out of it. The game runs physics over N entities and
+// publishes EntityManager's array to a SharedEntityStore every tick while a
+// forked reader copies out whole ticks, a thousand times a second like a
+// sampling profiler would.
+//
+//   whiskers_shm_bench [--entities N] [--ticks T]
+//
+// Reports the publish cost against the physics tick, and the reader's rate
+// and torn-read retries. Then a torn-read check: the writer publishes
+// flat out with every entity stamped with the tick, and every tick the
+// reader accepts must carry that stamp on every entity.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+#include "SharedEntityStore.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+int main() {
+  std::cout << "shm: needs POSIX shared memory, skipped\n";
+  return 0;
+}
+
+#else
+
+namespace {
+
+// What the reader process reports back.
+struct ReaderResult {
+  uint64_t reads = 0;
+  uint64_t retries = 0;
+  uint64_t distinctTicks = 0;
+  uint64_t inconsistent = 0;  // accepted reads that mixed ticks
+  double readUs = 0.0;
+};
+
+double elapsedUs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Reads `name` until the writer publishes `lastTick`, then writes the
+// result to `out`. With `stamped`, reads flat out and checks every
+// entity's ttl is its tick; otherwise pauses a millisecond between reads.
+void runReader(const std::string &name, uint64_t lastTick, bool stamped, int out) {
+  SharedEntityStore store;
+  if (!store.open(name)) _exit(1);
+  ReaderResult result;
+  std::vector<Entity> copy;
+  uint64_t tick = 0, previous = UINT64_MAX;
+  for (;;) {
+    auto start = std::chrono::steady_clock::now();
+    if (!store.read(copy, tick)) {
+      usleep(100);  // nothing published yet, or the writer kept winning
+      continue;
+    }
+    result.readUs += elapsedUs(start);
+    result.reads++;
+    if (tick != previous) result.distinctTicks++;
+    previous = tick;
+    if (stamped) {
+      for (const Entity &e : copy) {
+        if (e.ttl != (float)tick) {
+          result.inconsistent++;
+          break;
+        }
+      }
+    }
+    if (tick >= lastTick) break;
+    if (!stamped) usleep(1000);
+  }
+  result.retries = store.getRetries();
+  _exit(write(out, &result, sizeof(result)) == (ssize_t)sizeof(result) ? 0 : 1);
+}
+
+bool startReader(const std::string &name, uint64_t lastTick, bool stamped, pid_t &pid, int &fd) {
+  int ends[2];
+  if (pipe(ends) != 0) return false;
+  pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    close(ends[0]);
+    runReader(name, lastTick, stamped, ends[1]);
+  }
+  close(ends[1]);
+  fd = ends[0];
+  return true;
+}
+
+bool finishReader(pid_t pid, int fd, ReaderResult &result) {
+  bool ok = read(fd, &result, sizeof(result)) == (ssize_t)sizeof(result);
+  close(fd);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int entityCount = 20000;
+  int ticks = 300;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--ticks"))
+      ticks = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (ticks < 1) ticks = 1;
+  const std::string name = "/whiskers_shm_bench_" + std::to_string(getpid());
+  const float dt = 1.0f / 60.0f;
+
+  EntityManager em;
+  {
+    const float bound = PhysicsSystem::worldBound;
+    std::mt19937 rng(7);
+    auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+    for (int i = 0; i < entityCount; i++) {
+      Entity e;
+      e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+      e.velocity = {(unit() - 0.5f) * 0.2f, (unit() - 0.5f) * 0.2f};
+      e.radius = 1.0f + unit();
+      em.createEntity(e);
+    }
+  }
+  PhysicsSystem physics;
+  physics.setBroadphase(createBroadphase("grid"));
+  SharedEntityStore shared;
+  if (!shared.create(name, (size_t)entityCount)) return 1;
+
+  // A live game with a reader attached.
+  pid_t pid;
+  int fd;
+  if (!startReader(name, (uint64_t)ticks, false, pid, fd)) return 1;
+  double tickUs = 0.0, publishUs = 0.0;
+  for (int t = 1; t <= ticks; t++) {
+    auto start = std::chrono::steady_clock::now();
+    physics.update(em, dt);
+    tickUs += elapsedUs(start);
+    start = std::chrono::steady_clock::now();
+    shared.publish(em.getEntities(), (uint64_t)t);
+    publishUs += elapsedUs(start);
+  }
+  ReaderResult live;
+  if (!finishReader(pid, fd, live)) {
+    std::cerr << "reader failed\n";
+    return 1;
+  }
+
+  std::cout << "shm: " << entityCount << " entities ("
+            << entityCount * sizeof(Entity) / 1024 << " KiB shared), " << ticks << " ticks\n";
+  std::cout << "  physics tick   " << tickUs / ticks << " us\n";
+  std::cout << "  publish        " << publishUs / ticks << " us ("
+            << 100.0 * publishUs / tickUs << "% of the tick)\n";
+  std::cout << "  reader         " << live.reads << " reads of " << live.distinctTicks
+            << " ticks, " << (live.reads ? live.readUs / live.reads : 0.0) << " us each, "
+            << live.retries << " retried\n";
+
+  // Torn-read check: publish flat out, every entity stamped with the tick,
+  // into a fresh segment so the reader can't see the unstamped ticks.
+  const uint64_t stampedTicks = 2000;
+  if (!shared.create(name, (size_t)entityCount)) return 1;
+  if (!startReader(name, stampedTicks, true, pid, fd)) return 1;
+  std::vector<Entity> &entities = em.getEntities();
+  for (uint64_t t = 1; t <= stampedTicks; t++) {
+    for (Entity &e : entities) e.ttl = (float)t;
+    shared.publish(entities, t);
+  }
+  ReaderResult check;
+  if (!finishReader(pid, fd, check)) {
+    std::cerr << "reader failed\n";
+    return 1;
+  }
+  shared.close();
+
+  bool ok = check.inconsistent == 0;
+  std::cout << "  torn reads     " << check.reads << " reads while publishing flat out, "
+            << check.retries << " retried, " << check.inconsistent << " mixed ticks  "
+            << (ok ? "ok" : "FAILED") << "\n";
+  return ok ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,159 @@
+// snapshot_bench.cpp
+// Measures SnapshotCodec on a running world: bytes per entity for a full
+// snapshot (no baseline) and for deltas against baselines a few ticks old,
+// next to the full-float encoding GameServer used before, plus encode and
+// decode throughput. Every decode is checked against what was encoded.
+//
+//   whiskers_snapshot_bench [--entities N] [--ticks T]
+//
+// The world is small asteroids drifting and colliding, with a tenth of the
+// slots bullets that expire and respawn, so some slots die and come back
+// every tick.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+#include "SnapshotCodec.h"
+
+namespace {
+
+constexpr float kTickInterval = 1.0f / 60.0f;
+constexpr size_t kFloatEntityBytes = 29;  // u32 index, u8 type, six f32
+
+void populate(EntityManager &em, int count, std::mt19937 &rng) {
+  const float bound = PhysicsSystem::worldBound;
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (int i = 0; i < count; i++) {
+    Entity e;
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    e.velocity = {(unit() - 0.5f) * 0.2f, (unit() - 0.5f) * 0.2f};
+    e.radius = 1.5f + unit() * 1.5f;
+    if (i % 10 == 0) {
+      e.type = EntityType::Bullet;
+      e.radius = 1.0f;
+      e.ttl = unit() * 1.5f;
+      e.velocity *= 10.0f;
+    }
+    em.createEntity(e);
+  }
+}
+
+// Dead bullets come back somewhere else.
+void respawnBullets(std::vector<Entity> &entities, std::mt19937 &rng) {
+  const float bound = PhysicsSystem::worldBound;
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (Entity &e : entities) {
+    if (e.type != EntityType::Bullet || e.radius >= 0) continue;
+    if (rng() % 4) continue;  // stay dead for a tick or so
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    float rad = unit() * 6.2831853f;
+    e.velocity = {std::cos(rad) * 2.0f, std::sin(rad) * 2.0f};
+    e.radius = 1.0f;
+    e.ttl = 1.5f;
+  }
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int entityCount = 10000;
+  int ticks = 120;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--ticks"))
+      ticks = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  std::mt19937 rng(1);
+  EntityManager em;
+  populate(em, entityCount, rng);
+  PhysicsSystem physics;
+  physics.setBroadphase(createBroadphase("grid"));
+  for (int t = 0; t < 60; t++) {
+    physics.update(em, kTickInterval);
+    respawnBullets(em.getEntities(), rng);
+  }
+
+  // Baseline ages to try; 0 means none (a full snapshot).
+  const int ages[] = {0, 3, 6, 12};
+  const int ageCount = sizeof(ages) / sizeof(ages[0]);
+  const int oldest = 12;
+
+  std::deque<std::vector<QuantizedEntity>> history;  // newest at the back
+  std::vector<QuantizedEntity> decoded;
+  std::vector<uint8_t> bytes;
+  double totalBytes[ageCount] = {}, encodeTime[ageCount] = {}, decodeTime[ageCount] = {};
+  int samples = 0;
+  size_t live = 0;
+
+  for (int t = 0; t < ticks + oldest; t++) {
+    physics.update(em, kTickInterval);
+    respawnBullets(em.getEntities(), rng);
+    history.emplace_back();
+    SnapshotCodec::quantize(em.getEntities(), history.back());
+    if ((int)history.size() > oldest + 1) history.pop_front();
+    if ((int)history.size() <= oldest) continue;
+
+    const std::vector<QuantizedEntity> &current = history.back();
+    for (int a = 0; a < ageCount; a++) {
+      const std::vector<QuantizedEntity> *baseline =
+          ages[a] ? &history[history.size() - 1 - ages[a]] : nullptr;
+      float elapsed = ages[a] * kTickInterval;
+
+      bytes.clear();
+      auto start = std::chrono::steady_clock::now();
+      SnapshotCodec::encode(current, baseline, elapsed, bytes);
+      encodeTime[a] += seconds(start);
+
+      start = std::chrono::steady_clock::now();
+      bool ok = SnapshotCodec::decode(bytes.data(), bytes.size(), baseline, elapsed, decoded);
+      decodeTime[a] += seconds(start);
+
+      if (!ok || decoded != current) {
+        std::cerr << "decode mismatch at tick " << t << ", baseline age " << ages[a] << "\n";
+        return 1;
+      }
+      totalBytes[a] += bytes.size();
+    }
+    for (const QuantizedEntity &q : current) live += q.alive;
+    samples++;
+  }
+
+  const double entities = (double)samples * entityCount;
+  std::cout << "snapshot codec: " << entityCount << " entities ("
+            << (double)live / samples << " live on average), " << samples
+            << " snapshots, all decoded exactly\n";
+  std::cout << "  full floats          " << kFloatEntityBytes << " bytes/live entity, "
+            << kFloatEntityBytes * live / samples << " bytes/snapshot\n";
+  for (int a = 0; a < ageCount; a++) {
+    if (ages[a])
+      std::cout << "  delta, " << ages[a] << (ages[a] < 10 ? "  ticks old  " : " ticks old  ");
+    else
+      std::cout << "  no baseline          ";
+    std::cout << totalBytes[a] / entities << " bytes/entity, " << totalBytes[a] / samples
+              << " bytes/snapshot; encode " << entities / encodeTime[a] / 1e6
+              << " M entities/s, decode " << entities / decodeTime[a] / 1e6
+              << " M entities/s\n";
+  }
+  return 0;
+}
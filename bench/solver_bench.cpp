@@ -0,0 +1,140 @@
+// solver_bench.cpp
+// Steps a dense asteroid field through broadphase, narrowphase and
+// ContactSolver with 1, 2, 4, ... threads, timing each stage, and checks the
+// final state is bit-identical for every thread count.
+//
+//   whiskers_solver_bench [--asteroids N] [--steps K] [--threads MAX] [--iterations I]
+//                         [--min-radius PX] [--max-radius PX]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Broadphase.h"
+#include "ContactSolver.h"
+#include "JobSystem.h"
+#include "Narrowphase.h"
+#include "PhysicsSystem.h"
+
+namespace {
+
+struct Result {
+  uint64_t hash = 0;
+  double detectMs = 0.0, solveMs = 0.0;
+  double contacts = 0.0;
+  size_t colors = 0;
+};
+
+// FNV-1a over the positions and velocities.
+uint64_t hashState(const std::vector<Entity> &entities) {
+  uint64_t h = 1469598103934665603ull;
+  for (const Entity &e : entities) {
+    const float values[4] = {e.position.x, e.position.y, e.velocity.x, e.velocity.y};
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(values);
+    for (size_t i = 0; i < sizeof(values); i++) h = (h ^ bytes[i]) * 1099511628211ull;
+  }
+  return h;
+}
+
+Result simulate(std::vector<Entity> entities, int steps, unsigned threads, int iterations) {
+  JobSystem jobs(threads - 1);
+  std::unique_ptr<Broadphase> broadphase = createBroadphase("grid");
+  Narrowphase narrowphase;
+  ContactSolver solver;
+  solver.setIterations(iterations);
+  std::vector<BroadphasePair> pairs;
+  std::vector<Contact> contacts;
+
+  const float dt = 1.0f / 60.0f;
+  const float bound = PhysicsSystem::worldBound;
+  const float period = 2.0f * bound;
+  Result result;
+  double detect = 0.0, solve = 0.0;
+  for (int s = 0; s < steps; s++) {
+    for (Entity &e : entities) {
+      e.position += e.velocity * dt;
+      e.position.x -= period * std::floor((e.position.x + bound) / period);
+      e.position.y -= period * std::floor((e.position.y + bound) / period);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    broadphase->findPairs(entities, pairs);
+    narrowphase.findContacts(entities, pairs, contacts);
+    auto detected = std::chrono::steady_clock::now();
+    solver.solve(entities, contacts, threads > 1 ? &jobs : nullptr);
+    auto solved = std::chrono::steady_clock::now();
+
+    detect += std::chrono::duration<double>(detected - start).count();
+    solve += std::chrono::duration<double>(solved - detected).count();
+    result.contacts += solver.getConstraintCount();
+    result.colors = std::max(result.colors, solver.getColorCount());
+  }
+  result.hash = hashState(entities);
+  result.detectMs = detect * 1000.0 / steps;
+  result.solveMs = solve * 1000.0 / steps;
+  result.contacts /= steps;
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int asteroidCount = 50000;
+  int steps = 120;
+  unsigned maxThreads = JobSystem::defaultWorkerCount() + 1;
+  int iterations = 4;
+  float minRadius = 1.0f, maxRadius = 2.0f;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--asteroids"))
+      asteroidCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--steps"))
+      steps = std::atoi(next());
+    else if (!strcmp(argv[i], "--threads"))
+      maxThreads = (unsigned)std::max(1, std::atoi(next()));
+    else if (!strcmp(argv[i], "--iterations"))
+      iterations = std::atoi(next());
+    else if (!strcmp(argv[i], "--min-radius"))
+      minRadius = (float)std::atof(next());
+    else if (!strcmp(argv[i], "--max-radius"))
+      maxRadius = (float)std::atof(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
+  const float bound = PhysicsSystem::worldBound;
+  std::vector<Entity> entities(asteroidCount);
+  std::mt19937 rng(11);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (Entity &e : entities) {
+    e.type = EntityType::Asteroid;
+    e.radius = minRadius + unit() * (maxRadius - minRadius);
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    float heading = unit() * 2.0f * glm::pi<float>();
+    e.velocity = glm::vec2(std::cos(heading), std::sin(heading)) * (0.05f + unit() * 0.15f);
+  }
+
+  std::cout << asteroidCount << " asteroids of " << minRadius << "-" << maxRadius << " px, "
+            << steps << " steps at 60 Hz, " << iterations << " iterations\n";
+  uint64_t reference = 0;
+  bool ok = true;
+  for (unsigned threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+    Result r = simulate(entities, steps, threads, iterations);
+    if (threads == 1) reference = r.hash;
+    bool match = r.hash == reference;
+    ok = ok && match;
+    std::cout << threads << " threads: " << r.contacts << " contacts/step, " << r.colors
+              << " colours, detect " << r.detectMs << " ms, solve " << r.solveMs
+              << " ms/step, state " << std::hex << r.hash << std::dec
+              << (match ? "" : "  MISMATCH") << "\n";
+    if (threads == maxThreads) break;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// statehash_bench.cpp
+// Times StateHasher at each SIMD level against a physics tick at N
+// entities and reports the hash as a share of the tick; the target is under
+// 1% at 100k. Checks that every level gives the same hash. Then plays two
+// runs of the same world, nudges one entity in the second run partway
+// through, and finds the tick and entity from the two runs' hash logs.
+//
+//   whiskers_statehash_bench [--entities N] [--ticks T] [--reps K]
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "Broadphase.h"
+#include "EntityManager.h"
+#include "PhysicsSystem.h"
+#include "StateHasher.h"
+
+namespace {
+
+void populate(EntityManager &em, int count) {
+  const float bound = PhysicsSystem::worldBound;
+  std::mt19937 rng(1);
+  auto unit = [&]() { return (rng() >> 8) * (1.0f / 16777216.0f); };
+  for (int i = 0; i < count; i++) {
+    Entity e;
+    e.position = {unit() * 2.0f * bound - bound, unit() * 2.0f * bound - bound};
+    e.velocity = {(unit() - 0.5f) * 0.2f, (unit() - 0.5f) * 0.2f};
+    e.radius = 1.0f + unit();
+    em.createEntity(e);
+  }
+}
+
+double elapsedUs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int entityCount = 100000;
+  int ticks = 60;
+  int reps = 200;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--entities"))
+      entityCount = std::atoi(next());
+    else if (!strcmp(argv[i], "--ticks"))
+      ticks = std::atoi(next());
+    else if (!strcmp(argv[i], "--reps"))
+      reps = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (ticks < 2) ticks = 2;
+
+  const float dt = 1.0f / 60.0f;
+
+  // Tick cost, then hash cost on the resulting state.
+  EntityManager em;
+  PhysicsSystem physics;
+  physics.setBroadphase(createBroadphase("grid"));
+  populate(em, entityCount);
+  physics.update(em, dt);
+  double tickUs = 0.0;
+  for (int t = 0; t < 10; t++) {
+    auto start = std::chrono::steady_clock::now();
+    physics.update(em, dt);
+    tickUs += elapsedUs(start);
+  }
+  tickUs /= 10;
+
+  const std::vector<Entity> &entities = em.getEntities();
+  std::cout << "state hash: " << entities.size() << " entities ("
+            << entities.size() * sizeof(Entity) / 1024 << " KiB), physics tick " << tickUs
+            << " us\n";
+  bool agree = true;
+  uint64_t reference = 0;
+  for (Narrowphase::Simd level :
+       {Narrowphase::Simd::Scalar, Narrowphase::Simd::SSE2, Narrowphase::Simd::AVX2}) {
+    if (level > Narrowphase::bestSimd()) continue;
+    StateHasher hasher;
+    hasher.setSimd(level);
+    uint64_t hash = hasher.update(0, entities);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) hash = hasher.update((uint32_t)r, entities);
+    double us = elapsedUs(start) / reps;
+    if (level == Narrowphase::Simd::Scalar)
+      reference = hash;
+    else if (hash != reference)
+      agree = false;
+    std::cout << "  " << Narrowphase::simdName(level) << "\t" << us << " us, "
+              << entities.size() * sizeof(Entity) / us / 1e3 << " GB/s, " << 100.0 * us / tickUs
+              << "% of tick\n";
+  }
+  std::cout << "  levels agree: " << (agree ? "yes" : "NO") << "\n";
+
+  // Two runs from the same start; the second has one entity's angle changed
+  // by one ulp at tick `bump`. Angles don't feed back into the physics, so
+  // it stays a one-entity, one-bit desync: the kind that's hard to spot.
+  const uint32_t bump = (uint32_t)ticks / 2;
+  const size_t victim = (size_t)entityCount * 3 / 4;
+  std::stringstream logs[2];
+  std::vector<Entity> finals[2];
+  for (int run = 0; run < 2; run++) {
+    EntityManager world;
+    PhysicsSystem sim;
+    sim.setBroadphase(createBroadphase("grid"));
+    populate(world, entityCount);
+    StateHasher hasher;
+    hasher.setLog(&logs[run], true);
+    for (uint32_t t = 0; t < (uint32_t)ticks; t++) {
+      if (run == 1 && t == bump) {
+        Entity &e = world.getEntities()[victim];
+        e.angle = std::nextafter(e.angle, 1.0f);
+      }
+      sim.update(world, dt);
+      hasher.update(t, world.getEntities());
+    }
+    finals[run] = world.getEntities();
+  }
+
+  StateHasher::Divergence d;
+  if (!StateHasher::findDivergence(logs[0], logs[1], d)) {
+    std::cerr << "logs agree, but the runs were made to differ\n";
+    return 1;
+  }
+  std::cout << "desync: entity " << victim << " nudged before tick " << bump << "\n";
+  std::cout << "  logs first differ at tick " << d.tick << ", entities " << d.firstEntity << ".."
+            << d.firstEntity + d.entityCount - 1 << " (" << logs[0].str().size() / ticks
+            << " bytes of log per tick)\n";
+  size_t first = StateHasher::firstDifferentEntity(finals[0], finals[1]);
+  std::cout << "  final states first differ at entity " << first << "\n";
+  bool found = d.tick == bump && victim >= d.firstEntity &&
+               victim < d.firstEntity + d.entityCount && first == victim;
+  std::cout << "  located: " << (found ? "yes" : "NO") << "\n";
+  return agree && found ? 0 : 1;
+}
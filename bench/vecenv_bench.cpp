@@ -0,0 +1,113 @@
+// vecenv_bench.cpp
+// Steps a VecEnv with random actions and reports env-steps per second at one
+// thread and at --threads, checking both runs produce the same observations.
+//
+//   whiskers_vecenv_bench [--worlds N] [--steps K] [--asteroids A] [--threads T]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "JobSystem.h"
+#include "VecEnv.h"
+
+namespace {
+
+struct Run {
+  double seconds = 0.0;
+  uint64_t hash = 0;
+  size_t episodes = 0;
+  double reward = 0.0;
+};
+
+// FNV-1a over the observation buffer.
+uint64_t hashObservations(const VecEnv &env) {
+  const size_t count = env.getWorldCount() * env.getObservationSize();
+  const auto *bytes = reinterpret_cast<const uint8_t *>(env.getObservations());
+  uint64_t h = 1469598103934665603ull;
+  for (size_t i = 0; i < count * sizeof(float); i++) h = (h ^ bytes[i]) * 1099511628211ull;
+  return h;
+}
+
+Run run(int worlds, int steps, uint32_t asteroids, unsigned workers,
+        const std::vector<VecEnv::Action> &actionTable) {
+  JobSystem jobs(workers);
+  VecEnv env(worlds, asteroids, 42);
+  env.setJobSystem(&jobs);
+
+  // Actions cycle through a precomputed table so generating them costs
+  // nothing next to stepping.
+  const size_t period = actionTable.size() / worlds;
+  Run result;
+  auto start = std::chrono::steady_clock::now();
+  for (int s = 0; s < steps; s++) {
+    env.step(&actionTable[(s % period) * worlds]);
+    for (int w = 0; w < worlds; w++) {
+      result.episodes += env.getDones()[w];
+      result.reward += env.getRewards()[w];
+    }
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.hash = hashObservations(env);
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int worlds = 16384;
+  int steps = 600;
+  uint32_t asteroids = 8;
+  int threads = (int)JobSystem::defaultWorkerCount() + 1;
+
+  for (int i = 1; i < argc; i++) {
+    auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+    if (!strcmp(argv[i], "--worlds"))
+      worlds = std::atoi(next());
+    else if (!strcmp(argv[i], "--steps"))
+      steps = std::atoi(next());
+    else if (!strcmp(argv[i], "--asteroids"))
+      asteroids = (uint32_t)std::atoi(next());
+    else if (!strcmp(argv[i], "--threads"))
+      threads = std::atoi(next());
+    else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (worlds < 1 || threads < 1) {
+    std::cerr << "--worlds and --threads must be at least 1\n";
+    return 1;
+  }
+
+  std::mt19937 rng(9);
+  std::vector<VecEnv::Action> actionTable((size_t)worlds * 32);
+  for (VecEnv::Action &a : actionTable) {
+    uint32_t r = rng();
+    a.rotate = (int8_t)(r % 3) - 1;
+    a.thrust = (r >> 2) & 1;
+    a.fire = (r >> 3) & 1;
+  }
+
+  std::vector<int> threadCounts = {1};
+  if (threads > 1) threadCounts.push_back(threads);
+  bool ok = true;
+  uint64_t reference = 0;
+  for (int t : threadCounts) {
+    Run r = run(worlds, steps, asteroids, (unsigned)(t - 1), actionTable);
+    if (t == 1) reference = r.hash;
+    bool match = r.hash == reference;
+    ok = ok && match;
+    double envSteps = (double)worlds * steps;
+    std::cout << t << " thread" << (t > 1 ? "s" : "") << ": " << worlds << " worlds x " << steps
+              << " steps, " << (envSteps / r.seconds / 1e6) << " M env-steps/s, "
+              << (r.seconds * 1e9 / envSteps) << " ns/env-step, " << r.episodes
+              << " episodes, mean reward/episode " << (r.episodes ? r.reward / r.episodes : 0.0)
+              << (match ? "" : "  MISMATCH") << "\n";
+  }
+  return ok ? 0 : 1;
+}
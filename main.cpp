@@ -1,13 +1,30 @@
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
 
+#include <cstring>
 #include <iostream>
 
 #include "EntityManager.h"
+#include "GLExtensions.h"
 #include "PhysicsSystem.h"
 #include "Renderer.h"
+#include "SharedEntityStore.h"
+#include "ShipControl.h"
 
 int main(int argc, char *argv[]) {
+  // --share NAME mirrors the entities into shared memory every frame, so
+  // profilers and spectators in other processes can watch (see
+  // SharedEntityStore).
+  const char *shareName = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--share") && i + 1 < argc) {
+      shareName = argv[++i];
+    } else {
+      std::cerr << "Unknown argument: " << argv[i] << "\n";
+      return 1;
+    }
+  }
+
   if (SDL_Init(SDL_INIT_VIDEO) != 0) {
     std::cerr << "SDL_Init error: " << SDL_GetError() << "\n";
     return 1;
@@ -39,6 +56,7 @@ int main(int argc, char *argv[]) {
     std::cerr << "Failed to initialize GLAD\n";
     return 1;
   }
+  loadGLExtensions((GLADloadproc)SDL_GL_GetProcAddress);
 
   int width = 800, height = 600;
   SDL_GetWindowSize(window, &width, &height);
@@ -50,15 +68,28 @@ int main(int argc, char *argv[]) {
   }
 
   EntityManager entityManager;
+  JobSystem jobSystem;
   PhysicsSystem physicsSystem;
+  physicsSystem.setBroadphase(createBroadphase("grid"));
+  physicsSystem.setJobSystem(&jobSystem);
+  physicsSystem.setFractureEnabled(true);
 
   // Create ship
   Entity ship;
   ship.position = {0, 0};
-  ship.radius = 16.0f;
+  ship.radius = kShipRadius;
   ship.type = EntityType::Ship;
   size_t shipIdx = entityManager.createEntity(ship);
 
+  // Slots for asteroid fragments, so splits never grow the entity array.
+  physicsSystem.getFractureSystem().reserve(entityManager, 1024);
+
+  // Room for the ship, the fragment slots and plenty of bullets; a publish
+  // past it drops the rest (SharedEntityStore::getDropped).
+  SharedEntityStore sharedStore;
+  if (shareName && !sharedStore.create(shareName, 4096)) return 1;
+  uint64_t frame = 0;
+
   Uint32 lastTicks = SDL_GetTicks();
 
   bool running = true;
@@ -69,16 +100,18 @@ int main(int argc, char *argv[]) {
       // Fire bullet on key press
       if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
         Entity &ship = entityManager.getEntities()[shipIdx];  // re-fetch
-        Entity bullet;
-        bullet.type = EntityType::Bullet;
-        bullet.radius = 2.0f;
-        bullet.ttl = 1.5f;
-        float rad = glm::radians(ship.angle + 90.0f);
-        glm::vec2 dir = {cos(rad), sin(rad)};
-        bullet.position = ship.position + dir * 0.2f;
-        bullet.velocity = dir * 2.0f;
+        Entity bullet = makeBullet(ship);
         entityManager.createEntity(bullet);  // may reallocate; safe because we won’t reuse refs
       }
+      // Cycle collision broadphase
+      if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_b) {
+        const char *current = physicsSystem.getBroadphase()->name();
+        const char *next = !strcmp(current, "grid")  ? "sap"
+                           : !strcmp(current, "sap") ? "tree"
+                                                     : "grid";
+        physicsSystem.setBroadphase(createBroadphase(next));
+        std::cout << "Broadphase: " << physicsSystem.getBroadphase()->name() << "\n";
+      }
     }
 
     Uint32 currentTicks = SDL_GetTicks();
@@ -87,30 +120,15 @@ int main(int argc, char *argv[]) {
 
     const Uint8 *state = SDL_GetKeyboardState(NULL);
 
-    const float rotationSpeed = 180.0f;  // degrees per second
-    const float thrustPower = 3.0f;      // acceleration units per second²
-    const float drag = 0.995f;           // friction factor
-
-    Entity &ship = entityManager.getEntities()[shipIdx];
-    if (state[SDL_SCANCODE_A])
-      ship.angularVelocity = 180.0f;
-    else if (state[SDL_SCANCODE_D])
-      ship.angularVelocity = -180.0f;
-    else
-      ship.angularVelocity = 0.0f;
-
-    bool thrusting = false;
-    if (state[SDL_SCANCODE_W]) {
-      thrusting = true;
-      float rad = glm::radians(ship.angle + 90.0f);
-      glm::vec2 accel(cos(rad), sin(rad));
-      accel *= thrustPower;
-      ship.velocity += accel * deltaTime;
-    } else {
-      ship.velocity *= pow(drag, deltaTime * 60.0f);
-    }
+    uint8_t buttons = 0;
+    if (state[SDL_SCANCODE_W]) buttons |= kInputThrust;
+    if (state[SDL_SCANCODE_A]) buttons |= kInputLeft;
+    if (state[SDL_SCANCODE_D]) buttons |= kInputRight;
+    bool thrusting = buttons & kInputThrust;
+    steerShip(entityManager.getEntities()[shipIdx], buttons, deltaTime);
 
     physicsSystem.update(entityManager, deltaTime);
+    if (sharedStore.isOpen()) sharedStore.publish(entityManager.getEntities(), ++frame);
     // entityManager.clearDestroyed();
 
     renderer.clear();
@@ -0,0 +1,208 @@
+// atlaspack.cpp
+// Build-time atlas generator: packs sprite images into one or more atlas pages
+// with a skyline bottom-left packer and writes <prefix>_<n>.png pages plus a
+// <prefix>.atlas manifest (format documented in TextureAtlas.h). Sprites are
+// named after their file stem.
+//
+//   whiskers_atlaspack [--size N] [--padding P] <prefix> sprite.png...
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PngWriter.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+struct Sprite {
+  std::string name;
+  int width = 0, height = 0;
+  std::vector<unsigned char> rgba;
+  int page = -1, x = 0, y = 0;
+};
+
+// Skyline bottom-left packing: the page keeps the top contour of placed rects
+// as a list of horizontal segments and each rect goes where it rests lowest.
+class SkylinePage {
+ public:
+  explicit SkylinePage(int size) : size(size) { skyline.push_back({0, 0, size}); }
+
+  bool insert(int w, int h, int &outX, int &outY) {
+    int bestY = size, bestWidth = size, bestIndex = -1;
+    for (size_t i = 0; i < skyline.size(); i++) {
+      int y;
+      if (!fits(i, w, h, y)) continue;
+      if (y < bestY || (y == bestY && skyline[i].width < bestWidth)) {
+        bestY = y;
+        bestWidth = skyline[i].width;
+        bestIndex = (int)i;
+      }
+    }
+    if (bestIndex < 0) return false;
+
+    outX = skyline[bestIndex].x;
+    outY = bestY;
+    addLevel(bestIndex, outX, outY + h, w);
+    return true;
+  }
+
+ private:
+  struct Segment {
+    int x, y, width;
+  };
+
+  // Can a w*h rect sit with its left edge on segment i? y = resting height.
+  bool fits(size_t i, int w, int h, int &y) const {
+    int x = skyline[i].x;
+    if (x + w > size) return false;
+    y = skyline[i].y;
+    int remaining = w;
+    for (size_t j = i; remaining > 0; j++) {
+      if (j >= skyline.size()) return false;
+      y = std::max(y, skyline[j].y);
+      if (y + h > size) return false;
+      remaining -= skyline[j].width;
+    }
+    return true;
+  }
+
+  void addLevel(int index, int x, int y, int width) {
+    skyline.insert(skyline.begin() + index, {x, y, width});
+    // Trim or drop segments now covered by the new one.
+    for (size_t i = index + 1; i < skyline.size();) {
+      Segment &s = skyline[i];
+      int end = x + width;
+      if (s.x >= end) break;
+      int shrink = end - s.x;
+      if (shrink >= s.width) {
+        skyline.erase(skyline.begin() + i);
+        continue;
+      }
+      s.x += shrink;
+      s.width -= shrink;
+      break;
+    }
+    // Merge neighbours at the same height.
+    for (size_t i = 0; i + 1 < skyline.size();) {
+      if (skyline[i].y == skyline[i + 1].y) {
+        skyline[i].width += skyline[i + 1].width;
+        skyline.erase(skyline.begin() + i + 1);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  int size;
+  std::vector<Segment> skyline;
+};
+
+// Copies a sprite into the page and extrudes its border into the padding so
+// bilinear filtering and mip levels never pull in a neighbour's texels.
+static void blit(std::vector<unsigned char> &page, int pageSize, const Sprite &s, int padding) {
+  for (int y = -padding; y < s.height + padding; y++) {
+    int py = s.y + y;
+    if (py < 0 || py >= pageSize) continue;
+    int sy = std::min(std::max(y, 0), s.height - 1);
+    for (int x = -padding; x < s.width + padding; x++) {
+      int px = s.x + x;
+      if (px < 0 || px >= pageSize) continue;
+      int sx = std::min(std::max(x, 0), s.width - 1);
+      std::memcpy(&page[((size_t)py * pageSize + px) * 4], &s.rgba[((size_t)sy * s.width + sx) * 4],
+                  4);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int pageSize = 2048;
+  int padding = 2;
+  int arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (!strcmp(argv[arg], "--size") && arg + 1 < argc)
+      pageSize = std::atoi(argv[++arg]);
+    else if (!strcmp(argv[arg], "--padding") && arg + 1 < argc)
+      padding = std::atoi(argv[++arg]);
+    else {
+      std::cerr << "Unknown argument: " << argv[arg] << "\n";
+      return 1;
+    }
+  }
+  if (argc - arg < 2) {
+    std::cerr << "usage: " << argv[0] << " [--size N] [--padding P] <prefix> sprite.png...\n";
+    return 1;
+  }
+  std::string prefix = argv[arg++];
+
+  std::vector<Sprite> sprites;
+  for (; arg < argc; arg++) {
+    std::string path = argv[arg];
+    Sprite s;
+    int channels;
+    unsigned char *data = stbi_load(path.c_str(), &s.width, &s.height, &channels, 4);
+    if (!data) {
+      std::cerr << "Failed to load sprite: " << path << "\n";
+      return 1;
+    }
+    s.rgba.assign(data, data + (size_t)s.width * s.height * 4);
+    stbi_image_free(data);
+
+    size_t slash = path.find_last_of("/\\");
+    s.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    s.name = s.name.substr(0, s.name.find_last_of('.'));
+    if (s.width + 2 * padding > pageSize || s.height + 2 * padding > pageSize) {
+      std::cerr << "Sprite larger than atlas page: " << path << "\n";
+      return 1;
+    }
+    sprites.push_back(std::move(s));
+  }
+
+  // Tallest first packs tightest for skyline packers.
+  std::vector<Sprite *> order;
+  for (Sprite &s : sprites) order.push_back(&s);
+  std::stable_sort(order.begin(), order.end(), [](const Sprite *a, const Sprite *b) {
+    return a->height != b->height ? a->height > b->height : a->width > b->width;
+  });
+
+  std::vector<SkylinePage> pages;
+  for (Sprite *s : order) {
+    int x, y;
+    for (size_t p = 0; p <= pages.size(); p++) {
+      if (p == pages.size()) pages.emplace_back(pageSize);
+      if (pages[p].insert(s->width + 2 * padding, s->height + 2 * padding, x, y)) {
+        s->page = (int)p;
+        s->x = x + padding;
+        s->y = y + padding;
+        break;
+      }
+    }
+  }
+
+  std::string baseName = prefix.substr(prefix.find_last_of("/\\") + 1);
+  std::ofstream manifest(prefix + ".atlas");
+  if (!manifest) {
+    std::cerr << "Failed to write manifest: " << prefix << ".atlas\n";
+    return 1;
+  }
+  for (size_t p = 0; p < pages.size(); p++) {
+    std::vector<unsigned char> rgba((size_t)pageSize * pageSize * 4, 0);
+    for (const Sprite &s : sprites)
+      if (s.page == (int)p) blit(rgba, pageSize, s, padding);
+
+    std::string file = baseName + "_" + std::to_string(p) + ".png";
+    if (!writePNG(prefix + "_" + std::to_string(p) + ".png", pageSize, pageSize, rgba.data()))
+      return 1;
+    manifest << "page " << p << " " << file << " " << pageSize << " " << pageSize << "\n";
+  }
+  for (const Sprite &s : sprites) {
+    manifest << "sprite " << s.name << " " << s.page << " " << s.x << " " << s.y << " " << s.width
+             << " " << s.height << "\n";
+  }
+
+  std::cout << "Packed " << sprites.size() << " sprites into " << pages.size() << " page(s) -> "
+            << prefix << ".atlas" << std::endl;
+  return 0;
+}
@@ -0,0 +1,101 @@
+// texbake.cpp
+// Offline texture baker: decodes an image once, builds the full mip chain with
+// a 2x2 box filter and writes a .wtex container (see BakedTexture.h).
+//
+//   whiskers_texbake input.png output.wtex
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "BakedTexture.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+struct MipImage {
+  uint32_t width, height;
+  std::vector<unsigned char> rgba;
+};
+
+// Box-filters to half size; odd edges clamp so the last row/column is not lost.
+static MipImage downsample(const MipImage &src) {
+  MipImage dst;
+  dst.width = std::max(1u, src.width / 2);
+  dst.height = std::max(1u, src.height / 2);
+  dst.rgba.resize((size_t)dst.width * dst.height * 4);
+  for (uint32_t y = 0; y < dst.height; y++) {
+    uint32_t y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+    for (uint32_t x = 0; x < dst.width; x++) {
+      uint32_t x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+      for (int c = 0; c < 4; c++) {
+        auto at = [&](uint32_t sx, uint32_t sy) {
+          return (unsigned)src.rgba[((size_t)sy * src.width + sx) * 4 + c];
+        };
+        unsigned sum = at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1);
+        dst.rgba[((size_t)y * dst.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+      }
+    }
+  }
+  return dst;
+}
+
+static uint64_t alignUp(uint64_t v) {
+  return (v + kBakedTextureAlignment - 1) / kBakedTextureAlignment * kBakedTextureAlignment;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    std::cerr << "usage: " << argv[0] << " input.png output.wtex\n";
+    return 1;
+  }
+
+  int width, height, channels;
+  unsigned char *data = stbi_load(argv[1], &width, &height, &channels, 4);  // force RGBA
+  if (!data) {
+    std::cerr << "Failed to load image: " << argv[1] << " (" << stbi_failure_reason() << ")\n";
+    return 1;
+  }
+
+  std::vector<MipImage> mips(1);
+  mips[0].width = width;
+  mips[0].height = height;
+  mips[0].rgba.assign(data, data + (size_t)width * height * 4);
+  stbi_image_free(data);
+  while (mips.back().width > 1 || mips.back().height > 1) mips.push_back(downsample(mips.back()));
+
+  BakedTextureHeader header{};
+  std::memcpy(header.magic, kBakedTextureMagic, 4);
+  header.version = kBakedTextureVersion;
+  header.width = width;
+  header.height = height;
+  header.mipCount = (uint32_t)mips.size();
+
+  std::vector<BakedMipLevel> levels(mips.size());
+  uint64_t offset = alignUp(sizeof(header) + sizeof(BakedMipLevel) * levels.size());
+  for (size_t i = 0; i < mips.size(); i++) {
+    levels[i] = {mips[i].width, mips[i].height, offset, mips[i].rgba.size()};
+    offset = alignUp(offset + mips[i].rgba.size());
+  }
+
+  std::ofstream out(argv[2], std::ios::binary);
+  if (!out) {
+    std::cerr << "Failed to open output: " << argv[2] << "\n";
+    return 1;
+  }
+  out.write((const char *)&header, sizeof(header));
+  out.write((const char *)levels.data(), sizeof(BakedMipLevel) * levels.size());
+  for (size_t i = 0; i < mips.size(); i++) {
+    std::vector<char> padding(levels[i].offset - (uint64_t)out.tellp(), 0);
+    out.write(padding.data(), padding.size());
+    out.write((const char *)mips[i].rgba.data(), mips[i].rgba.size());
+  }
+  if (!out) {
+    std::cerr << "Failed to write output: " << argv[2] << "\n";
+    return 1;
+  }
+
+  std::cout << "Baked " << argv[1] << " (" << width << "x" << height << ", " << mips.size()
+            << " mip levels) -> " << argv[2] << std::endl;
+  return 0;
+}